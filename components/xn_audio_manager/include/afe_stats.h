@@ -0,0 +1,70 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\afe_stats.h
+ * @Description: AFE 流水线统计 - 分段延迟直方图、环形缓冲区深度、任务 CPU 占用
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 延迟直方图桶数：第 i 个桶为 [2^(i-1), 2^i) ms（第 0 个桶 < 1ms），最后一个桶 >= 256ms */
+#define AFE_STATS_LATENCY_BUCKETS  10
+
+/** 延迟直方图 */
+typedef struct {
+    uint32_t count;                             ///< 样本数
+    uint32_t min_us;                            ///< 最小值
+    uint32_t max_us;                            ///< 最大值
+    uint64_t sum_us;                            ///< 总和（平均值 = sum_us / count）
+    uint32_t buckets[AFE_STATS_LATENCY_BUCKETS];///< 按 2 的幂毫秒分桶
+} afe_latency_hist_t;
+
+/** 单个任务的负载 */
+typedef struct {
+    uint32_t calls;                             ///< 回调次数
+    uint64_t callback_us;                       ///< 回调中处理耗时总和（不含等待麦克风数据）
+    uint32_t callback_max_us;                   ///< 单次回调最大耗时
+    uint64_t run_time_us;                       ///< 任务运行时间（需要 FreeRTOS 运行时间统计，否则为 0）
+    float cpu_percent;                          ///< 任务运行时间 / 统计时长（不支持时为 -1）
+} afe_task_load_t;
+
+/** AFE 流水线统计 */
+typedef struct {
+    uint64_t window_us;                         ///< 统计时长（自上次清零）
+    afe_latency_hist_t feed_to_fetch;           ///< 一块数据送入 AFE 到取出处理结果
+    afe_latency_hist_t capture_to_fetch;        ///< 首个采样点采集到取出处理结果（含一块的采集时长）
+    uint32_t ringbuf_capacity;                  ///< AFE 环形缓冲区容量（帧）
+    uint32_t ringbuf_depth_max;                 ///< 已送入未取出的最大帧数（近似 AFE 环形缓冲区深度）
+    float ringbuf_depth_avg;                    ///< 平均帧数
+    afe_task_load_t feed;                       ///< feed 任务（直通模式下为采集任务）
+    afe_task_load_t fetch;                      ///< fetch 任务（直通模式下不使用）
+} afe_pipeline_stats_t;
+
+/**
+ * @brief 向直方图添加一个样本
+ * @param hist 直方图
+ * @param latency_us 延迟（微秒，负值按 0 计）
+ */
+void afe_latency_hist_add(afe_latency_hist_t *hist, int64_t latency_us);
+
+/**
+ * @brief 估算分位数（返回所在桶的上界）
+ * @param hist 直方图
+ * @param percent 百分位（0-100）
+ * @return 延迟上界（毫秒），没有样本时返回 0，落在最后一个桶时返回 max_us 换算的毫秒数
+ */
+uint32_t afe_latency_hist_percentile_ms(const afe_latency_hist_t *hist, float percent);
+
+#ifdef __cplusplus
+}
+#endif
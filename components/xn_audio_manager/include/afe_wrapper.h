@@ -13,6 +13,7 @@
 #include "esp_err.h"
 #include "audio_bsp.h"
 #include "ring_buffer.h"
+#include "afe_stats.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -41,8 +42,26 @@ typedef struct {
 /** AFE 事件回调 */
 typedef void (*afe_event_callback_t)(const afe_event_t *event, void *user_ctx);
 
-/** 录音数据回调 */
-typedef void (*afe_record_callback_t)(const int16_t *pcm_data, size_t samples, void *user_ctx);
+/** 录音数据回调（info 为本块第一个采样点的序号和采集时间） */
+typedef void (*afe_record_callback_t)(const int16_t *pcm_data, size_t samples,
+                                      const audio_frame_info_t *info, void *user_ctx);
+
+/** 麦克风/回采流时间信息 */
+typedef struct {
+    audio_frame_info_t mic;         ///< 最近一块麦克风数据首个采样点
+    audio_frame_info_t reference;   ///< 与之配对的回采数据首个采样点
+    int64_t skew_us;                ///< 麦克风采集时间 - 回采播放时间（微秒）
+    bool reference_valid;           ///< 最近一块是否有回采数据（未播放时为 false）
+    float drift_ppm;                ///< 当前时钟漂移补偿量（ppm，未启用时为 0）
+} afe_stream_timing_t;
+
+/** 回采对齐延迟状态 */
+typedef struct {
+    int32_t delay_samples;          ///< 目标延迟：麦克风采集时刻 - 配对回采送入扬声器时刻（采样点数）
+    bool valid;                     ///< 是否已有有效延迟（设置或估计成功）
+    bool estimating;                ///< 是否正在估计
+    float confidence;               ///< 最近一次估计的置信度
+} afe_ref_delay_t;
 
 /** AFE 唤醒词配置 */
 typedef struct {
@@ -58,6 +77,8 @@ typedef struct {
     int vad_mode;
     int min_speech_ms;
     int min_silence_ms;
+    int preroll_ms;                 ///< 预录时长：录音开始时先补发这段处理后的音频（0 表示不预录）
+    bool listen_only;               ///< 低功耗监听：软件 VAD 检测到人声后才让 AFE 处理（AFE VAD 关闭）
 } afe_vad_config_t;
 
 /** AFE 功能配置 */
@@ -65,16 +86,35 @@ typedef struct {
     bool aec_enabled;
     bool ns_enabled;
     bool agc_enabled;
+    bool drift_comp_enabled;        ///< 扬声器/麦克风时钟漂移补偿（回采重采样）
     int afe_mode;
 } afe_feature_config_t;
 
+/** 唤醒词重新配置耗时 */
+typedef struct {
+    uint32_t count;                 ///< 重新配置（重建流水线）次数
+    uint32_t total_us;              ///< 最近一次总耗时（含加载模型）
+    uint32_t gap_us;                ///< 最近一次采集中断时长（停止旧流水线到新流水线启动）
+} afe_reconfig_info_t;
+
+/** AFE feed/fetch 任务调度配置（优先级为 0 时该任务使用默认值：优先级 8，feed 在核心 1，fetch 在核心 0） */
+typedef struct {
+    int feed_priority;              ///< feed 任务优先级（直通模式下用于采集任务）
+    int feed_core;                  ///< feed 任务运行核心
+    int fetch_priority;             ///< fetch 任务优先级
+    int fetch_core;                 ///< fetch 任务运行核心
+} afe_task_config_t;
+
 /** AFE 包装器配置 */
 typedef struct {
     audio_bsp_handle_t bsp_handle;             ///< BSP 句柄
     ring_buffer_handle_t reference_rb;          ///< 回采缓冲区
+    uint32_t sample_rate;                       ///< 麦克风采样率（0 表示 16000）
+    int32_t ref_delay;                          ///< 回采对齐延迟（采样点数），<0 表示回采流开始时自动估计
     afe_wakeup_config_t wakeup_config;          ///< 唤醒词配置
     afe_vad_config_t vad_config;                ///< VAD 配置
     afe_feature_config_t feature_config;        ///< 功能配置
+    afe_task_config_t task_config;              ///< 任务调度配置
     afe_event_callback_t event_callback;        ///< 事件回调
     void *event_ctx;                            ///< 事件回调上下文
     afe_record_callback_t record_callback;      ///< 录音回调
@@ -101,9 +141,13 @@ void afe_wrapper_destroy(afe_wrapper_handle_t wrapper);
 
 /**
  * @brief 更新唤醒词配置
+ *
+ * 开关唤醒词、切换模型或修改灵敏度时立即生效：先加载模型，再重建采集流水线，
+ * 成功后释放旧模型；失败时保持原配置。
+ *
  * @param wrapper AFE 包装器句柄
  * @param config 新配置
- * @return ESP_OK 成功
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 模型加载失败
  */
 esp_err_t afe_wrapper_update_wakeup_config(afe_wrapper_handle_t wrapper, 
                                             const afe_wakeup_config_t *config);
@@ -117,6 +161,66 @@ esp_err_t afe_wrapper_update_wakeup_config(afe_wrapper_handle_t wrapper,
 esp_err_t afe_wrapper_get_wakeup_config(afe_wrapper_handle_t wrapper, 
                                          afe_wakeup_config_t *config);
 
+/**
+ * @brief 获取唤醒词重新配置耗时
+ * @param wrapper AFE 包装器句柄
+ * @param info 输出耗时
+ * @return ESP_OK 成功
+ */
+esp_err_t afe_wrapper_get_reconfig_info(afe_wrapper_handle_t wrapper, afe_reconfig_info_t *info);
+
+/**
+ * @brief 获取麦克风与回采流的时间信息
+ * @param wrapper AFE 包装器句柄
+ * @param timing 输出时间信息
+ * @return ESP_OK 成功
+ */
+esp_err_t afe_wrapper_get_stream_timing(afe_wrapper_handle_t wrapper, afe_stream_timing_t *timing);
+
+/**
+ * @brief 开始一次回采延迟估计（需要正在播放，约 2 秒有效回采后完成）
+ * @param wrapper AFE 包装器句柄
+ * @return ESP_OK 成功，ESP_ERR_NOT_SUPPORTED 未启用 AEC
+ */
+esp_err_t afe_wrapper_start_delay_estimation(afe_wrapper_handle_t wrapper);
+
+/**
+ * @brief 设置回采对齐延迟（例如恢复持久化的估计值），下一块生效
+ * @param wrapper AFE 包装器句柄
+ * @param delay_samples 延迟（采样点数），<0 表示清除
+ * @return ESP_OK 成功
+ */
+esp_err_t afe_wrapper_set_ref_delay(afe_wrapper_handle_t wrapper, int32_t delay_samples);
+
+/**
+ * @brief 获取回采对齐延迟状态
+ * @param wrapper AFE 包装器句柄
+ * @param delay 输出状态
+ * @return ESP_OK 成功
+ */
+esp_err_t afe_wrapper_get_ref_delay(afe_wrapper_handle_t wrapper, afe_ref_delay_t *delay);
+
+/**
+ * @brief 获取 AFE 流水线统计（自上次清零）
+ * @param wrapper AFE 包装器句柄
+ * @param stats 输出统计
+ * @return ESP_OK 成功
+ */
+esp_err_t afe_wrapper_get_pipeline_stats(afe_wrapper_handle_t wrapper, afe_pipeline_stats_t *stats);
+
+/**
+ * @brief 清零 AFE 流水线统计
+ * @param wrapper AFE 包装器句柄
+ * @return ESP_OK 成功
+ */
+esp_err_t afe_wrapper_reset_pipeline_stats(afe_wrapper_handle_t wrapper);
+
+/**
+ * @brief 打印 AFE 流水线统计摘要（延迟、环形缓冲区深度、任务负载）
+ * @param wrapper AFE 包装器句柄
+ */
+void afe_wrapper_log_pipeline_stats(afe_wrapper_handle_t wrapper);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,12 +4,20 @@
  * @LastEditors: xingnian jixingnian@gmail.com
  * @LastEditTime: 2025-11-27
  * @FilePath: \xn_esp32_audio\components\xn_audio_manager\include\audio_bsp.h
- * @Description: 音频 BSP 抽象层（当前实现为 I2S，未来可替换为其他硬件）
+ * @Description: 音频 BSP 抽象层（I2S 硬件后端 + 文件虚拟后端）
  */
 #pragma once
 
+#include "sdkconfig.h"
 #include "esp_err.h"
+
+/** 是否有 I2S 硬件后端（Linux 主机构建时只有文件后端） */
+#if CONFIG_IDF_TARGET_LINUX
+#define AUDIO_BSP_HAS_I2S 0
+#else
+#define AUDIO_BSP_HAS_I2S 1
 #include "driver/i2s_std.h"
+#endif
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -28,10 +36,22 @@ typedef struct {
     int din_gpio;            ///< 数据输入 GPIO
     int sample_rate;         ///< 采样率
     int bits;                ///< 位深
-    size_t max_frame_samples;///< 最大采样帧数（用于分配临时缓冲）
-    uint8_t bit_shift;       ///< 32bit 转 16bit 的右移位数
+    size_t max_frame_samples;///< 最大采样帧数（用于分配临时缓冲，AFE 启动后按其 feed 块大小调整）
+    uint8_t bit_shift;       ///< 32bit 转 16bit 的右移位数（自动量程时为初始值）
+    bool auto_gain;          ///< 自动量程：根据峰值动态调整右移位数
 } audio_bsp_mic_config_t;
 
+/**
+ * @brief 麦克风电平统计
+ */
+typedef struct {
+    uint8_t bit_shift;       ///< 当前右移位数
+    int32_t peak;            ///< 最近统计窗口峰值（16bit 输出）
+    int32_t rms;             ///< 最近统计窗口 RMS（16bit 输出）
+    uint32_t clipped;        ///< 累计饱和截断采样点数
+    uint32_t shift_changes;  ///< 自动量程累计调整次数
+} audio_bsp_mic_level_t;
+
 /**
  * @brief 扬声器硬件配置
  */
@@ -53,9 +73,54 @@ typedef struct {
     audio_bsp_speaker_config_t speaker;
 } audio_bsp_hw_config_t;
 
+/**
+ * @brief 文件后端节奏
+ */
+typedef enum {
+    AUDIO_BSP_FILE_PACING_REALTIME = 0,  ///< 按采样率实时节奏读写（模拟 I2S 阻塞）
+    AUDIO_BSP_FILE_PACING_FAST,          ///< 不等待，尽快读写（回归测试/基准测试）
+} audio_bsp_file_pacing_t;
+
+/**
+ * @brief 文件后端配置
+ */
+typedef struct {
+    const char *mic_path;            ///< 麦克风输入：WAV（16bit PCM）或原始 16bit 单声道 PCM；NULL 输出静音
+    bool mic_loop;                   ///< 读到末尾后从头循环（否则之后输出静音）
+    const char *speaker_path;        ///< 扬声器输出：原始 16bit 单声道 PCM 文件；NULL 不写文件
+    int16_t *speaker_sink;           ///< 扬声器输出内存接收区（可选），写满后丢弃
+    size_t speaker_sink_samples;     ///< 内存接收区容量（采样点数）
+    uint32_t sample_rate;            ///< 采样率（0 表示 16000，WAV 文件以文件头为准）
+    audio_bsp_file_pacing_t pacing;  ///< 读写节奏
+} audio_bsp_file_config_t;
+
 typedef struct audio_bsp_s *audio_bsp_handle_t;
 
+#if AUDIO_BSP_HAS_I2S
+/**
+ * @brief 创建 I2S 硬件后端
+ */
 audio_bsp_handle_t audio_bsp_create(const audio_bsp_hw_config_t *config);
+#endif
+
+/**
+ * @brief 创建文件虚拟后端
+ *
+ * 麦克风数据从文件读取，扬声器数据写入文件和/或内存，不需要开发板即可运行
+ * 采集/播放链路，适合在 Linux 主机上做确定性的回归测试和基准测试。
+ * 扬声器输出为音量处理前的原始数据。
+ *
+ * @param config 文件后端配置
+ * @return BSP 句柄，失败返回 NULL
+ */
+audio_bsp_handle_t audio_bsp_create_file(const audio_bsp_file_config_t *config);
+
+/**
+ * @brief 获取文件后端已输出到扬声器的采样点数
+ * @param handle BSP 句柄（非文件后端返回 0）
+ * @return 累计采样点数（包括内存接收区写满后丢弃的部分）
+ */
+size_t audio_bsp_file_get_speaker_samples(audio_bsp_handle_t handle);
 
 void audio_bsp_destroy(audio_bsp_handle_t handle);
 
@@ -69,9 +134,50 @@ esp_err_t audio_bsp_write_speaker(audio_bsp_handle_t handle,
                                   size_t sample_count,
                                   uint8_t volume);
 
+/**
+ * @brief 丢弃已提交给扬声器但尚未送入 DMA 的数据
+ *
+ * 停止播放时调用：正在进行的 audio_bsp_write_speaker 放弃剩余数据并返回，
+ * 停止延迟不再受写入长度影响
+ *
+ * @param handle BSP 句柄
+ * @return ESP_OK 成功（同步写入的后端直接返回成功）
+ */
+esp_err_t audio_bsp_flush_speaker(audio_bsp_handle_t handle);
+
+/**
+ * @brief 获取已提交给扬声器但尚未送入 DMA 的采样点数
+ *
+ * audio_bsp_write_speaker 可能在数据送入 DMA 之前返回（I2S 后端由 TX 任务异步写入），
+ * 写入前用它修正回采时间戳
+ *
+ * @param handle BSP 句柄
+ * @return 单声道采样点数（同步写入的后端返回 0）
+ */
+size_t audio_bsp_get_speaker_pending(audio_bsp_handle_t handle);
+
+/**
+ * @brief 获取麦克风电平统计
+ * @param handle BSP 句柄
+ * @param level 输出统计
+ * @return ESP_OK 成功，ESP_ERR_NOT_SUPPORTED 后端不支持
+ */
+esp_err_t audio_bsp_get_mic_level(audio_bsp_handle_t handle, audio_bsp_mic_level_t *level);
+
+/**
+ * @brief 按上层实际读取块大小调整麦克风读取缓冲区
+ * @param handle BSP 句柄
+ * @param samples 单次读取的最大采样点数
+ * @return ESP_OK 成功（后端读取长度不受限时直接返回成功），ESP_ERR_NO_MEM 分配失败
+ * @note 只能由读取麦克风的任务调用（或在开始读取前调用）
+ */
+esp_err_t audio_bsp_set_mic_frame_samples(audio_bsp_handle_t handle, size_t samples);
+
+#if AUDIO_BSP_HAS_I2S
 i2s_chan_handle_t audio_bsp_get_rx(audio_bsp_handle_t handle);
 
 i2s_chan_handle_t audio_bsp_get_tx(audio_bsp_handle_t handle);
+#endif
 
 #ifdef __cplusplus
 }
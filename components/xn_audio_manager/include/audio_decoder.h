@@ -0,0 +1,86 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\audio_decoder.h
+ * @Description: 播放解码器 - IMA-ADPCM / G.711 内置实现，Opus 通过 esp_audio_codec
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/** 是否支持 Opus（依赖 esp_audio_codec，Linux 主机构建时不可用） */
+#if CONFIG_IDF_TARGET_LINUX
+#define AUDIO_DECODER_HAS_OPUS 0
+#else
+#define AUDIO_DECODER_HAS_OPUS 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 压缩音频格式（均为单声道，输出 16 位 PCM）
+ *
+ * 每次解码输入一个完整的帧，帧之间互相独立或只依赖解码器内部状态：
+ * - IMA_ADPCM：WAV 块格式，一帧一个块。4 字节块头（int16 小端预测值 + 步长索引 + 保留字节），
+ *   块头预测值即第一个采样点，随后每字节两个采样点（低 4 位在前），len 字节解出 1 + (len - 4) * 2 个采样点
+ * - G711_ULAW / G711_ALAW：每字节一个采样点，帧长任意
+ * - OPUS：一帧一个 Opus 包（非自定界格式）
+ */
+typedef enum {
+    AUDIO_CODEC_PCM16 = 0,      ///< 16 位小端 PCM（不压缩）
+    AUDIO_CODEC_IMA_ADPCM,      ///< IMA-ADPCM，4:1
+    AUDIO_CODEC_G711_ULAW,      ///< G.711 μ-law，2:1
+    AUDIO_CODEC_G711_ALAW,      ///< G.711 A-law，2:1
+    AUDIO_CODEC_OPUS,           ///< Opus（需要 AUDIO_DECODER_HAS_OPUS）
+} audio_codec_t;
+
+/** 解码器句柄 */
+typedef struct audio_decoder_s *audio_decoder_handle_t;
+
+/**
+ * @brief 创建解码器
+ * @param codec 压缩格式
+ * @param sample_rate 采样率（Opus 按此采样率输出，其余格式仅作记录）
+ * @return 解码器句柄，格式不支持或分配失败返回NULL
+ */
+audio_decoder_handle_t audio_decoder_create(audio_codec_t codec, uint32_t sample_rate);
+
+/**
+ * @brief 销毁解码器
+ * @param dec 解码器句柄
+ */
+void audio_decoder_destroy(audio_decoder_handle_t dec);
+
+/**
+ * @brief 解码一帧
+ * @param dec 解码器句柄
+ * @param data 压缩帧
+ * @param len 压缩帧字节数
+ * @param out 输出缓冲区
+ * @param out_capacity 输出缓冲区容量（采样点数）
+ * @param out_samples 输出的采样点数
+ * @return ESP_OK 成功，ESP_ERR_INVALID_SIZE 帧长度非法或输出缓冲区不足，ESP_FAIL 数据损坏
+ */
+esp_err_t audio_decoder_decode(audio_decoder_handle_t dec, const uint8_t *data, size_t len,
+                               int16_t *out, size_t out_capacity, size_t *out_samples);
+
+/**
+ * @brief 获取格式名称
+ * @param codec 压缩格式
+ * @return 名称字符串
+ */
+const char *audio_codec_name(audio_codec_t codec);
+
+#ifdef __cplusplus
+}
+#endif
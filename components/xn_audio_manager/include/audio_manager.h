@@ -12,6 +12,11 @@
 
 #include "esp_err.h"
 #include "audio_bsp.h"
+#include "ring_buffer.h"
+#include "broadcast_ring.h"
+#include "afe_stats.h"
+#include "record_sub.h"
+#include "audio_decoder.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
@@ -31,6 +36,13 @@ extern "C" {
 #define AUDIO_MANAGER_PLAYBACK_FRAME_SAMPLES 1024
 #define AUDIO_MANAGER_PLAYBACK_BUFFER_BYTES  (512 * 1024)
 #define AUDIO_MANAGER_REFERENCE_BUFFER_BYTES (16 * 1024)
+#define AUDIO_MANAGER_ENCODED_BUFFER_BYTES   (32 * 1024)  ///< 压缩帧缓冲区（ADPCM 约 4 秒 @16kHz）
+#define AUDIO_MANAGER_PLAYBACK_OVERFLOW_POLICY   RING_BUFFER_OVERFLOW_DROP_OLDEST
+#define AUDIO_MANAGER_PLAYBACK_BLOCK_TIMEOUT_MS  1000
+#define AUDIO_MANAGER_RECORD_TAP_SAMPLES     16384   ///< 录音分接缓冲区容量（约 1 秒 @16kHz）
+#define AUDIO_MANAGER_MAX_RECORD_SUBSCRIBERS 4       ///< 最多同时存在的录音订阅者
+#define AUDIO_MANAGER_RECORD_SUB_STOP_MS     1000    ///< 取消订阅时等待回调返回的最长时间
+#define AUDIO_MANAGER_RECORD_SUB_LOCK_MS     2       ///< AFE 回调等待订阅者列表锁的最长时间（列表更新只持锁几微秒）
 
 // ============ 状态机定义 ============
 
@@ -98,6 +110,8 @@ typedef struct {
     int vad_mode;                   ///< VAD模式 (0-3)
     int min_speech_ms;              ///< 最小语音持续时间
     int min_silence_ms;             ///< 最小静音持续时间
+    int preroll_ms;                 ///< 预录时长：录音开始时先补发 VAD 触发前的音频，避免丢失句首（0 表示关闭）
+    bool listen_only;               ///< 低功耗监听：空闲时只跑软件 VAD，检测到人声/播放/录音时才启动 AFE 处理
 } audio_mgr_vad_config_t;
 
 /** AFE功能配置（应用层提供） */
@@ -105,7 +119,14 @@ typedef struct {
     bool aec_enabled;               ///< 回声消除
     bool ns_enabled;                ///< 降噪
     bool agc_enabled;               ///< 自动增益
+    bool drift_comp_enabled;        ///< 时钟漂移补偿（扬声器/麦克风时钟不同源时保持回采对齐）
+    int ref_delay_samples;          ///< 回采对齐延迟（采样点数，可填入持久化的估计值），-1 表示首次播放时自动估计
     int afe_mode;                   ///< AFE模式（0=LOW_COST, 1=HIGH_QUALITY）
+    int feed_task_priority;         ///< AFE feed 任务优先级（0 表示默认，直通模式下用于采集任务）
+    int feed_task_core;             ///< AFE feed 任务运行核心
+    int fetch_task_priority;        ///< AFE fetch 任务优先级（0 表示默认）
+    int fetch_task_core;            ///< AFE fetch 任务运行核心
+    uint32_t stats_log_interval_ms; ///< 定期打印并清零 AFE 流水线统计的间隔（0 表示不打印）
 } audio_mgr_afe_config_t;
 
 /** 音频管理器配置（应用层组装） */
@@ -125,6 +146,7 @@ typedef struct {
             .port = 0, .bclk_gpio = -1, .lrck_gpio = -1, .din_gpio = -1, \
             .sample_rate = 16000, .bits = 32,                        \
             .max_frame_samples = 512, .bit_shift = 14,               \
+            .auto_gain = false,                                      \
         },                                                           \
         .speaker = {                                                 \
             .port = 0, .bclk_gpio = -1, .lrck_gpio = -1, .dout_gpio = -1, \
@@ -150,6 +172,8 @@ typedef struct {
         .vad_mode = 2,                                               \
         .min_speech_ms = 200,                                        \
         .min_silence_ms = 400,                                       \
+        .preroll_ms = 400,                                           \
+        .listen_only = false,                                        \
     }
 
 #define AUDIO_MANAGER_DEFAULT_AFE_CONFIG()                           \
@@ -157,7 +181,14 @@ typedef struct {
         .aec_enabled = true,                                         \
         .ns_enabled = true,                                          \
         .agc_enabled = true,                                         \
+        .drift_comp_enabled = true,                                  \
+        .ref_delay_samples = -1,                                     \
         .afe_mode = 1,                                               \
+        .feed_task_priority = 8,                                     \
+        .feed_task_core = 1,                                         \
+        .fetch_task_priority = 8,                                    \
+        .fetch_task_core = 0,                                        \
+        .stats_log_interval_ms = 0,                                  \
     }
 
 #define AUDIO_MANAGER_DEFAULT_CONFIG()                               \
@@ -171,6 +202,29 @@ typedef struct {
         .user_ctx = NULL,                                            \
     }
 
+/** 缓冲区统计信息（用于根据实测数据调整缓冲区大小） */
+typedef struct {
+    ring_buffer_stats_t playback;   ///< 播放缓冲区（AUDIO_MANAGER_PLAYBACK_BUFFER_BYTES）
+    ring_buffer_stats_t reference;  ///< 回采缓冲区（AUDIO_MANAGER_REFERENCE_BUFFER_BYTES）
+} audio_mgr_buffer_stats_t;
+
+/** 回采对齐延迟状态（AEC 用） */
+typedef struct {
+    int32_t delay_samples;          ///< 麦克风采集时刻 - 配对回采送入扬声器时刻（采样点数，含 DMA 队列和声学路径）
+    bool valid;                     ///< 是否已有有效延迟
+    bool estimating;                ///< 是否正在估计
+    float confidence;               ///< 最近一次估计的置信度（峰值 / 互相关均方根）
+} audio_mgr_ref_delay_t;
+
+/** 麦克风/回采流时间信息（用于测量 AEC 对齐和采集到上传的延迟） */
+typedef struct {
+    audio_frame_info_t mic;         ///< 最近一块麦克风数据首个采样点的序号和采集时间
+    audio_frame_info_t reference;   ///< 与之配对的回采数据首个采样点的序号和播放时间
+    int64_t skew_us;                ///< 麦克风采集时间 - 回采播放时间（微秒）
+    bool reference_valid;           ///< 最近一块是否配对到回采数据（未播放时为 false）
+    float drift_ppm;                ///< 当前时钟漂移补偿量（ppm，正值表示扬声器时钟偏快）
+} audio_mgr_stream_timing_t;
+
 // ============ API接口 ============
 
 /**
@@ -219,11 +273,55 @@ esp_err_t audio_manager_stop_recording(void);
 
 /**
  * @brief 播放音频数据（播放器接口）
- * @param pcm_data PCM数据（16bit, 16kHz, 单声道）
+ * @param pcm_data PCM数据（16bit, 单声道，默认为播放采样率，见 audio_manager_set_playback_sample_rate）
  * @param sample_count 采样点数
+ * @return 实际接受的采样点数（未初始化、参数无效或设置了压缩格式时为 0）
+ * @note 流式生产者可根据返回值控制发送节奏，无需轮询剩余空间
+ */
+size_t audio_manager_play_audio(const int16_t *pcm_data, size_t sample_count);
+
+/**
+ * @brief 设置播放数据的采样率（需先停止播放）
+ * 
+ * 与扬声器采样率不同时在播放控制器内重采样，对 PCM 和压缩帧都生效
+ * 
+ * @param sample_rate 输入采样率（0 表示与扬声器采样率相同）
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 正在播放，ESP_ERR_NOT_SUPPORTED 采样率比例无法支持
+ */
+esp_err_t audio_manager_set_playback_sample_rate(uint32_t sample_rate);
+
+/**
+ * @brief 设置压缩音频的格式（需先停止播放）
+ * 
+ * AUDIO_CODEC_PCM16（默认）时只接受 audio_manager_play_audio，
+ * 其余格式时只接受 audio_manager_play_encoded
+ * 
+ * @param codec 压缩格式
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 正在播放，ESP_ERR_NOT_SUPPORTED 格式不支持
+ */
+esp_err_t audio_manager_set_playback_codec(audio_codec_t codec);
+
+/**
+ * @brief 播放一个压缩帧（播放器接口）
+ * 
+ * 压缩帧在播放前才解码，节省缓冲区和网络带宽。格式见 audio_codec_t，
+ * 需先用 audio_manager_set_playback_codec 设置非 PCM16 格式
+ * 
+ * @param frame 压缩帧
+ * @param len 字节数
+ * @param timeout_ms 缓冲区满时最长等待时间（毫秒）
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 缓冲区满，ESP_ERR_INVALID_STATE 未初始化或未设置格式
+ */
+esp_err_t audio_manager_play_encoded(const uint8_t *frame, size_t len, uint32_t timeout_ms);
+
+/**
+ * @brief 设置播放缓冲区满时的写入策略
+ * @param policy 溢出策略（覆盖旧数据 / 丢弃新数据 / 阻塞等待）
+ * @param block_timeout_ms BLOCK 策略下单次写入最长等待时间（毫秒）
  * @return ESP_OK 成功
  */
-esp_err_t audio_manager_play_audio(const int16_t *pcm_data, size_t sample_count);
+esp_err_t audio_manager_set_playback_overflow_policy(ring_buffer_overflow_policy_t policy,
+                                                     uint32_t block_timeout_ms);
 
 /**
  * @brief 获取播放缓冲区可用空间（样本数）
@@ -234,6 +332,158 @@ esp_err_t audio_manager_play_audio(const int16_t *pcm_data, size_t sample_count)
  */
 size_t audio_manager_get_playback_free_space(void);
 
+/**
+ * @brief 设置播放缓冲区高/低水位回调（边沿触发）
+ * 
+ * 例如在 LOW 回调中 xTaskNotifyGive 唤醒网络/TTS 生产者任务
+ * 
+ * @param low 低水位（采样点数）
+ * @param high 高水位（采样点数）
+ * @param callback 水位回调（NULL 表示关闭），不能阻塞
+ * @param user_ctx 回调上下文
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_manager_set_playback_watermarks(size_t low, size_t high,
+                                                ring_buffer_watermark_cb_t callback, void *user_ctx);
+
+/**
+ * @brief 等待播放缓冲区剩余空间达到 min_free
+ * 
+ * 生产者休眠直到播放任务腾出空间，替代轮询 audio_manager_get_playback_free_space
+ * 
+ * @param min_free 等待的最低剩余空间（采样点数）
+ * @param timeout_ms 最长等待时间（毫秒）
+ * @return 返回时的剩余空间（超时时可能小于 min_free）
+ */
+size_t audio_manager_wait_playback_space(size_t min_free, uint32_t timeout_ms);
+
+/**
+ * @brief 获取播放/回采缓冲区统计信息
+ * 
+ * 无锁快照，开销很小，可周期性轮询
+ * 
+ * @param stats 输出统计信息
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_manager_get_buffer_stats(audio_mgr_buffer_stats_t *stats);
+
+/**
+ * @brief 获取麦克风与回采流之间的当前时间偏差
+ * 
+ * 每块送入 AFE 的麦克风数据都记录采集时间，每段回采数据都记录送入 I2S 的时间，
+ * 两者之差即 AEC 实际看到的回声对齐偏差，可作为延迟预算的依据。
+ * 
+ * @param timing 输出时间信息
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_get_stream_skew(audio_mgr_stream_timing_t *timing);
+
+/**
+ * @brief 获取麦克风电平统计
+ * 
+ * 包括最近统计窗口的峰值/RMS、累计截断数和当前右移位数，
+ * 可用于判断 bit_shift 是否合适，或观察自动量程（hw_config.mic.auto_gain）的调整。
+ * 
+ * @param level 输出统计
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_get_mic_level(audio_bsp_mic_level_t *level);
+
+/**
+ * @brief 开始估计回采延迟（AEC 对齐）
+ * 
+ * 需要正在播放有内容的音频：麦克风与回采做降采样互相关，约 2 秒后完成，
+ * 成功后立即按新延迟对齐回采。结果可用 audio_manager_get_reference_delay 读取并持久化，
+ * 下次启动时填入 afe_config.ref_delay_samples 或调用 audio_manager_set_reference_delay。
+ * 
+ * @return ESP_OK 成功，ESP_ERR_NOT_SUPPORTED 未启用 AEC，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_estimate_reference_delay(void);
+
+/**
+ * @brief 设置回采对齐延迟
+ * @param delay_samples 延迟（采样点数），<0 表示清除
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_set_reference_delay(int32_t delay_samples);
+
+/**
+ * @brief 获取回采对齐延迟状态
+ * @param delay 输出状态
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_get_reference_delay(audio_mgr_ref_delay_t *delay);
+
+/**
+ * @brief 获取 AFE 流水线统计（自上次清零）
+ * 
+ * 包括每块数据送入 AFE 到取出、采集到取出的延迟直方图，AFE 环形缓冲区深度，
+ * 以及 feed/fetch 任务的回调耗时和 CPU 占用（CPU 占用需要开启 FreeRTOS 运行时间统计）。
+ * 用于调整 afe_config 中的任务优先级和核心。
+ * 
+ * @param stats 输出统计
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_get_pipeline_stats(afe_pipeline_stats_t *stats);
+
+/**
+ * @brief 清零 AFE 流水线统计
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_reset_pipeline_stats(void);
+
+/**
+ * @brief 打开一个录音分接（tap）读者
+ * 
+ * 录音数据除了送往录音回调外，还会写入一个共享的广播缓冲区，
+ * 调试录音、电平表、网络上传等模块可各自打开读者独立消费，互不影响。
+ * 读者落后超过 AUDIO_MANAGER_RECORD_TAP_SAMPLES 时旧数据被跳过并计入统计。
+ * 
+ * @note 分接在录音数据回调中写入，只包含录音期间的数据（含录音开始时补发的预录），
+ *       未录音时（例如只在等待唤醒词）读者读不到数据；需要持续监听的模块应先开始录音
+ * 
+ * @return 读者句柄（用 broadcast_ring_read/peek 读取），失败或读者已满返回NULL
+ */
+broadcast_reader_handle_t audio_manager_open_record_tap(void);
+
+/**
+ * @brief 关闭录音分接读者
+ * @param reader 读者句柄
+ */
+void audio_manager_close_record_tap(broadcast_reader_handle_t reader);
+
+/**
+ * @brief 订阅录音数据（异步投递）
+ *
+ * 每个订阅者有自己的帧队列、丢帧策略和投递任务：AFE fetch 任务只把数据拷贝进队列（不阻塞），
+ * 回调在订阅者任务中执行，可以阻塞（例如网络发送），慢的订阅者只会丢自己的帧，
+ * 不会拖慢 AFE 或其他订阅者。订阅/取消订阅只短暂持有订阅者列表锁，
+ * AFE 不等待该锁：恰好与之冲突的一帧不投递给任何订阅者（计数并打印）。
+ *
+ * @param config 订阅配置
+ * @return 订阅者句柄，未初始化、参数无效或订阅者已满时返回NULL
+ */
+record_sub_handle_t audio_manager_subscribe_record(const record_sub_config_t *config);
+
+/**
+ * @brief 取消录音订阅
+ *
+ * 返回后不会再有新数据入队；排队的帧丢弃，正在执行的回调最多等待
+ * AUDIO_MANAGER_RECORD_SUB_STOP_MS。
+ *
+ * @param sub 订阅者句柄
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 不是有效的订阅者，ESP_ERR_TIMEOUT 回调仍在执行（返回后不会再被调用）
+ */
+esp_err_t audio_manager_unsubscribe_record(record_sub_handle_t sub);
+
+/**
+ * @brief 获取录音订阅者统计（投递/丢弃帧数、队列深度、回调耗时）
+ * @param sub 订阅者句柄
+ * @param stats 输出统计
+ * @return ESP_OK 成功
+ */
+esp_err_t audio_manager_get_record_sub_stats(record_sub_handle_t sub, record_sub_stats_t *stats);
+
 /**
  * @brief 开始播放（启动播放任务）
  * @return ESP_OK 成功
@@ -242,14 +492,14 @@ esp_err_t audio_manager_start_playback(void);
 
 /**
  * @brief 停止播放
- * @return ESP_OK 成功
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 播放任务未确认停止（播放状态保持不变，可再次调用等待确认）
  */
 esp_err_t audio_manager_stop_playback(void);
 
 /**
  * @brief 清空播放缓冲区（用于打断场景）
- * @note 立即清空所有待播放的音频数据
- * @return ESP_OK 成功
+ * @note 立即清空所有待播放的音频数据（由播放任务执行，返回后写入的数据不受影响）
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 播放任务未及时确认
  */
 esp_err_t audio_manager_clear_playback_buffer(void);
 
@@ -267,8 +517,12 @@ uint8_t audio_manager_get_volume(void);
 
 /**
  * @brief 动态更新唤醒词配置（后期网页配置用）
+ *
+ * 开关唤醒词、切换模型分区或修改灵敏度时无需重启：先加载模型，再重建 AFE（采集短暂中断），
+ * 成功后释放旧模型。wake_word_name 与分区中的模型名匹配时使用该模型，否则使用第一个唤醒词模型。
+ *
  * @param config 新的唤醒词配置
- * @return ESP_OK 成功
+ * @return ESP_OK 成功，ESP_ERR_NOT_FOUND 模型加载失败（保持原配置）
  */
 esp_err_t audio_manager_update_wakeup_config(const audio_mgr_wakeup_config_t *config);
 
@@ -316,11 +570,29 @@ typedef void (*audio_record_callback_t)(const int16_t *pcm_data, size_t sample_c
 
 /**
  * @brief 注册录音数据回调
+ * @note 回调在 AFE fetch 任务中同步调用，不能阻塞；可能阻塞的消费者请使用 audio_manager_subscribe_record
  * @param callback 回调函数
  * @param user_ctx 用户上下文
  */
 void audio_manager_set_record_callback(audio_record_callback_t callback, void *user_ctx);
 
+/**
+ * @brief 带时间信息的录音数据回调函数类型
+ * @param pcm_data 录音PCM数据（16bit, 16kHz, 单声道）
+ * @param sample_count 采样点数
+ * @param info 本块首个采样点的序号和采集时间（可用于计算采集到服务器的延迟）
+ * @param user_ctx 用户上下文
+ */
+typedef void (*audio_record_callback_ex_t)(const int16_t *pcm_data, size_t sample_count,
+                                           const audio_frame_info_t *info, void *user_ctx);
+
+/**
+ * @brief 注册带时间信息的录音数据回调（与 audio_manager_set_record_callback 可同时使用）
+ * @param callback 回调函数
+ * @param user_ctx 用户上下文
+ */
+void audio_manager_set_record_callback_ex(audio_record_callback_ex_t callback, void *user_ctx);
+
 #ifdef __cplusplus
 }
 #endif
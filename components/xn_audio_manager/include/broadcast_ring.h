@@ -0,0 +1,137 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\broadcast_ring.h
+ * @Description: 广播环形缓冲区 - 单写多读的音频分接（tap）缓存
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "ring_buffer.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BROADCAST_RING_MAX_READERS  4   ///< 每个广播缓冲区最多同时打开的读者数
+
+/**
+ * 广播环形缓冲区句柄
+ *
+ * 单生产者/多消费者：所有读者共享同一块存储，各自维护读游标。
+ * 写入从不等待读者，读者落后超过容量时跳过被覆盖的数据并记入溢出统计。
+ */
+typedef struct broadcast_ring_s *broadcast_ring_handle_t;
+
+/** 广播缓冲区读者句柄 */
+typedef struct broadcast_reader_s *broadcast_reader_handle_t;
+
+/**
+ * 读者统计信息
+ */
+typedef struct {
+    uint64_t total_read;        ///< 累计读取的采样点数
+    uint64_t overrun_samples;   ///< 因落后被覆盖而跳过的采样点数
+    uint32_t overrun_events;    ///< 发生覆盖的次数
+    size_t lag;                 ///< 当前落后写入端的采样点数
+    size_t max_lag;             ///< 历史最大落后量（不超过容量）
+} broadcast_reader_stats_t;
+
+/**
+ * @brief 创建广播环形缓冲区
+ * @param samples 最小容量（采样点数），向上取整为 2 的幂
+ * @return 广播缓冲区句柄，失败返回NULL
+ */
+broadcast_ring_handle_t broadcast_ring_create(size_t samples);
+
+/**
+ * @brief 销毁广播环形缓冲区（同时关闭所有读者）
+ * @param br 广播缓冲区句柄
+ */
+void broadcast_ring_destroy(broadcast_ring_handle_t br);
+
+/**
+ * @brief 写入数据（永不阻塞，只允许一个写入任务）
+ * @param br 广播缓冲区句柄
+ * @param data 数据指针
+ * @param samples 采样点数
+ * @return 写入的采样点数
+ */
+size_t broadcast_ring_write(broadcast_ring_handle_t br, const int16_t *data, size_t samples);
+
+/**
+ * @brief 打开一个读者，从当前写入位置开始读取
+ * @param br 广播缓冲区句柄
+ * @return 读者句柄，读者已满时返回NULL
+ */
+broadcast_reader_handle_t broadcast_ring_open_reader(broadcast_ring_handle_t br);
+
+/**
+ * @brief 关闭读者
+ * @param reader 读者句柄
+ */
+void broadcast_ring_close_reader(broadcast_reader_handle_t reader);
+
+/**
+ * @brief 读取数据（拷贝）
+ * @param reader 读者句柄
+ * @param out 输出缓冲区
+ * @param samples 最多读取的采样点数
+ * @param timeout_ms 无数据时的最长等待时间（毫秒），0表示不阻塞
+ * @return 实际读取的采样点数
+ * @note 每个读者只允许一个任务读取
+ */
+size_t broadcast_ring_read(broadcast_reader_handle_t reader, int16_t *out,
+                           size_t samples, uint32_t timeout_ms);
+
+/**
+ * @brief 零拷贝读取：获取至多 samples 个可读数据的内部区间
+ * @param reader 读者句柄
+ * @param samples 期望读取的采样点数
+ * @param span 输出区间（至多两段）
+ * @param timeout_ms 无数据时的最长等待时间（毫秒），0表示不阻塞
+ * @return 区间内的采样点数
+ */
+size_t broadcast_ring_peek(broadcast_reader_handle_t reader, size_t samples,
+                           ring_buffer_span_t *span, uint32_t timeout_ms);
+
+/**
+ * @brief 释放 peek 得到的区间
+ * @param reader 读者句柄
+ * @param samples 释放的采样点数（不超过 peek 的长度）
+ * @return true 数据完整；false 访问期间已被写入端覆盖（已计入溢出统计）
+ */
+bool broadcast_ring_release(broadcast_reader_handle_t reader, size_t samples);
+
+/**
+ * @brief 获取读者可读的采样点数
+ * @param reader 读者句柄
+ * @return 可读采样点数（不超过容量）
+ */
+size_t broadcast_ring_reader_available(broadcast_reader_handle_t reader);
+
+/**
+ * @brief 获取读者统计信息
+ * @param reader 读者句柄
+ * @param stats 输出统计信息
+ * @return ESP_OK 成功
+ */
+esp_err_t broadcast_ring_get_reader_stats(broadcast_reader_handle_t reader,
+                                          broadcast_reader_stats_t *stats);
+
+/**
+ * @brief 获取广播缓冲区的容量
+ * @param br 广播缓冲区句柄
+ * @return 缓冲区容量（采样点数）
+ */
+size_t broadcast_ring_get_size(broadcast_ring_handle_t br);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\delay_est.h
+ * @Description: 回声延迟估计 - 降采样互相关求麦克风相对回采的延迟
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 延迟估计器句柄
+ *
+ * 麦克风和回采先 8 倍降采样并做一阶差分（粗略白化，使语音的互相关峰更尖锐），
+ * 再在线累加 [-max_lag, +max_lag] 范围内每个延迟的互相关，运算量均匀分摊到每一块。
+ * 16kHz、max_lag 2048 时每秒约 1M 次乘累加（2000 个降采样点 x 513 个延迟），只在估计窗口内运行。
+ * 累计够一个窗口后取互相关绝对值的峰并抛物线插值。纯计算模块，可在主机上测试。
+ */
+typedef struct delay_est_s *delay_est_handle_t;
+
+/** 延迟估计器配置 */
+typedef struct {
+    uint32_t sample_rate;       ///< 采样率（0 表示 16000）
+    uint32_t max_lag;           ///< 最大搜索延迟（采样点数，0 表示 2048）
+    uint32_t window_ms;         ///< 累计窗口（只计入有效回采，0 表示 2000）
+    float min_confidence;       ///< 最低置信度（峰值 / 互相关均方根，0 表示 5）
+} delay_est_config_t;
+
+/** 延迟估计结果 */
+typedef struct {
+    int32_t lag;                ///< 延迟（采样点数，正值表示回声晚于配对的回采）
+    float confidence;           ///< 置信度（峰值 / 互相关均方根）
+} delay_est_result_t;
+
+/**
+ * @brief 创建延迟估计器
+ * @param config 配置（NULL 使用默认值）
+ * @return 句柄，失败返回NULL
+ */
+delay_est_handle_t delay_est_create(const delay_est_config_t *config);
+
+/**
+ * @brief 销毁延迟估计器
+ * @param de 句柄
+ */
+void delay_est_destroy(delay_est_handle_t de);
+
+/**
+ * @brief 清空累计数据，开始新一次估计
+ * @param de 句柄
+ */
+void delay_est_reset(delay_est_handle_t de);
+
+/**
+ * @brief 送入一块配对的麦克风/回采数据
+ * @param de 句柄
+ * @param mic 麦克风数据
+ * @param ref 回采数据（与 mic 逐点配对）
+ * @param n 采样点数
+ * @return 累计已满一个窗口时返回 true（之后可取结果）
+ */
+bool delay_est_feed(delay_est_handle_t de, const int16_t *mic, const int16_t *ref, size_t n);
+
+/**
+ * @brief 计算估计结果
+ * @param de 句柄
+ * @param result 输出结果（置信度不足时也会填写，便于诊断）
+ * @return 窗口已满且置信度达到 min_confidence 时返回 true
+ */
+bool delay_est_get_result(delay_est_handle_t de, delay_est_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\drift_comp.h
+ * @Description: 时钟漂移补偿 - 按回采缓冲区水位估计扬声器/麦克风时钟偏差并分数重采样
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 漂移补偿器句柄
+ *
+ * 回采数据按扬声器时钟写入缓冲区、按麦克风时钟取出，两个时钟的偏差使水位缓慢漂移。
+ * 补偿器对水位做低通后用 PI 控制器估计偏差（ppm），再用分数重采样器按该比例
+ * 消耗回采数据，使输出与麦克风采样时钟锁定。纯计算模块，不依赖 RTOS，可在主机上测试。
+ *
+ * 播放任务按整块写入，按采样点计的水位在两次写入之间呈锯齿且只能以整块为单位观察到
+ * 时钟相位变化；有时间戳时应使用“麦克风采集时间 - 回采播放时间”换算成的采样点数，
+ * 它是连续变化的等效水位。
+ */
+typedef struct drift_comp_s *drift_comp_handle_t;
+
+/** 漂移补偿器配置 */
+typedef struct {
+    uint32_t sample_rate;       ///< 采样率（0 表示 16000）
+    float max_ppm;              ///< 最大补偿量（0 表示 1000 ppm）
+    float loop_bandwidth_hz;    ///< PI 环路自然频率（0 表示 0.008 Hz，约 20 秒收敛）
+    float fill_time_constant_s; ///< 水位低通时间常数（0 表示 4 秒，滤除播放分块造成的锯齿）
+} drift_comp_config_t;
+
+/**
+ * @brief 创建漂移补偿器
+ * @param config 配置（NULL 使用默认值）
+ * @return 句柄，失败返回NULL
+ */
+drift_comp_handle_t drift_comp_create(const drift_comp_config_t *config);
+
+/**
+ * @brief 销毁漂移补偿器
+ * @param dc 句柄
+ */
+void drift_comp_destroy(drift_comp_handle_t dc);
+
+/**
+ * @brief 重新锁定（回采流中断后恢复时调用）
+ *
+ * 以下一次 drift_comp_update 的水位为新的目标水位，清空重采样历史；
+ * 已估计出的偏差（积分项）保留，因为它反映的是硬件时钟特性。
+ *
+ * @param dc 句柄
+ */
+void drift_comp_relock(drift_comp_handle_t dc);
+
+/**
+ * @brief 用当前回采水位更新偏差估计
+ * @param dc 句柄
+ * @param fill 当前水位（采样点数，可为小数；同一段流内须使用同一种度量）
+ * @param elapsed 距上次更新经过的麦克风采样点数
+ */
+void drift_comp_update(drift_comp_handle_t dc, float fill, size_t elapsed);
+
+/**
+ * @brief 分数重采样（可分段多次调用，状态在调用之间保持）
+ *
+ * 每输出 1 个采样点消耗约 (1 + ppm * 1e-6) 个输入，使用 4 点三次插值，
+ * 固定引入 2 个采样点的延迟。
+ *
+ * @param dc 句柄
+ * @param in 输入
+ * @param in_len 输入采样点数
+ * @param out 输出
+ * @param out_len 输出缓冲区容量
+ * @param produced 实际输出的采样点数
+ * @return 实际消耗的输入采样点数
+ */
+size_t drift_comp_process(drift_comp_handle_t dc, const int16_t *in, size_t in_len,
+                          int16_t *out, size_t out_len, size_t *produced);
+
+/**
+ * @brief 获取当前补偿量
+ * @param dc 句柄
+ * @return 补偿量（ppm，正值表示扬声器时钟快于麦克风，回采数据多消耗）
+ */
+float drift_comp_get_ppm(drift_comp_handle_t dc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,10 +27,20 @@ typedef struct {
     int din_gpio;       ///< 数据输入 GPIO
     int sample_rate;    ///< 采样率（通常 16000）
     int bits;           ///< 位深度（硬件采集 32bit，由数据手册要求）
-    size_t max_frame_samples;  ///< 最大帧采样数（用于预分配临时缓冲区，默认 512）
-    uint8_t bit_shift;  ///< 32位转16位的右移位数（默认 14，可调 12-16）
+    size_t max_frame_samples;  ///< 最大帧采样数（用于预分配临时缓冲区，默认 512；可用 i2s_hal_set_mic_frame_samples 调整）
+    uint8_t bit_shift;  ///< 32位转16位的右移位数（默认 14，可调 12-16；自动量程时为初始值）
+    bool auto_gain;     ///< 自动量程：根据峰值在 12-16 之间动态调整右移位数
 } i2s_mic_config_t;
 
+/** 麦克风电平统计 */
+typedef struct {
+    uint8_t bit_shift;       ///< 当前右移位数
+    int32_t peak;            ///< 最近一个统计窗口的峰值（16bit 输出，0-32768）
+    int32_t rms;             ///< 最近一个统计窗口的 RMS（16bit 输出）
+    uint32_t clipped;        ///< 累计饱和截断采样点数
+    uint32_t shift_changes;  ///< 自动量程累计调整次数
+} i2s_mic_level_t;
+
 /** I2S 扬声器配置 */
 typedef struct {
     int port;           ///< I2S 端口号
@@ -39,7 +49,7 @@ typedef struct {
     int dout_gpio;      ///< 数据输出 GPIO
     int sample_rate;    ///< 采样率（通常 16000）
     int bits;           ///< 位深度（16bit）
-    size_t max_frame_samples;  ///< 最大帧采样数（用于分配立体声缓冲区）
+    size_t max_frame_samples;  ///< 分块采样数（每个立体声转换缓冲区的大小，写入长度不受此限制）
 } i2s_speaker_config_t;
 
 /** I2S HAL 句柄 */
@@ -67,7 +77,7 @@ void i2s_hal_destroy(i2s_hal_handle_t hal);
  * @param sample_count 期望读取的采样点数
  * @param out_got 实际读取的采样点数（可选）
  * @return ESP_OK 成功
- * @note 自动将 32bit 硬件数据转换为 16bit
+ * @note 自动将 32bit 硬件数据转换为 16bit（饱和截断）
  */
 esp_err_t i2s_hal_read_mic(i2s_hal_handle_t hal, int16_t *out_samples, 
                            size_t sample_count, size_t *out_got);
@@ -76,14 +86,53 @@ esp_err_t i2s_hal_read_mic(i2s_hal_handle_t hal, int16_t *out_samples,
  * @brief 向扬声器写入音频数据
  * @param hal I2S HAL 句柄
  * @param samples 输入数据（16bit PCM 单声道）
- * @param sample_count 采样点数
+ * @param sample_count 采样点数（任意长度，内部分块）
  * @param volume 音量（0-100）
  * @return ESP_OK 成功
- * @note 自动将单声道转换为立体声，并应用音量
+ * @note 自动将单声道转换为立体声，并应用音量；转换与 I2S 写入由两个缓冲区交替重叠进行
  */
 esp_err_t i2s_hal_write_speaker(i2s_hal_handle_t hal, const int16_t *samples, 
                                  size_t sample_count, uint8_t volume);
 
+/**
+ * @brief 丢弃已提交但尚未送入 DMA 的扬声器数据（停止播放时调用）
+ * @param hal I2S HAL 句柄
+ * @return ESP_OK 成功
+ * @note 正在进行的 i2s_hal_write_speaker 放弃剩余数据并返回；不能与 i2s_hal_destroy 并发
+ */
+esp_err_t i2s_hal_flush_speaker(i2s_hal_handle_t hal);
+
+/**
+ * @brief 获取已提交但尚未送入 DMA 的采样点数（TX 队列深度）
+ * @param hal I2S HAL 句柄
+ * @return 单声道采样点数
+ */
+size_t i2s_hal_get_speaker_pending(i2s_hal_handle_t hal);
+
+/**
+ * @brief 获取麦克风 32bit 转 16bit 时被饱和截断的累计采样点数
+ * @param hal I2S HAL 句柄
+ * @return 累计截断采样点数（可用于判断右移位数是否过小）
+ */
+uint32_t i2s_hal_get_mic_clip_count(i2s_hal_handle_t hal);
+
+/**
+ * @brief 获取麦克风电平统计（峰值、RMS、当前右移位数）
+ * @param hal I2S HAL 句柄
+ * @param level 输出统计
+ * @return ESP_OK 成功
+ */
+esp_err_t i2s_hal_get_mic_level(i2s_hal_handle_t hal, i2s_mic_level_t *level);
+
+/**
+ * @brief 按实际读取块大小重新分配麦克风临时缓冲区
+ * @param hal I2S HAL 句柄
+ * @param samples 单次读取的最大采样点数
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 分配失败（原缓冲区保持不变）
+ * @note 只能由读取麦克风的任务调用（或在开始读取前调用）
+ */
+esp_err_t i2s_hal_set_mic_frame_samples(i2s_hal_handle_t hal, size_t samples);
+
 /**
  * @brief 获取 RX 句柄（用于 AFE 回调）
  * @param hal I2S HAL 句柄
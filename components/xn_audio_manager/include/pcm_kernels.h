@@ -0,0 +1,74 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\pcm_kernels.h
+ * @Description: PCM 转换内核 - 采样格式转换等逐样本热路径
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 32bit 转 16bit：算术右移后饱和截断
+ *
+ * 常用移位（12-16）使用常量移位的专用实现，其余移位走通用实现。
+ *
+ * @param dst 输出（16bit），不能与 src 重叠
+ * @param src 输入（32bit）
+ * @param n 采样点数
+ * @param shift 右移位数（0-31）
+ * @return 被饱和截断的采样点数
+ */
+size_t pcm_s32_to_s16_sat(int16_t *dst, const int32_t *src, size_t n, unsigned shift);
+
+/**
+ * @brief pcm_s32_to_s16_sat 的逐样本参考实现（用于校验专用实现）
+ */
+size_t pcm_s32_to_s16_sat_ref(int16_t *dst, const int32_t *src, size_t n, unsigned shift);
+
+/**
+ * @brief 统计 16bit 数据的峰值和能量
+ *
+ * @param src 输入（16bit）
+ * @param n 采样点数
+ * @param peak 输出峰值绝对值（0-32768）
+ * @param energy 输出平方和（RMS = sqrt(energy / n)）
+ */
+void pcm_s16_level(const int16_t *src, size_t n, int32_t *peak, uint64_t *energy);
+
+/** Q15 增益的 1.0（32768） */
+#define PCM_GAIN_Q15_UNITY  32768
+
+/**
+ * @brief 单声道转立体声并应用 Q15 增益（融合内核）
+ *
+ * 增益从 gain_start 线性过渡到 gain_end（最后一个采样点达到 gain_end），
+ * 两者相等时走恒定增益路径，等于 PCM_GAIN_Q15_UNITY 时只复制。
+ *
+ * @param dst 输出（交织立体声，2 * n 个采样点）
+ * @param src 输入（单声道）
+ * @param n 单声道采样点数
+ * @param gain_start 起始增益（Q15，0 ~ PCM_GAIN_Q15_UNITY）
+ * @param gain_end 结束增益（Q15，0 ~ PCM_GAIN_Q15_UNITY）
+ */
+void pcm_mono_to_stereo_gain_q15(int16_t *dst, const int16_t *src, size_t n,
+                                 int32_t gain_start, int32_t gain_end);
+
+/**
+ * @brief pcm_mono_to_stereo_gain_q15 的逐样本参考实现（用于校验）
+ */
+void pcm_mono_to_stereo_gain_q15_ref(int16_t *dst, const int16_t *src, size_t n,
+                                     int32_t gain_start, int32_t gain_end);
+
+#ifdef __cplusplus
+}
+#endif
@@ -13,6 +13,7 @@
 #include "esp_err.h"
 #include "ring_buffer.h"
 #include "audio_bsp.h"
+#include "audio_decoder.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -35,6 +36,10 @@ typedef struct {
     playback_reference_callback_t reference_callback; ///< 回采数据回调（可选，用于AFE）
     void *reference_ctx;                             ///< 回采回调上下文
     uint8_t *volume_ptr;                             ///< 音量指针（外部管理）
+    ring_buffer_overflow_policy_t overflow_policy;   ///< 播放缓冲区满时的写入策略（默认覆盖旧数据）
+    uint32_t block_timeout_ms;                       ///< BLOCK 策略下单次写入最长等待时间（毫秒）
+    uint32_t sample_rate;                            ///< 播放采样率（I2S 采样率，用于回采时间戳，0 表示 16000）
+    size_t encoded_buffer_bytes;                     ///< 压缩帧缓冲区大小（字节，0 表示不支持压缩播放）
 } playback_controller_config_t;
 
 /**
@@ -51,40 +56,94 @@ playback_controller_handle_t playback_controller_create(const playback_controlle
 void playback_controller_destroy(playback_controller_handle_t controller);
 
 /**
- * @brief 启动播放任务
+ * @brief 启动播放（唤醒创建时启动的常驻播放任务）
  * @param controller 播放控制器句柄
  * @return ESP_OK 成功
  */
 esp_err_t playback_controller_start(playback_controller_handle_t controller);
 
 /**
- * @brief 停止播放任务
+ * @brief 停止播放，等待播放任务回到空闲后返回（通常几毫秒）
  * @param controller 播放控制器句柄
- * @return ESP_OK 成功
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 播放任务未及时停止（已不再取新数据，但仍视为正在播放，
+ *         再次调用会继续等待其确认空闲）
  */
 esp_err_t playback_controller_stop(playback_controller_handle_t controller);
 
 /**
  * @brief 写入音频数据到播放缓冲区
  * @param controller 播放控制器句柄
- * @param pcm_data PCM 数据（16bit, 单声道）
+ * @param pcm_data PCM 数据（16bit, 单声道，采样率见 playback_controller_set_input_rate）
  * @param sample_count 采样点数
- * @return ESP_OK 成功
+ * @return 实际接受的采样点数（受溢出策略影响，参数无效或设置了压缩格式时为 0）
+ */
+size_t playback_controller_write(playback_controller_handle_t controller, 
+                                 const int16_t *pcm_data, size_t sample_count);
+
+/**
+ * @brief 设置写入数据的采样率（仅在停止播放时调用，对 PCM 和压缩帧都生效）
+ * 
+ * 与播放采样率不同时由定点多相重采样器转换，例如 22.05/24kHz 的 TTS 输出转到 16kHz
+ * 替换重采样器时与 playback_controller_write 互斥，可与停止状态下的预填充写入并发调用
+ * 
+ * @param controller 播放控制器句柄
+ * @param sample_rate 输入采样率（0 表示与播放采样率相同）
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 正在播放（含停止超时、播放任务尚未确认空闲），
+ *         ESP_ERR_NOT_SUPPORTED 采样率比例无法支持
+ */
+esp_err_t playback_controller_set_input_rate(playback_controller_handle_t controller, uint32_t sample_rate);
+
+/**
+ * @brief 设置压缩帧的格式（仅在停止播放时调用）
+ * 
+ * 切换格式会丢弃压缩帧缓冲区中尚未解码的帧。格式决定播放缓冲区唯一的生产者：
+ * AUDIO_CODEC_PCM16（默认）只接受 playback_controller_write，
+ * 其余格式只接受 playback_controller_write_encoded（由播放任务解码写入）
+ * 
+ * @param controller 播放控制器句柄
+ * @param codec 压缩格式
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 正在播放（含停止超时、播放任务尚未确认空闲）或未启用压缩播放，
+ *         ESP_ERR_NOT_SUPPORTED 格式不支持
+ */
+esp_err_t playback_controller_set_codec(playback_controller_handle_t controller, audio_codec_t codec);
+
+/**
+ * @brief 写入一个压缩帧
+ * 
+ * 压缩帧整帧存入压缩帧缓冲区，由播放任务在播放缓冲区将空时解码（只提前解码约两帧 PCM）。
+ * 播放任务是此时播放缓冲区唯一的生产者，playback_controller_write 被拒绝
+ * 
+ * @param controller 播放控制器句柄
+ * @param frame 压缩帧（格式见 audio_codec_t）
+ * @param len 字节数
+ * @param timeout_ms 缓冲区满时最长等待时间（毫秒）
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 缓冲区满，ESP_ERR_INVALID_STATE 未设置压缩格式，ESP_ERR_INVALID_SIZE 帧过大
  */
-esp_err_t playback_controller_write(playback_controller_handle_t controller, 
-                                     const int16_t *pcm_data, size_t sample_count);
+esp_err_t playback_controller_write_encoded(playback_controller_handle_t controller,
+                                            const uint8_t *frame, size_t len, uint32_t timeout_ms);
 
 /**
- * @brief 清空播放缓冲区
+ * @brief 设置播放缓冲区满时的写入策略
  * @param controller 播放控制器句柄
+ * @param policy 溢出策略
+ * @param block_timeout_ms BLOCK 策略下单次写入最长等待时间（毫秒）
  * @return ESP_OK 成功
  */
+esp_err_t playback_controller_set_overflow_policy(playback_controller_handle_t controller,
+                                                  ring_buffer_overflow_policy_t policy,
+                                                  uint32_t block_timeout_ms);
+
+/**
+ * @brief 清空播放缓冲区（由播放任务执行，等待其确认后返回）
+ * @param controller 播放控制器句柄
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 播放任务未及时确认（请求保留，稍后执行）
+ */
 esp_err_t playback_controller_clear(playback_controller_handle_t controller);
 
 /**
  * @brief 检查是否正在播放
  * @param controller 播放控制器句柄
- * @return true 正在播放
+ * @return true 正在播放（停止超时后，播放任务确认空闲之前也返回 true）
  */
 bool playback_controller_is_running(playback_controller_handle_t controller);
 
@@ -102,6 +161,40 @@ size_t playback_controller_get_free_space(playback_controller_handle_t controlle
  */
 ring_buffer_handle_t playback_controller_get_reference_buffer(playback_controller_handle_t controller);
 
+/**
+ * @brief 设置播放缓冲区高/低水位回调
+ * @param controller 播放控制器句柄
+ * @param low 低水位（采样点数），数据量下降到此值时触发 LOW
+ * @param high 高水位（采样点数），数据量上升到此值时触发 HIGH
+ * @param callback 水位回调（NULL 表示关闭），不能阻塞
+ * @param user_ctx 回调上下文
+ * @return ESP_OK 成功
+ */
+esp_err_t playback_controller_set_watermarks(playback_controller_handle_t controller,
+                                             size_t low, size_t high,
+                                             ring_buffer_watermark_cb_t callback, void *user_ctx);
+
+/**
+ * @brief 等待播放缓冲区剩余空间达到 min_free（生产者休眠，无需轮询）
+ * @param controller 播放控制器句柄
+ * @param min_free 等待的最低剩余空间（采样点数）
+ * @param timeout_ms 最长等待时间（毫秒）
+ * @return 返回时的剩余空间
+ */
+size_t playback_controller_wait_free_space(playback_controller_handle_t controller,
+                                           size_t min_free, uint32_t timeout_ms);
+
+/**
+ * @brief 获取播放/回采缓冲区统计信息
+ * @param controller 播放控制器句柄
+ * @param playback_stats 输出播放缓冲区统计（可为 NULL）
+ * @param reference_stats 输出回采缓冲区统计（可为 NULL）
+ * @return ESP_OK 成功
+ */
+esp_err_t playback_controller_get_stats(playback_controller_handle_t controller,
+                                        ring_buffer_stats_t *playback_stats,
+                                        ring_buffer_stats_t *reference_stats);
+
 #ifdef __cplusplus
 }
 #endif
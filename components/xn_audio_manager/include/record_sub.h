@@ -0,0 +1,103 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\record_sub.h
+ * @Description: 录音订阅者 - 每个消费者独立的帧队列、丢帧策略和投递任务
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "esp_err.h"
+#include "ring_buffer.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 录音订阅者句柄
+ *
+ * 生产者（AFE fetch 任务）只做不阻塞的入队：把数据拷贝进预分配的帧，队列满时按丢帧策略处理；
+ * 订阅者自己的任务取出帧并调用回调，回调可以阻塞（例如网络发送），只影响本订阅者。
+ */
+typedef struct record_sub_s *record_sub_handle_t;
+
+/** 录音数据回调（在订阅者任务中调用，info 为本帧首个采样点的序号和采集时间） */
+typedef void (*record_sub_callback_t)(const int16_t *pcm_data, size_t samples,
+                                      const audio_frame_info_t *info, void *user_ctx);
+
+/** 队列满时的丢帧策略 */
+typedef enum {
+    RECORD_SUB_DROP_OLDEST = 0,     ///< 丢弃队列中最旧的帧（默认，延迟有上限）
+    RECORD_SUB_DROP_NEWEST,         ///< 丢弃新到的帧（已排队的数据保持连续）
+} record_sub_drop_policy_t;
+
+/** 录音订阅配置 */
+typedef struct {
+    record_sub_callback_t callback;         ///< 数据回调（必填）
+    void *user_ctx;                         ///< 回调上下文
+    size_t queue_frames;                    ///< 队列容量（帧，0 表示 16）
+    size_t frame_samples;                   ///< 每帧最大采样点数（0 表示 512），更大的数据块拆成多帧
+    record_sub_drop_policy_t drop_policy;   ///< 队列满时的丢帧策略
+    const char *task_name;                  ///< 投递任务名（NULL 表示 "rec_sub"）
+    uint32_t task_stack;                    ///< 投递任务栈大小（0 表示 4096）
+    int task_priority;                      ///< 投递任务优先级（0 表示 5）
+    int task_core;                          ///< 投递任务运行核心（<0 表示不绑定）
+} record_sub_config_t;
+
+/** 录音订阅者统计 */
+typedef struct {
+    uint32_t delivered_frames;              ///< 已交给回调的帧数
+    uint32_t dropped_frames;                ///< 因队列满丢弃的帧数
+    uint32_t queued_frames;                 ///< 当前排队的帧数
+    uint32_t max_queued_frames;             ///< 历史最大排队帧数
+    uint32_t max_callback_us;               ///< 单次回调最长耗时
+} record_sub_stats_t;
+
+/**
+ * @brief 创建录音订阅者（分配帧并启动投递任务）
+ * @param config 配置
+ * @param sample_rate 采样率（拆分数据块时推算各帧的采集时间）
+ * @return 订阅者句柄，失败返回NULL
+ */
+record_sub_handle_t record_sub_create(const record_sub_config_t *config, uint32_t sample_rate);
+
+/**
+ * @brief 销毁录音订阅者
+ *
+ * 丢弃排队的帧，等待正在执行的回调返回（最长 timeout_ms）。超时时投递任务在回调返回后自行释放资源。
+ *
+ * @param sub 订阅者句柄
+ * @param timeout_ms 等待回调返回的最长时间（毫秒）
+ * @return ESP_OK 已停止，ESP_ERR_TIMEOUT 回调仍在执行（返回后不会再被调用）
+ */
+esp_err_t record_sub_destroy(record_sub_handle_t sub, uint32_t timeout_ms);
+
+/**
+ * @brief 入队一块录音数据（不阻塞，可在 AFE fetch 任务中调用）
+ * @param sub 订阅者句柄
+ * @param pcm_data 音频数据
+ * @param samples 采样点数
+ * @param info 首个采样点的序号和采集时间
+ * @return 入队的帧数（丢弃的新帧不计）
+ */
+size_t record_sub_push(record_sub_handle_t sub, const int16_t *pcm_data, size_t samples,
+                       const audio_frame_info_t *info);
+
+/**
+ * @brief 获取订阅者统计
+ * @param sub 订阅者句柄
+ * @param stats 输出统计
+ * @return ESP_OK 成功
+ */
+esp_err_t record_sub_get_stats(record_sub_handle_t sub, record_sub_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,76 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\resampler.h
+ * @Description: 定点多相重采样器 - 任意整数采样率之间的有理数比例转换
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** 每相抽头数（按输入采样点计）；降采样时按 in_rate / out_rate 放大，使过渡带相对输出采样率不变 */
+#define RESAMPLER_TAPS          32
+/** 最大相数（out_rate / gcd(in_rate, out_rate)），滤波器组占 每相抽头数 * 相数 * 2 字节 */
+#define RESAMPLER_MAX_PHASES    640
+
+/**
+ * 重采样器句柄
+ *
+ * 采样率比例约分为 L/M（L = 相数），创建时计算 Kaiser 窗 sinc 原型滤波器并拆成 L 组 Q15 系数，
+ * 每组归一化为单位直流增益；处理时每个输出采样点只做一组系数的整数点积。
+ * 截止频率取两个采样率中较低者奈奎斯特频率的 85%，降采样时同时作为抗混叠滤波。
+ * 跨调用保留一组系数长度减一的输入历史，可以按任意长度分块输入。
+ * 纯计算模块，不依赖 RTOS，可在主机上测试。
+ */
+typedef struct resampler_s *resampler_handle_t;
+
+/**
+ * @brief 创建重采样器
+ * @param in_rate 输入采样率
+ * @param out_rate 输出采样率
+ * @return 句柄，采样率为 0、相数超过 RESAMPLER_MAX_PHASES 或分配失败返回NULL
+ */
+resampler_handle_t resampler_create(uint32_t in_rate, uint32_t out_rate);
+
+/**
+ * @brief 销毁重采样器
+ * @param rs 句柄
+ */
+void resampler_destroy(resampler_handle_t rs);
+
+/**
+ * @brief 清除历史数据（开始新的音频流时调用）
+ * @param rs 句柄
+ */
+void resampler_reset(resampler_handle_t rs);
+
+/**
+ * @brief 计算输入 in_samples 个采样点时最多输出的采样点数
+ * @param rs 句柄
+ * @param in_samples 输入采样点数
+ * @return 输出缓冲区所需容量（采样点数）
+ */
+size_t resampler_max_output(resampler_handle_t rs, size_t in_samples);
+
+/**
+ * @brief 重采样一块音频
+ * @param rs 句柄
+ * @param in 输入数据
+ * @param in_samples 输入采样点数
+ * @param out 输出缓冲区（容量不小于 resampler_max_output(rs, in_samples)）
+ * @return 输出的采样点数
+ */
+size_t resampler_process(resampler_handle_t rs, const int16_t *in, size_t in_samples, int16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
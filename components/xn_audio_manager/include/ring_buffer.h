@@ -20,13 +20,78 @@
 extern "C" {
 #endif
 
-/** 环形缓冲区句柄 */
+/**
+ * 环形缓冲区句柄
+ *
+ * 单生产者/单消费者无锁实现：同一时刻只允许一个任务写入、一个任务读取。
+ */
 typedef struct ring_buffer_s *ring_buffer_handle_t;
 
+/**
+ * 环形缓冲区内存区间
+ *
+ * 直接指向缓冲区内部内存，用于零拷贝读写；区间跨越缓冲区末尾时拆成两段，
+ * 第二段无效时 data[1] 为 NULL、len[1] 为 0。
+ */
+typedef struct {
+    int16_t *data[2];   ///< 各段起始地址
+    size_t len[2];      ///< 各段采样点数
+} ring_buffer_span_t;
+
+/** 缓冲区满时的写入策略 */
+typedef enum {
+    RING_BUFFER_OVERFLOW_DROP_OLDEST = 0,   ///< 覆盖最旧的未读数据（默认）
+    RING_BUFFER_OVERFLOW_DROP_NEWEST,       ///< 丢弃写不下的新数据
+    RING_BUFFER_OVERFLOW_BLOCK,             ///< 阻塞等待空间，超时后丢弃剩余新数据
+} ring_buffer_overflow_policy_t;
+
+/**
+ * 音频帧时间信息
+ *
+ * sample_index 为该采样点在所属流中的序号（从 0 单调递增），
+ * timestamp_us 为其采集（或送入扬声器）时刻，基于 esp_timer_get_time()。
+ */
+typedef struct {
+    uint64_t sample_index;      ///< 采样点序号
+    int64_t timestamp_us;       ///< 时间戳（微秒）
+} audio_frame_info_t;
+
+/** 水位事件类型 */
+typedef enum {
+    RING_BUFFER_WATERMARK_LOW,   ///< 数据量下降到低水位（有空间可写）
+    RING_BUFFER_WATERMARK_HIGH,  ///< 数据量上升到高水位（有数据可读）
+} ring_buffer_watermark_t;
+
+/**
+ * 水位回调函数类型
+ *
+ * 在读写路径中直接调用（边沿触发），必须简短且不能阻塞。
+ */
+typedef void (*ring_buffer_watermark_cb_t)(ring_buffer_handle_t rb, ring_buffer_watermark_t mark,
+                                           size_t fill, void *user_ctx);
+
+/**
+ * 环形缓冲区统计信息
+ *
+ * 由生产者/消费者在各自路径上累加（各自一个版本号），读取时取一致快照，
+ * 可用于根据实际运行数据调整缓冲区大小。
+ */
+typedef struct {
+    uint64_t total_written;     ///< 累计写入的采样点数
+    uint64_t total_read;        ///< 累计读取的采样点数
+    uint64_t overrun_samples;   ///< 累计因缓冲区满被丢弃的采样点数（旧数据或新数据）
+    uint32_t underrun_events;   ///< 读取到部分数据（少于请求量）的次数
+    uint32_t empty_reads;       ///< 读取时缓冲区为空的次数
+    uint32_t peek_overruns;     ///< 零拷贝区间在处理期间被生产者覆盖的次数（ring_buffer_release_read 返回 false）
+    size_t max_fill;            ///< 最高水位（采样点数）
+    uint64_t blocked_us;        ///< 读取阻塞等待的累计时间（微秒）
+    uint64_t write_blocked_us;  ///< 写入阻塞等待空间的累计时间（微秒，仅 BLOCK 策略）
+} ring_buffer_stats_t;
+
 /**
  * @brief 创建环形缓冲区
  * @param samples 缓冲区容量（采样点数）
- * @param with_sem 是否使用信号量（用于阻塞读取）
+ * @param with_sem 是否使用信号量（用于阻塞读取和等待空间）
  * @return 环形缓冲区句柄，失败返回NULL
  */
 ring_buffer_handle_t ring_buffer_create(size_t samples, bool with_sem);
@@ -42,8 +107,9 @@ void ring_buffer_destroy(ring_buffer_handle_t rb);
  * @param rb 环形缓冲区句柄
  * @param data 数据指针
  * @param samples 采样点数
- * @return 实际写入的采样点数
- * @note 如果缓冲区满，会覆盖旧数据
+ * @return 实际接受的采样点数
+ * @note 缓冲区满时按溢出策略处理（默认覆盖旧数据），丢弃量计入 overrun_samples 统计
+ * @note 仅限单个生产者调用，无锁、不会因竞争而丢弃数据
  */
 size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t samples);
 
@@ -54,9 +120,128 @@ size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t sa
  * @param samples 期望读取的采样点数
  * @param timeout_ms 超时时间（毫秒），0表示不阻塞
  * @return 实际读取的采样点数
+ * @note 仅限单个消费者调用
  */
 size_t ring_buffer_read(ring_buffer_handle_t rb, int16_t *out, size_t samples, uint32_t timeout_ms);
 
+/**
+ * @brief 阻塞读取至少 min_samples 个采样点
+ * @param rb 环形缓冲区句柄
+ * @param out 输出缓冲区
+ * @param samples 最多读取的采样点数
+ * @param min_samples 至少等待的采样点数
+ * @param timeout_ms 最长等待时间（毫秒），超时后返回已有的数据
+ * @return 实际读取的采样点数
+ * @note 仅限单个消费者调用
+ */
+size_t ring_buffer_read_min(ring_buffer_handle_t rb, int16_t *out, size_t samples,
+                            size_t min_samples, uint32_t timeout_ms);
+
+/**
+ * @brief 等待可读数据量达到 min_samples
+ * @param rb 环形缓冲区句柄
+ * @param min_samples 等待的最低数据量
+ * @param timeout_ms 最长等待时间（毫秒），0表示不阻塞
+ * @return 返回时的可读数据量（超时时可能小于 min_samples）
+ * @note 生产者只在数据量达到阈值时唤醒等待者；仅限单个消费者调用
+ */
+size_t ring_buffer_wait_available(ring_buffer_handle_t rb, size_t min_samples, uint32_t timeout_ms);
+
+/**
+ * @brief 打断消费者的阻塞等待（ring_buffer_wait_available / 阻塞读取立即返回）
+ * @param rb 环形缓冲区句柄
+ * @note 可在任意任务中调用；调用时没有等待者则下一次等待立即返回一次
+ */
+void ring_buffer_abort_wait(ring_buffer_handle_t rb);
+
+/**
+ * @brief 设置缓冲区满时的写入策略
+ * @param rb 环形缓冲区句柄
+ * @param policy 溢出策略
+ * @param block_timeout_ms BLOCK 策略下单次写入最长等待时间（毫秒）
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 信号量创建失败
+ * @note 应在生产者开始写入前设置
+ */
+esp_err_t ring_buffer_set_overflow_policy(ring_buffer_handle_t rb,
+                                          ring_buffer_overflow_policy_t policy,
+                                          uint32_t block_timeout_ms);
+
+/**
+ * @brief 预留写入区间（零拷贝写入）
+ * @param rb 环形缓冲区句柄
+ * @param samples 期望写入的采样点数
+ * @param span 输出：可直接写入的缓冲区区间
+ * @return 实际预留的采样点数（受剩余空间限制，不会覆盖旧数据）
+ * @note 写满区间后调用 ring_buffer_commit_write() 发布数据；仅限生产者调用
+ */
+size_t ring_buffer_reserve_write(ring_buffer_handle_t rb, size_t samples, ring_buffer_span_t *span);
+
+/**
+ * @brief 提交已写入预留区间的数据
+ * @param rb 环形缓冲区句柄
+ * @param samples 提交的采样点数（不超过预留量）
+ * @return 实际提交的采样点数
+ */
+size_t ring_buffer_commit_write(ring_buffer_handle_t rb, size_t samples);
+
+/**
+ * @brief 查看可读区间（零拷贝读取）
+ * @param rb 环形缓冲区句柄
+ * @param samples 期望读取的采样点数
+ * @param span 输出：可直接读取的缓冲区区间
+ * @param timeout_ms 超时时间（毫秒），0表示不阻塞
+ * @return 区间内的采样点数
+ * @note 处理完后调用 ring_buffer_release_read() 释放；仅限消费者调用
+ */
+size_t ring_buffer_peek_read(ring_buffer_handle_t rb, size_t samples,
+                             ring_buffer_span_t *span, uint32_t timeout_ms);
+
+/**
+ * @brief 释放已处理的可读区间
+ * @param rb 环形缓冲区句柄
+ * @param samples 释放的采样点数（不超过查看量）
+ * @return true 成功；false 区间在处理期间被生产者覆盖或被清空，数据可能已失效
+ */
+bool ring_buffer_release_read(ring_buffer_handle_t rb, size_t samples);
+
+/**
+ * @brief 等待剩余空间达到 min_free
+ * @param rb 环形缓冲区句柄
+ * @param min_free 等待的最低剩余空间（采样点数）
+ * @param timeout_ms 最长等待时间（毫秒），0表示不阻塞
+ * @return 返回时的剩余空间（超时时可能小于 min_free）
+ * @note 仅限单个生产者调用
+ */
+size_t ring_buffer_wait_free(ring_buffer_handle_t rb, size_t min_free, uint32_t timeout_ms);
+
+/**
+ * @brief 设置高/低水位回调（边沿触发）
+ * @param rb 环形缓冲区句柄
+ * @param low 低水位（采样点数）
+ * @param high 高水位（采样点数），需大于 low
+ * @param callback 水位回调，NULL 表示关闭
+ * @param user_ctx 回调上下文
+ * @return ESP_OK 成功
+ */
+esp_err_t ring_buffer_set_watermarks(ring_buffer_handle_t rb, size_t low, size_t high,
+                                     ring_buffer_watermark_cb_t callback, void *user_ctx);
+
+/**
+ * @brief 为下一个写入的采样点打时间戳（生产者调用）
+ * @param rb 环形缓冲区句柄
+ * @param timestamp_us 下一个写入采样点的时间戳（微秒）
+ * @param sample_rate 采样率，用于推算其他采样点的时间戳
+ */
+void ring_buffer_stamp(ring_buffer_handle_t rb, int64_t timestamp_us, uint32_t sample_rate);
+
+/**
+ * @brief 获取下一个待读采样点的序号和时间戳（消费者调用）
+ * @param rb 环形缓冲区句柄
+ * @param info 输出帧时间信息
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 尚未打过时间戳
+ */
+esp_err_t ring_buffer_get_read_info(ring_buffer_handle_t rb, audio_frame_info_t *info);
+
 /**
  * @brief 获取环形缓冲区中可用的数据量
  * @param rb 环形缓冲区句柄
@@ -65,12 +250,27 @@ size_t ring_buffer_read(ring_buffer_handle_t rb, int16_t *out, size_t samples, u
 size_t ring_buffer_available(ring_buffer_handle_t rb);
 
 /**
- * @brief 清空环形缓冲区
+ * @brief 清空环形缓冲区（只能由消费者或生产者调用）
  * @param rb 环形缓冲区句柄
  * @return ESP_OK 成功
  */
 esp_err_t ring_buffer_clear(ring_buffer_handle_t rb);
 
+/**
+ * @brief 获取环形缓冲区统计信息
+ * @param rb 环形缓冲区句柄
+ * @param stats 输出统计信息
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ * @note 无锁快照，可在任意任务中周期性调用
+ */
+esp_err_t ring_buffer_get_stats(ring_buffer_handle_t rb, ring_buffer_stats_t *stats);
+
+/**
+ * @brief 清零环形缓冲区统计信息
+ * @param rb 环形缓冲区句柄
+ */
+void ring_buffer_reset_stats(ring_buffer_handle_t rb);
+
 /**
  * @brief 获取环形缓冲区的容量
  * @param rb 环形缓冲区句柄
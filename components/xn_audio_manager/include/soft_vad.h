@@ -0,0 +1,92 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\include\soft_vad.h
+ * @Description: 轻量软件 VAD - 能量 + 过零率 + 自适应噪声基底
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 软件 VAD 句柄
+ *
+ * 按 20ms 帧计算能量（dB）和过零率：能量高出噪声基底 threshold_db 判为语音帧，
+ * 过零率高的清辅音放宽到一半阈值，过零率极低的低频嗡声不计入。
+ * 噪声基底取最近 4 秒帧能量的最小值（最小值统计），环境噪声变大时 4 秒内跟上，
+ * 而语音中总有停顿，基底不会被抬到语音电平。
+ * 连续 start_ms 的语音帧报告开始，连续 hangover_ms 的非语音帧报告结束。
+ * 纯计算模块，不依赖 RTOS，可在主机上测试。
+ */
+typedef struct soft_vad_s *soft_vad_handle_t;
+
+/** 状态变化 */
+typedef enum {
+    SOFT_VAD_EVENT_NONE = 0,    ///< 无变化
+    SOFT_VAD_EVENT_START,       ///< 人声开始
+    SOFT_VAD_EVENT_END,         ///< 人声结束
+} soft_vad_event_t;
+
+/** 软件 VAD 配置 */
+typedef struct {
+    uint32_t sample_rate;       ///< 采样率（0 表示 16000）
+    uint32_t start_ms;          ///< 判定开始所需的语音时长（0 表示 200）
+    uint32_t hangover_ms;       ///< 判定结束所需的静音时长（0 表示 400）
+    float threshold_db;         ///< 语音帧需高出噪声基底的 dB 数（0 表示 12）
+} soft_vad_config_t;
+
+/**
+ * @brief 创建软件 VAD
+ * @param config 配置（NULL 使用默认值）
+ * @return 句柄，失败返回NULL
+ */
+soft_vad_handle_t soft_vad_create(const soft_vad_config_t *config);
+
+/**
+ * @brief 销毁软件 VAD
+ * @param vad 句柄
+ */
+void soft_vad_destroy(soft_vad_handle_t vad);
+
+/**
+ * @brief 回到静音状态并重新学习噪声基底
+ * @param vad 句柄
+ */
+void soft_vad_reset(soft_vad_handle_t vad);
+
+/**
+ * @brief 处理一块音频（任意长度，不足一帧的部分留到下次）
+ * @param vad 句柄
+ * @param samples 音频数据
+ * @param n 采样点数
+ * @return 本块前后状态不同时返回 START/END，否则返回 NONE
+ */
+soft_vad_event_t soft_vad_process(soft_vad_handle_t vad, const int16_t *samples, size_t n);
+
+/**
+ * @brief 当前是否处于人声状态
+ * @param vad 句柄
+ * @return true 人声
+ */
+bool soft_vad_is_speech(soft_vad_handle_t vad);
+
+/**
+ * @brief 获取当前噪声基底
+ * @param vad 句柄
+ * @return 噪声基底（dB，以 1 LSB 的均方为 0 dB）
+ */
+float soft_vad_get_noise_floor_db(soft_vad_handle_t vad);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\afe_stats.c
+ * @Description: AFE 流水线统计实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "afe_stats.h"
+
+void afe_latency_hist_add(afe_latency_hist_t *hist, int64_t latency_us)
+{
+    if (!hist) {
+        return;
+    }
+
+    uint32_t us = latency_us < 0 ? 0 : (latency_us > UINT32_MAX ? UINT32_MAX : (uint32_t)latency_us);
+    if (hist->count == 0 || us < hist->min_us) hist->min_us = us;
+    if (us > hist->max_us) hist->max_us = us;
+    hist->sum_us += us;
+    hist->count++;
+
+    // 桶 i 的上界为 2^i ms
+    uint32_t ms = us / 1000;
+    int bucket = 0;
+    while (bucket < AFE_STATS_LATENCY_BUCKETS - 1 && ms >= (1u << bucket)) {
+        bucket++;
+    }
+    hist->buckets[bucket]++;
+}
+
+uint32_t afe_latency_hist_percentile_ms(const afe_latency_hist_t *hist, float percent)
+{
+    if (!hist || hist->count == 0) {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(hist->count * (percent / 100.0f) + 0.5f);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < AFE_STATS_LATENCY_BUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            return 1u << i;
+        }
+    }
+    return hist->max_us / 1000;
+}
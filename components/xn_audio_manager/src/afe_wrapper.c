@@ -9,17 +9,44 @@
  * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved. 
  */
 #include "afe_wrapper.h"
+#include "drift_comp.h"
+#include "delay_est.h"
+#include "soft_vad.h"
+#include "afe_stats.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_gmf_afe_manager.h"
 #include "esp_afe_sr_models.h"
 #include "esp_afe_sr_iface.h"
 #include "esp_afe_config.h"
 #include "model_path.h"
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "AFE_WRAPPER";
 
+#define AFE_REF_DELAY_MAX_LAG  2048    ///< 延迟估计搜索范围（采样点数，±128ms @16kHz）
+#define AFE_GATE_CLOSE_MS      1000    ///< 低功耗监听：无人声、无播放、未录音持续多久后暂停 AFE
+#define AFE_GATE_MIN_BACKLOG_MS 300    ///< 低功耗监听：恢复时至少补送的历史（覆盖唤醒词开头）
+#define AFE_BYPASS_FRAME_SAMPLES 512   ///< 直通模式每块采样点数（与 AFE 输出块一致，32ms @16kHz）
+#define AFE_BYPASS_TASK_STACK  (6 * 1024)  ///< 直通采集任务栈（录音回调在此任务中运行，可能直接发送网络数据）
+#define AFE_BYPASS_IDLE_MS     20      ///< 直通模式未运行时的轮询间隔
+#define AFE_RINGBUF_FRAMES     120     ///< AFE 内部环形缓冲区容量（feed 块数，加大以提供更多缓冲空间）
+#define AFE_STATS_STAMPS       128     ///< 已送入未取出的 feed 块时间戳个数（超出时丢弃最旧的）
+#define AFE_TASK_DEFAULT_PRIO  8       ///< feed/fetch 任务默认优先级
+#define AFE_FEED_DEFAULT_CORE  1       ///< feed 任务默认核心
+#define AFE_FETCH_DEFAULT_CORE 0       ///< fetch 任务默认核心（与 feed 分核）
+
+/** 一个 feed 块的时间戳 */
+typedef struct {
+    uint64_t end_index;                         ///< 块末尾在麦克风流中的序号（不含）
+    int64_t feed_us;                            ///< 送入 AFE 的时间
+} afe_feed_stamp_t;
+
 /**
  * @brief AFE 包装器上下文结构体
  * 
@@ -28,12 +55,19 @@ static const char *TAG = "AFE_WRAPPER";
 typedef struct afe_wrapper_s {
     esp_gmf_afe_manager_handle_t afe_manager;  ///< AFE Manager 句柄
     esp_afe_sr_iface_t *afe_handle;            ///< AFE 接口句柄
+    bool bypass;                                ///< 直通模式：前端功能全部关闭，不创建 AFE
+    TaskHandle_t capture_task;                  ///< 直通采集任务（代替 AFE 的 feed/fetch 任务）
+    volatile bool capture_running;              ///< 直通采集任务运行标志
+    SemaphoreHandle_t capture_done;             ///< 直通采集任务退出信号
     srmodel_list_t *models;                     ///< 语音识别模型列表
     
     audio_bsp_handle_t bsp_handle;              ///< BSP 句柄，用于读取麦克风数据
     ring_buffer_handle_t reference_rb;         ///< 回采数据环形缓冲区
     
     afe_wakeup_config_t wakeup_config;         ///< 唤醒词配置
+    afe_vad_config_t vad_config;                ///< VAD 配置（重建流水线时使用）
+    afe_feature_config_t feature_config;        ///< 功能配置（重建流水线时使用）
+    afe_task_config_t task_config;              ///< 任务调度配置（已填入默认值）
     afe_event_callback_t event_callback;       ///< 事件回调函数
     void *event_ctx;                            ///< 事件回调上下文
     afe_record_callback_t record_callback;      ///< 录音数据回调函数
@@ -41,17 +75,618 @@ typedef struct afe_wrapper_s {
     
     bool *running_ptr;                          ///< 指向运行状态标志的指针
     bool *recording_ptr;                        ///< 指向录音状态标志的指针
+
+    // 采样时钟
+    uint32_t sample_rate;                       ///< 麦克风采样率
+    uint64_t mic_index;                         ///< 已送入 AFE 的麦克风采样点数（feed 任务私有）
+    uint64_t out_index;                         ///< 已取出的 AFE 输出采样点数（fetch 任务私有）
+    afe_stream_timing_t timing;                 ///< 最近一块的流时间信息（由 timing_lock 保护）
+    portMUX_TYPE timing_lock;                   ///< 保护 timing（feed/fetch/查询跨任务访问）
+
+    // 时钟漂移补偿（feed 任务私有）
+    drift_comp_handle_t drift;                  ///< 漂移补偿器（未启用时为 NULL）
+    bool ref_streaming;                         ///< 回采数据是否连续（中断后恢复时重新锁定）
+    float ref_level;                            ///< 本块的等效水位（采样点数）
+    bool ref_hold;                              ///< 本块刚对齐或正在补零（不更新漂移和延迟估计）
+
+    // 回采延迟对齐（feed 任务私有，请求经 timing_lock 传递）
+    delay_est_handle_t delay_est;               ///< 延迟估计器（未启用 AEC 时为 NULL）
+    bool delay_auto;                            ///< 没有有效延迟时在回采流开始时自动估计
+    bool delay_estimating;                      ///< 正在估计
+    double delay_level_sum;                     ///< 估计期间等效水位之和
+    uint32_t delay_level_blocks;                ///< 估计期间的块数
+    bool ref_realign;                           ///< 下一块重新对齐
+    size_t ref_pad;                             ///< 待补零的回采采样点数
+    bool delay_start_req;                       ///< 请求开始估计（timing_lock）
+    bool delay_set_req;                         ///< 请求设置延迟（timing_lock）
+    int32_t delay_set_value;                    ///< 请求设置的延迟（timing_lock）
+    afe_ref_delay_t delay;                      ///< 当前延迟状态（只由 feed 任务修改，其他任务经 timing_lock 读取）
     
-    // 静态缓冲区（避免频繁 malloc）
-    int16_t mic_buffer[512];                    ///< 麦克风数据缓冲区
-    int16_t ref_buffer[512];                    ///< 回采数据缓冲区
+    // 录音预录（fetch 任务私有）：未录音时保留最近一段处理后的音频，录音开始时先补发
+    int16_t *preroll_buf;                       ///< 预录环形缓冲区（未启用时为 NULL）
+    size_t preroll_cap;                         ///< 容量（采样点数）
+    size_t preroll_len;                         ///< 已保存的采样点数
+    size_t preroll_pos;                         ///< 下一个写入位置
+    bool was_recording;                         ///< 上一块是否在录音（检测录音开始）
+    bool vad_active;                            ///< AFE VAD 当前是否为人声（fetch 任务私有）
+
+    // 低功耗监听：门关闭时 AFE 不处理数据，只由 feed 任务对原始麦克风跑软件 VAD；
+    // 检测到人声（或开始播放/录音）时开门，先补送关门期间最近的历史再送实时数据。
+    // 门打开后软件 VAD 改由 fetch 任务处理 AFE 输出（已消除回声），空闲一段时间后再关门
+    soft_vad_handle_t soft_vad;                 ///< 软件 VAD（未启用低功耗监听时为 NULL）
+    portMUX_TYPE vad_lock;                      ///< 保护 soft_vad（开关门时在 feed/fetch 任务间交接）
+    volatile bool gate_open;                    ///< AFE 是否在处理（feed 任务开门，fetch 任务关门）
+    uint32_t gate_idle;                         ///< 门打开后连续空闲的输出采样点数（fetch 任务）
+    int16_t *gate_hist;                         ///< 关门期间的麦克风历史（环形，feed 任务私有）
+    size_t gate_hist_cap;                       ///< 历史容量（采样点数）
+    size_t gate_hist_len;                       ///< 已保存的采样点数
+    size_t gate_hist_pos;                       ///< 下一个写入位置
+    size_t gate_backlog;                        ///< 开门后待补送的历史采样点数
+    int64_t gate_hist_end_us;                   ///< 历史最后一个采样点之后的采集时间
+
+    // 按 AFE feed 块大小分配的缓冲区（只在块变大时重新分配，避免频繁 malloc）
+    int16_t *mic_buffer;                        ///< 麦克风数据缓冲区
+    int16_t *ref_buffer;                        ///< 对齐/重采样后的回采数据（与 mic_buffer 同一块内存，直通时不使用）
+    size_t buffer_samples;                      ///< 缓冲区容量（每通道采样点数）
+
+    // 流水线统计（stats_lock 保护）：feed 任务按块记录送入时间，fetch 任务取出对应输出时计算延迟
+    portMUX_TYPE stats_lock;                    ///< 保护统计数据（feed/fetch/查询跨任务访问）
+    afe_pipeline_stats_t stats;                 ///< 累计统计
+    int64_t stats_start_us;                     ///< 统计开始时间
+    uint64_t fed_index;                         ///< 已送入 AFE 的采样点数
+    size_t feed_chunk;                          ///< 最近的 feed 块大小（换算环形缓冲区帧数）
+    afe_feed_stamp_t stamps[AFE_STATS_STAMPS];  ///< 已送入未取出的块（环形）
+    uint32_t stamp_head;                        ///< 下一个写入位置
+    uint32_t stamp_count;                       ///< 时间戳个数
+    uint64_t depth_sum;                         ///< 深度采样之和（帧）
+    uint32_t depth_samples;                     ///< 深度采样次数
+    TaskHandle_t feed_task;                     ///< feed 任务（直通模式下为采集任务，首次回调时记录）
+    TaskHandle_t fetch_task;                    ///< fetch 任务（首次回调时记录）
+    uint32_t feed_run_base;                     ///< 统计开始时 feed 任务的运行时间计数
+    uint32_t fetch_run_base;                    ///< 统计开始时 fetch 任务的运行时间计数
+    int64_t read_wait_us;                       ///< 本块等待麦克风数据的时间（feed 任务私有）
+    afe_reconfig_info_t reconfig;               ///< 唤醒词重新配置耗时（stats_lock）
 } afe_wrapper_t;
 
 /**
- * @brief AFE 读取回调函数
+ * @brief 读取任务的运行时间计数（微秒，未启用 FreeRTOS 运行时间统计时为 0）
+ * 
+ * @param task 任务句柄
+ * @return uint32_t 运行时间计数
+ */
+static uint32_t afe_task_run_time(TaskHandle_t task)
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    return task ? (uint32_t)ulTaskGetRunTimeCounter(task) : 0;
+#else
+    (void)task;
+    return 0;
+#endif
+}
+
+/**
+ * @brief 读取麦克风数据并累计等待时间（任务负载统计不计入阻塞等待）
+ * 
+ * @param wrapper AFE 包装器
+ * @param samples 读取的采样点数
+ * @param got 实际读取的采样点数
+ * @return esp_err_t 读取结果
+ */
+static esp_err_t afe_read_mic(afe_wrapper_t *wrapper, size_t samples, size_t *got)
+{
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = audio_bsp_read_mic(wrapper->bsp_handle, wrapper->mic_buffer, samples, got);
+    wrapper->read_wait_us += esp_timer_get_time() - start;
+    return ret;
+}
+
+/**
+ * @brief 累计一次回调的处理耗时
+ * 
+ * @param wrapper AFE 包装器
+ * @param load 任务负载统计
+ * @param task 任务句柄指针（首次调用时记录当前任务）
+ * @param run_base 运行时间基准（首次调用时记录）
+ * @param busy_us 处理耗时
+ */
+static void afe_stats_add_load(afe_wrapper_t *wrapper, afe_task_load_t *load, TaskHandle_t *task,
+                               uint32_t *run_base, int64_t busy_us)
+{
+    TaskHandle_t self = *task ? NULL : xTaskGetCurrentTaskHandle();
+    uint32_t run = self ? afe_task_run_time(self) : 0;
+    uint32_t us = busy_us < 0 ? 0 : (uint32_t)busy_us;
+
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    if (self) {
+        *task = self;
+        *run_base = run;
+    }
+    load->calls++;
+    load->callback_us += us;
+    if (us > load->callback_max_us) load->callback_max_us = us;
+    portEXIT_CRITICAL(&wrapper->stats_lock);
+}
+
+/**
+ * @brief 记录一块送入 AFE 的数据（feed 任务调用）
+ * 
+ * @param wrapper AFE 包装器
+ * @param samples 采样点数
+ */
+static void afe_stats_on_feed(afe_wrapper_t *wrapper, size_t samples)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    wrapper->fed_index += samples;
+    wrapper->feed_chunk = samples;
+    wrapper->stamps[wrapper->stamp_head] = (afe_feed_stamp_t){
+        .end_index = wrapper->fed_index,
+        .feed_us = now,
+    };
+    wrapper->stamp_head = (wrapper->stamp_head + 1) % AFE_STATS_STAMPS;
+    if (wrapper->stamp_count < AFE_STATS_STAMPS) {
+        wrapper->stamp_count++;
+    }
+    portEXIT_CRITICAL(&wrapper->stats_lock);
+}
+
+/**
+ * @brief 记录一块输出：采集/送入到取出的延迟和 AFE 环形缓冲区深度
+ * 
+ * AFE 输出与输入逐点对应，输出到达某个 feed 块的末尾时，该块的送入时间即可配对。
+ * 已送入未取出的采样点数按 feed 块换算，近似 AFE 环形缓冲区深度（含 fetch 正在处理的一块）。
+ * 
+ * @param wrapper AFE 包装器
+ * @param capture_us 本块首个采样点的采集时间
+ * @param end_index 本块末尾在输出流中的序号（不含）
+ */
+static void afe_stats_on_output(afe_wrapper_t *wrapper, int64_t capture_us, uint64_t end_index)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    afe_latency_hist_add(&wrapper->stats.capture_to_fetch, now - capture_us);
+    if (!wrapper->bypass) {
+        while (wrapper->stamp_count > 0) {
+            uint32_t tail = (wrapper->stamp_head + AFE_STATS_STAMPS - wrapper->stamp_count) % AFE_STATS_STAMPS;
+            if (wrapper->stamps[tail].end_index > end_index) {
+                break;
+            }
+            afe_latency_hist_add(&wrapper->stats.feed_to_fetch, now - wrapper->stamps[tail].feed_us);
+            wrapper->stamp_count--;
+        }
+
+        if (wrapper->feed_chunk > 0 && wrapper->fed_index >= end_index) {
+            uint32_t depth = (uint32_t)((wrapper->fed_index - end_index) / wrapper->feed_chunk);
+            if (depth > wrapper->stats.ringbuf_depth_max) wrapper->stats.ringbuf_depth_max = depth;
+            wrapper->depth_sum += depth;
+            wrapper->depth_samples++;
+        }
+    }
+    portEXIT_CRITICAL(&wrapper->stats_lock);
+}
+
+/**
+ * @brief 处理应用层的延迟请求（设置/开始估计）
  * 
- * 从 I2S HAL 读取麦克风数据，从环形缓冲区读取回采数据，
- * 并将两者交织成 MR（麦克风+回采）格式供 AFE 处理
+ * @param wrapper AFE 包装器
+ */
+static void afe_poll_delay_requests(afe_wrapper_t *wrapper)
+{
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    bool start = wrapper->delay_start_req;
+    bool set = wrapper->delay_set_req;
+    int32_t value = wrapper->delay_set_value;
+    wrapper->delay_start_req = false;
+    wrapper->delay_set_req = false;
+    if (set) {
+        wrapper->delay.delay_samples = value;
+        wrapper->delay.valid = value >= 0;
+    }
+    if (start && wrapper->delay_est) {
+        wrapper->delay.estimating = true;
+    }
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+
+    if (set) {
+        wrapper->ref_realign = true;
+    }
+    if (start && wrapper->delay_est) {
+        delay_est_reset(wrapper->delay_est);
+        wrapper->delay_level_sum = 0;
+        wrapper->delay_level_blocks = 0;
+        wrapper->delay_estimating = true;
+    }
+}
+
+/**
+ * @brief 回采流开始（或目标延迟变化）时一次性对齐
+ * 
+ * 等效水位就是当前配对回采相对麦克风的延迟：高于目标延迟时丢弃多出的回采，
+ * 低于目标时先输出相应数量的零，之后由漂移补偿维持在目标附近。
+ * 
+ * @param wrapper AFE 包装器
+ * @param available 回采缓冲区当前数据量
+ */
+static void afe_align_reference(afe_wrapper_t *wrapper, size_t available)
+{
+    wrapper->ref_pad = 0;
+
+    if (wrapper->delay.valid) {
+        int32_t diff = (int32_t)lroundf(wrapper->ref_level) - wrapper->delay.delay_samples;
+        if (diff > 0) {
+            ring_buffer_span_t span;
+            size_t drop = ring_buffer_peek_read(wrapper->reference_rb,
+                                                (size_t)diff < available ? (size_t)diff : available,
+                                                &span, 0);
+            ring_buffer_release_read(wrapper->reference_rb, drop);
+        } else {
+            wrapper->ref_pad = (size_t)(-diff);
+        }
+    } else if (wrapper->delay_auto && wrapper->delay_est && !wrapper->delay_estimating) {
+        // 还没有有效延迟：在这段回采流上自动估计
+        portENTER_CRITICAL(&wrapper->timing_lock);
+        wrapper->delay_start_req = true;
+        portEXIT_CRITICAL(&wrapper->timing_lock);
+    }
+
+    // 流重新开始后配对关系改变，进行中的估计从头开始
+    if (wrapper->delay_estimating) {
+        delay_est_reset(wrapper->delay_est);
+        wrapper->delay_level_sum = 0;
+        wrapper->delay_level_blocks = 0;
+    }
+}
+
+/**
+ * @brief 按麦克风时钟重采样取出回采数据
+ * 
+ * 直接在环形缓冲区内存上重采样，按实际消耗量释放，未消耗的部分留在缓冲区。
+ * 
+ * @param wrapper AFE 包装器
+ * @param out 输出
+ * @param samples 需要的采样点数
+ * @param available 回采缓冲区当前数据量
+ * @return 实际输出的采样点数
+ */
+static size_t afe_resample_reference(afe_wrapper_t *wrapper, int16_t *out, size_t samples,
+                                     size_t available)
+{
+    // 多取少量输入以覆盖最大补偿量下的额外消耗（数据足够一块时不多要，避免被记为欠载）
+    size_t want = samples + samples / 256 + 4;
+    if (want > available && available >= samples) {
+        want = available;
+    }
+    ring_buffer_span_t span;
+    ring_buffer_peek_read(wrapper->reference_rb, want, &span, 0);
+
+    size_t produced = 0;
+    size_t consumed = 0;
+    for (int seg = 0; seg < 2 && produced < samples; seg++) {
+        size_t n = 0;
+        consumed += drift_comp_process(wrapper->drift, span.data[seg], span.len[seg],
+                                       out + produced, samples - produced, &n);
+        produced += n;
+    }
+
+    ring_buffer_release_read(wrapper->reference_rb, consumed);
+    return produced;
+}
+
+/**
+ * @brief 复制取出回采数据（不做漂移补偿时）
+ */
+static size_t afe_copy_reference(afe_wrapper_t *wrapper, int16_t *out, size_t samples)
+{
+    ring_buffer_span_t span;
+    size_t got = ring_buffer_peek_read(wrapper->reference_rb, samples, &span, 0);
+    memcpy(out, span.data[0], span.len[0] * sizeof(int16_t));
+    if (span.len[1] > 0) {
+        memcpy(out + span.len[0], span.data[1], span.len[1] * sizeof(int16_t));
+    }
+    ring_buffer_release_read(wrapper->reference_rb, got);
+    return got;
+}
+
+/**
+ * @brief 取出对齐后的回采数据到 ref_buffer
+ * 
+ * 1. 回采流开始或目标延迟变化时一次性对齐（丢弃或补零）
+ * 2. 用等效水位更新漂移估计（有时间戳时为麦克风/回采时间差换算的采样点数，
+ *    否则为缓冲区水位），对齐/补零的块不更新，补零结束后的第一块作为新的锁定点
+ * 3. 漂移补偿时重采样，否则直接复制
+ * 
+ * @param wrapper AFE 包装器
+ * @param samples 需要的回采采样点数（与麦克风块等长）
+ * @param level_us 麦克风采集时间 - 回采播放时间，INT64_MIN 表示没有时间戳
+ * @return 实际输出到 ref_buffer 的采样点数（含补零）
+ */
+static size_t afe_read_reference(afe_wrapper_t *wrapper, size_t samples, int64_t level_us)
+{
+    size_t available = ring_buffer_available(wrapper->reference_rb);
+    if (available == 0 && wrapper->ref_pad == 0) {
+        wrapper->ref_streaming = false;
+        return 0;
+    }
+
+    wrapper->ref_level = level_us != INT64_MIN ?
+                         (float)level_us * wrapper->sample_rate / 1000000.0f : (float)available;
+    wrapper->ref_hold = false;
+
+    if (!wrapper->ref_streaming || wrapper->ref_realign) {
+        wrapper->ref_streaming = true;
+        wrapper->ref_realign = false;
+        wrapper->ref_hold = true;
+        afe_align_reference(wrapper, available);
+        drift_comp_relock(wrapper->drift);
+        available = ring_buffer_available(wrapper->reference_rb);
+    }
+
+    // 目标延迟大于当前配对延迟：先补零
+    size_t produced = wrapper->ref_pad < samples ? wrapper->ref_pad : samples;
+    memset(wrapper->ref_buffer, 0, produced * sizeof(int16_t));
+    wrapper->ref_pad -= produced;
+    if (produced > 0) {
+        wrapper->ref_hold = true;
+    }
+
+    if (wrapper->drift && !wrapper->ref_hold) {
+        drift_comp_update(wrapper->drift, wrapper->ref_level, samples);
+    }
+
+    if (produced < samples && available > 0) {
+        produced += wrapper->drift ?
+                    afe_resample_reference(wrapper, wrapper->ref_buffer + produced,
+                                           samples - produced, available) :
+                    afe_copy_reference(wrapper, wrapper->ref_buffer + produced, samples - produced);
+    }
+    return produced;
+}
+
+/**
+ * @brief 把配对好的一块数据送入延迟估计器，累计完成后更新目标延迟
+ * 
+ * 估计出的 lag 是相对当前配对的残余延迟，总延迟 = 估计期间的平均等效水位 + lag。
+ * 
+ * @param wrapper AFE 包装器
+ * @param samples 采样点数
+ */
+static void afe_feed_delay_estimator(afe_wrapper_t *wrapper, size_t samples)
+{
+    wrapper->delay_level_sum += wrapper->ref_level;
+    wrapper->delay_level_blocks++;
+    if (!delay_est_feed(wrapper->delay_est, wrapper->mic_buffer, wrapper->ref_buffer, samples)) {
+        return;
+    }
+
+    delay_est_result_t result;
+    bool ok = delay_est_get_result(wrapper->delay_est, &result);
+    int32_t delay = (int32_t)lround(wrapper->delay_level_sum / wrapper->delay_level_blocks) + result.lag;
+    ok = ok && delay >= 0;
+    wrapper->delay_estimating = false;
+
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    wrapper->delay.estimating = false;
+    wrapper->delay.confidence = result.confidence;
+    if (ok) {
+        wrapper->delay.delay_samples = delay;
+        wrapper->delay.valid = true;
+    }
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+
+    if (ok) {
+        wrapper->ref_realign = true;
+        ESP_LOGI(TAG, "✅ 回采延迟估计: %d 采样点 (%.1f ms), 置信度 %.1f",
+                 (int)delay, delay * 1000.0f / wrapper->sample_rate, result.confidence);
+    } else {
+        ESP_LOGW(TAG, "⚠️ 回采延迟估计失败: 置信度 %.1f（回采信号太弱或回声路径不明显）",
+                 result.confidence);
+    }
+}
+
+/**
+ * @brief 发送 VAD 事件
+ * 
+ * @param wrapper AFE 包装器
+ * @param type AFE_EVENT_VAD_START 或 AFE_EVENT_VAD_END
+ */
+static void afe_emit_vad_event(afe_wrapper_t *wrapper, afe_event_type_t type)
+{
+    afe_event_t event = { .type = type };
+    wrapper->event_callback(&event, wrapper->event_ctx);
+}
+
+/**
+ * @brief 打开门：AFE 恢复处理，先补送历史（feed 任务调用）
+ * 
+ * @param wrapper AFE 包装器
+ * @param reason 原因（日志用）
+ */
+static void afe_gate_open(afe_wrapper_t *wrapper, const char *reason)
+{
+    wrapper->gate_backlog = wrapper->gate_hist_len;
+    wrapper->gate_idle = 0;
+    wrapper->gate_open = true;
+    ESP_LOGI(TAG, "🔔 AFE 恢复处理（%s），补送 %d ms 历史", reason,
+             (int)(wrapper->gate_backlog * 1000 / wrapper->sample_rate));
+}
+
+/**
+ * @brief 门关闭时的处理：读取麦克风、保存历史、软件 VAD 检测（feed 任务调用）
+ * 
+ * 不向 AFE 提供数据，AFE 的 fetch 任务随之空闲。
+ * 
+ * @param wrapper AFE 包装器
+ * @param frame_samples 每次读取的采样点数
+ */
+static void afe_gate_listen(afe_wrapper_t *wrapper, size_t frame_samples)
+{
+    size_t got = 0;
+    if (afe_read_mic(wrapper, frame_samples, &got) != ESP_OK || got == 0) {
+        return;
+    }
+    wrapper->gate_hist_end_us = esp_timer_get_time();
+
+    // 保存历史（覆盖最旧的数据）
+    const size_t cap = wrapper->gate_hist_cap;
+    const int16_t *src = wrapper->mic_buffer;
+    size_t n = got;
+    if (n > cap) {
+        src += n - cap;
+        n = cap;
+    }
+    size_t first = cap - wrapper->gate_hist_pos;
+    if (first > n) first = n;
+    memcpy(wrapper->gate_hist + wrapper->gate_hist_pos, src, first * sizeof(int16_t));
+    memcpy(wrapper->gate_hist, src + first, (n - first) * sizeof(int16_t));
+    wrapper->gate_hist_pos = (wrapper->gate_hist_pos + n) % cap;
+    wrapper->gate_hist_len = wrapper->gate_hist_len + n > cap ? cap : wrapper->gate_hist_len + n;
+
+    portENTER_CRITICAL(&wrapper->vad_lock);
+    soft_vad_event_t ev = soft_vad_process(wrapper->soft_vad, wrapper->mic_buffer, got);
+    portEXIT_CRITICAL(&wrapper->vad_lock);
+
+    if (ev == SOFT_VAD_EVENT_START) {
+        afe_emit_vad_event(wrapper, AFE_EVENT_VAD_START);
+        afe_gate_open(wrapper, "检测到人声");
+    } else if (wrapper->recording_ptr && *wrapper->recording_ptr) {
+        afe_gate_open(wrapper, "录音");
+    } else if (ring_buffer_available(wrapper->reference_rb) > 0) {
+        afe_gate_open(wrapper, "播放");  // 播放期间需要 AEC，VAD 也要在消除回声后的信号上判断
+    }
+}
+
+/**
+ * @brief 开门后补送一块历史数据（回采补零，feed 任务调用）
+ * 
+ * @param wrapper AFE 包装器
+ * @param out_buf 交织输出缓冲区
+ * @param frame_samples 本次最多补送的采样点数
+ * @return 写入 out_buf 的字节数
+ */
+static int32_t afe_gate_feed_backlog(afe_wrapper_t *wrapper, int16_t *out_buf, size_t frame_samples)
+{
+    const size_t cap = wrapper->gate_hist_cap;
+    size_t n = wrapper->gate_backlog < frame_samples ? wrapper->gate_backlog : frame_samples;
+    size_t pos = (wrapper->gate_hist_pos + cap - wrapper->gate_backlog) % cap;
+
+    // 历史的采集时间按最后一个采样点倒推
+    audio_frame_info_t mic_info = {
+        .sample_index = wrapper->mic_index,
+        .timestamp_us = wrapper->gate_hist_end_us -
+                        (int64_t)wrapper->gate_backlog * 1000000 / wrapper->sample_rate,
+    };
+    wrapper->mic_index += n;
+
+    for (size_t i = 0; i < n; i++) {
+        out_buf[i * 2 + 0] = wrapper->gate_hist[pos];
+        out_buf[i * 2 + 1] = 0;
+        pos = pos + 1 == cap ? 0 : pos + 1;
+    }
+
+    wrapper->gate_backlog -= n;
+    if (wrapper->gate_backlog == 0) {
+        wrapper->gate_hist_len = 0;
+        wrapper->gate_hist_pos = 0;
+    }
+
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    wrapper->timing.mic = mic_info;
+    wrapper->timing.reference_valid = false;
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+
+    return n * 2 * sizeof(int16_t);
+}
+
+/**
+ * @brief 门打开时在 AFE 输出上跑软件 VAD，空闲后关门（fetch 任务调用）
+ * 
+ * @param wrapper AFE 包装器
+ * @param data AFE 输出
+ * @param samples 采样点数
+ */
+static void afe_gate_update(afe_wrapper_t *wrapper, const int16_t *data, size_t samples)
+{
+    if (!wrapper->gate_open) {
+        return;  // 已关门：软件 VAD 由 feed 任务接管，AFE 残留输出不再计入
+    }
+
+    portENTER_CRITICAL(&wrapper->vad_lock);
+    soft_vad_event_t ev = soft_vad_process(wrapper->soft_vad, data, samples);
+    bool speech = soft_vad_is_speech(wrapper->soft_vad);
+    portEXIT_CRITICAL(&wrapper->vad_lock);
+
+    if (ev == SOFT_VAD_EVENT_START) {
+        afe_emit_vad_event(wrapper, AFE_EVENT_VAD_START);
+    } else if (ev == SOFT_VAD_EVENT_END) {
+        afe_emit_vad_event(wrapper, AFE_EVENT_VAD_END);
+    }
+
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    bool playing = wrapper->timing.reference_valid;
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+    bool recording = wrapper->recording_ptr && *wrapper->recording_ptr;
+
+    if (wrapper->bypass) {
+        return;  // 直通模式没有 AFE 可暂停，软件 VAD 只负责产生事件
+    }
+    if (speech || playing || recording) {
+        wrapper->gate_idle = 0;
+        return;
+    }
+    wrapper->gate_idle += samples;
+    if (wrapper->gate_idle >= wrapper->sample_rate * AFE_GATE_CLOSE_MS / 1000) {
+        wrapper->gate_open = false;
+        ESP_LOGI(TAG, "💤 AFE 暂停处理，软件 VAD 监听中");
+    }
+}
+
+/**
+ * @brief 按 AFE 请求的 feed 块大小准备缓冲区
+ * 
+ * AFE 每次请求 get_feed_chunksize() × 通道数 个采样点，块大小随 AFE 模式和模型而变，
+ * 因此以实际请求为准：首次请求（以及块变大时）分配麦克风/回采缓冲区，
+ * 并让 BSP 按同一大小分配 I2S 读取缓冲区，一次读取即可取满一块。
+ * 只在 feed 任务中调用，它也是唯一读取麦克风的任务，重新分配无需加锁。
+ * 
+ * @param wrapper AFE 包装器
+ * @param frame_samples 每通道采样点数
+ * @return ESP_OK 成功，ESP_ERR_NO_MEM 分配失败（原缓冲区保持不变）
+ */
+static esp_err_t afe_prepare_buffers(afe_wrapper_t *wrapper, size_t frame_samples)
+{
+    if (frame_samples <= wrapper->buffer_samples) {
+        return ESP_OK;
+    }
+
+    int16_t *buffer = (int16_t *)malloc(frame_samples * 2 * sizeof(int16_t));
+    if (!buffer) {
+        ESP_LOGE(TAG, "AFE 缓冲区分配失败: %d", (int)frame_samples);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = audio_bsp_set_mic_frame_samples(wrapper->bsp_handle, frame_samples);
+    if (ret != ESP_OK) {
+        free(buffer);
+        return ret;
+    }
+
+    free(wrapper->mic_buffer);
+    wrapper->mic_buffer = buffer;
+    wrapper->ref_buffer = buffer + frame_samples;
+    wrapper->buffer_samples = frame_samples;
+    ESP_LOGI(TAG, "AFE feed 块大小: %d 采样点/通道", (int)frame_samples);
+    return ESP_OK;
+}
+
+/**
+ * @brief 准备一块送入 AFE 的数据
+ * 
+ * 从 I2S HAL 读取麦克风数据，直接在回采环形缓冲区内存上取回采数据，
+ * 并将两者交织成 MR（麦克风+回采）格式供 AFE 处理；启用漂移补偿时回采先按麦克风时钟重采样。
+ * 同时记录本块麦克风数据的采样序号与采集时间，以及配对回采数据的播放时间，
+ * 两者之差即为 AEC 看到的麦克风/回采偏差
  * 
  * @param buffer 输出缓冲区，用于存放交织后的音频数据
  * @param buf_sz 缓冲区大小（字节）
@@ -59,7 +694,7 @@ typedef struct afe_wrapper_s {
  * @param ticks 超时时间（未使用）
  * @return int32_t 实际读取的字节数
  */
-static int32_t afe_read_callback(void *buffer, int buf_sz, void *user_ctx, TickType_t ticks)
+static int32_t afe_feed_block(void *buffer, int buf_sz, void *user_ctx, TickType_t ticks)
 {
     afe_wrapper_t *wrapper = (afe_wrapper_t *)user_ctx;
     if (!buffer || buf_sz == 0 || !wrapper) return 0;
@@ -69,9 +704,8 @@ static int32_t afe_read_callback(void *buffer, int buf_sz, void *user_ctx, TickT
     const size_t channels = 2;  // MR: 麦克风+回采
     const size_t frame_samples = total_samples / channels;
 
-    // 检查帧大小是否超出缓冲区限制
-    if (frame_samples > 512) {
-        ESP_LOGE(TAG, "AFE 读取帧过大: %d", (int)frame_samples);
+    // 按 AFE 实际请求的块大小准备缓冲区（分配失败时本块静音）
+    if (afe_prepare_buffers(wrapper, frame_samples) != ESP_OK) {
         memset(out_buf, 0, buf_sz);
         return buf_sz;
     }
@@ -80,91 +714,582 @@ static int32_t afe_read_callback(void *buffer, int buf_sz, void *user_ctx, TickT
 
     // 仅在运行状态下读取数据
     if (wrapper->running_ptr && *wrapper->running_ptr) {
+        // 低功耗监听：门关闭时只跑软件 VAD，不向 AFE 提供数据
+        if (wrapper->soft_vad && !wrapper->gate_open) {
+            afe_gate_listen(wrapper, frame_samples);
+            memset(out_buf, 0, buf_sz);
+            return 0;
+        }
+        if (wrapper->gate_backlog > 0) {
+            return afe_gate_feed_backlog(wrapper, out_buf, frame_samples);
+        }
+
         // 读取麦克风数据
-        esp_err_t ret = audio_bsp_read_mic(wrapper->bsp_handle, wrapper->mic_buffer, 
-                                         frame_samples, &mic_got);
+        esp_err_t ret = afe_read_mic(wrapper, frame_samples, &mic_got);
 
         if (ret != ESP_OK || mic_got == 0) {
             memset(out_buf, 0, buf_sz);
             return buf_sz;
         }
 
-        // 读取回采数据（用于回声消除）
-        size_t ref_got = ring_buffer_read(wrapper->reference_rb, wrapper->ref_buffer, mic_got, 0);
+        // 读取返回时本块最后一个采样点刚采集完成，据此倒推首个采样点的采集时间
+        audio_frame_info_t mic_info = {
+            .sample_index = wrapper->mic_index,
+            .timestamp_us = esp_timer_get_time() - (int64_t)mic_got * 1000000 / wrapper->sample_rate,
+        };
+        wrapper->mic_index += mic_got;
+
+        audio_frame_info_t ref_info;
+        bool ref_stamped = ring_buffer_get_read_info(wrapper->reference_rb, &ref_info) == ESP_OK;
+        int64_t skew_us = ref_stamped ? mic_info.timestamp_us - ref_info.timestamp_us : 0;
+
+        afe_poll_delay_requests(wrapper);
+
+        size_t i = 0;
+        size_t ref_got;
+        if (wrapper->drift || wrapper->delay_est) {
+            // 回采对齐（及按麦克风时钟重采样）后交织
+            ref_got = afe_read_reference(wrapper, mic_got, ref_stamped ? skew_us : INT64_MIN);
+            if (wrapper->delay_estimating && !wrapper->ref_hold && ref_got == mic_got) {
+                afe_feed_delay_estimator(wrapper, mic_got);
+            }
+            for (; i < ref_got; i++) {
+                out_buf[i * 2 + 0] = wrapper->mic_buffer[i];  // M: 麦克风
+                out_buf[i * 2 + 1] = wrapper->ref_buffer[i];  // R: 回采
+            }
+        } else {
+            // 查看回采数据（用于回声消除），直接从环形缓冲区内存交织，不经中间缓冲区
+            ring_buffer_span_t span;
+            ref_got = ring_buffer_peek_read(wrapper->reference_rb, mic_got, &span, 0);
+
+            // 交织数据: MR 格式（M=麦克风，R=回采）
+            for (int seg = 0; seg < 2; seg++) {
+                const int16_t *ref = span.data[seg];
+                for (size_t j = 0; j < span.len[seg]; j++, i++) {
+                    out_buf[i * 2 + 0] = wrapper->mic_buffer[i];  // M: 麦克风
+                    out_buf[i * 2 + 1] = ref[j];                  // R: 回采
+                }
+            }
+            ring_buffer_release_read(wrapper->reference_rb, ref_got);
+        }
+
+        // 如果回采数据不足，用静音填充（次数计入回采缓冲区的欠载统计）
+        for (; i < mic_got; i++) {
+            out_buf[i * 2 + 0] = wrapper->mic_buffer[i];
+            out_buf[i * 2 + 1] = 0;
+        }
+
+        portENTER_CRITICAL(&wrapper->timing_lock);
+        wrapper->timing.mic = mic_info;
+        wrapper->timing.reference_valid = ref_stamped && ref_got > 0;
+        if (wrapper->timing.reference_valid) {
+            wrapper->timing.reference = ref_info;
+            wrapper->timing.skew_us = skew_us;
+        }
+        wrapper->timing.drift_ppm = drift_comp_get_ppm(wrapper->drift);
+        portEXIT_CRITICAL(&wrapper->timing_lock);
+    } else {
+        // 未运行时填充静音，并临时不向 AFE 提供有效数据，避免在系统尚未开始监听时填满内部 ringbuffer
+        memset(out_buf, 0, buf_sz);
+        return 0;
+    }
+
+    return mic_got * channels * sizeof(int16_t);
+}
+
+/**
+ * @brief AFE 读取回调函数
+ * 
+ * 准备一块数据送入 AFE，同时记录送入时间和处理耗时（不含等待麦克风数据的时间）
+ * 
+ * @param buffer 输出缓冲区，用于存放交织后的音频数据
+ * @param buf_sz 缓冲区大小（字节）
+ * @param user_ctx 用户上下文，指向 afe_wrapper_t 结构体
+ * @param ticks 超时时间（未使用）
+ * @return int32_t 实际读取的字节数
+ */
+static int32_t afe_read_callback(void *buffer, int buf_sz, void *user_ctx, TickType_t ticks)
+{
+    afe_wrapper_t *wrapper = (afe_wrapper_t *)user_ctx;
+    if (!wrapper) return 0;
+
+    int64_t start = esp_timer_get_time();
+    wrapper->read_wait_us = 0;
+    int32_t bytes = afe_feed_block(buffer, buf_sz, user_ctx, ticks);
+    if (bytes > 0) {
+        afe_stats_on_feed(wrapper, bytes / (2 * sizeof(int16_t)));
+    }
+    afe_stats_add_load(wrapper, &wrapper->stats.feed, &wrapper->feed_task, &wrapper->feed_run_base,
+                       esp_timer_get_time() - start - wrapper->read_wait_us);
+    return bytes;
+}
+
+/**
+ * @brief 按最近的麦克风锚点推算某个采样点的采集时间
+ * 
+ * AFE 输出与输入逐点对应，输出流序号即麦克风流序号
+ * 
+ * @param wrapper AFE 包装器
+ * @param sample_index 采样点序号
+ * @return int64_t 采集时间（微秒）
+ */
+static int64_t afe_capture_time(afe_wrapper_t *wrapper, uint64_t sample_index)
+{
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    audio_frame_info_t anchor = wrapper->timing.mic;
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+
+    int64_t offset = (int64_t)(sample_index - anchor.sample_index);
+    return anchor.timestamp_us + offset * 1000000 / wrapper->sample_rate;
+}
+
+/**
+ * @brief 将一块录音数据交给录音回调
+ * 
+ * 采集时间按 afe_capture_time 推算
+ * 
+ * @param wrapper AFE 包装器
+ * @param data 音频数据
+ * @param samples 采样点数
+ * @param sample_index 首个采样点在 AFE 输出流中的序号
+ */
+static void afe_deliver_record(afe_wrapper_t *wrapper, const int16_t *data, size_t samples,
+                               uint64_t sample_index)
+{
+    audio_frame_info_t info = {
+        .sample_index = sample_index,
+        .timestamp_us = afe_capture_time(wrapper, sample_index),
+    };
+    wrapper->record_callback(data, samples, &info, wrapper->record_ctx);
+}
+
+/**
+ * @brief 保存一块未录音时的音频到预录缓冲区（覆盖最旧的数据）
+ * 
+ * @param wrapper AFE 包装器
+ * @param data 音频数据
+ * @param samples 采样点数
+ */
+static void afe_preroll_push(afe_wrapper_t *wrapper, const int16_t *data, size_t samples)
+{
+    const size_t cap = wrapper->preroll_cap;
+    if (samples > cap) {
+        data += samples - cap;
+        samples = cap;
+    }
+
+    size_t first = cap - wrapper->preroll_pos;
+    if (first > samples) first = samples;
+    memcpy(wrapper->preroll_buf + wrapper->preroll_pos, data, first * sizeof(int16_t));
+    memcpy(wrapper->preroll_buf, data + first, (samples - first) * sizeof(int16_t));
+
+    wrapper->preroll_pos = (wrapper->preroll_pos + samples) % cap;
+    wrapper->preroll_len = wrapper->preroll_len + samples > cap ? cap : wrapper->preroll_len + samples;
+}
+
+/**
+ * @brief 录音开始时按时间顺序补发预录数据并清空
+ * 
+ * @param wrapper AFE 包装器
+ * @param next_index 预录数据之后第一个采样点的序号（即当前块的序号）
+ */
+static void afe_preroll_flush(afe_wrapper_t *wrapper, uint64_t next_index)
+{
+    const size_t cap = wrapper->preroll_cap;
+    size_t len = wrapper->preroll_len;
+    if (len == 0) {
+        return;
+    }
+
+    // 环形缓冲区按回绕点分两段，先旧后新
+    size_t start = (wrapper->preroll_pos + cap - len) % cap;
+    size_t first = cap - start;
+    if (first > len) first = len;
+    uint64_t index = next_index - len;
+    afe_deliver_record(wrapper, wrapper->preroll_buf + start, first, index);
+    if (len > first) {
+        afe_deliver_record(wrapper, wrapper->preroll_buf, len - first, index + first);
+    }
+
+    ESP_LOGD(TAG, "补发预录音频 %d 采样点", (int)len);
+    wrapper->preroll_len = 0;
+    wrapper->preroll_pos = 0;
+}
+
+/**
+ * @brief 处理一块处理后的音频：软件 VAD、预录和录音回调
+ * 
+ * AFE 模式下在 fetch 任务中调用，直通模式下在采集任务中调用。
+ * 
+ * @param wrapper AFE 包装器
+ * @param data 音频数据
+ * @param samples 采样点数
+ */
+static void afe_handle_output(afe_wrapper_t *wrapper, const int16_t *data, size_t samples)
+{
+    uint64_t index = wrapper->out_index;
+    wrapper->out_index += samples;
+    afe_stats_on_output(wrapper, afe_capture_time(wrapper, index), wrapper->out_index);
+
+    if (wrapper->soft_vad) {
+        afe_gate_update(wrapper, data, samples);
+    }
+
+    // 处理录音数据回调
+    // 录音标志要等 VAD_START 事件经 audio_mgr 任务处理后才置位，此前的句首保存在预录缓冲区，
+    // 录音开始时先按顺序补发，再发送当前块
+    bool recording = wrapper->recording_ptr && *wrapper->recording_ptr && wrapper->record_callback;
+    if (recording) {
+        if (!wrapper->was_recording && wrapper->preroll_buf) {
+            afe_preroll_flush(wrapper, index);
+        }
+        afe_deliver_record(wrapper, data, samples, index);
+    } else if (wrapper->preroll_buf) {
+        afe_preroll_push(wrapper, data, samples);
+    }
+    wrapper->was_recording = recording;
+}
+
+/**
+ * @brief AFE 结果回调函数
+ * 
+ * 处理 AFE 的处理结果，包括唤醒词检测、VAD 状态变化和录音数据
+ * 
+ * @param result AFE 处理结果
+ * @param user_ctx 用户上下文，指向 afe_wrapper_t 结构体
+ */
+static void afe_result_callback(afe_fetch_result_t *result, void *user_ctx)
+{
+    afe_wrapper_t *wrapper = (afe_wrapper_t *)user_ctx;
+    if (!result || !wrapper || !wrapper->event_callback) return;
+
+    int64_t start = esp_timer_get_time();
+    afe_event_t event = {0};
+
+    // 处理唤醒词检测事件
+    if (result->wakeup_state == WAKENET_DETECTED) {
+        event.type = AFE_EVENT_WAKEUP_DETECTED;
+        event.data.wakeup.wake_word_index = result->wake_word_index;
+        event.data.wakeup.volume_db = result->data_volume;
+
+        ESP_LOGI(TAG, "🎤 唤醒词检测: 索引=%d, 音量=%.1f dB",
+                 result->wake_word_index, result->data_volume);
+
+        wrapper->event_callback(&event, wrapper->event_ctx);
+    }
+
+    // 处理 VAD（语音活动检测）状态变化（低功耗监听时 AFE VAD 关闭，由软件 VAD 产生事件）
+    if (!wrapper->soft_vad) {
+        if (result->vad_state == VAD_SPEECH && !wrapper->vad_active) {
+            // 检测到语音开始
+            wrapper->vad_active = true;
+            afe_emit_vad_event(wrapper, AFE_EVENT_VAD_START);
+        } else if (result->vad_state == VAD_SILENCE && wrapper->vad_active) {
+            // 检测到语音结束
+            wrapper->vad_active = false;
+            afe_emit_vad_event(wrapper, AFE_EVENT_VAD_END);
+        }
+    }
+
+    if (result->data && result->data_size > 0) {
+        afe_handle_output(wrapper, (const int16_t *)result->data, result->data_size / sizeof(int16_t));
+    }
+
+    afe_stats_add_load(wrapper, &wrapper->stats.fetch, &wrapper->fetch_task, &wrapper->fetch_run_base,
+                       esp_timer_get_time() - start);
+}
+
+/**
+ * @brief 直通模式下丢弃回采数据（没有 AEC 消费，避免缓冲区写满）
+ * 
+ * @param wrapper AFE 包装器
+ */
+static void afe_bypass_drain_reference(afe_wrapper_t *wrapper)
+{
+    size_t available = ring_buffer_available(wrapper->reference_rb);
+    if (available > 0) {
+        ring_buffer_span_t span;
+        size_t got = ring_buffer_peek_read(wrapper->reference_rb, available, &span, 0);
+        ring_buffer_release_read(wrapper->reference_rb, got);
+    }
+}
+
+/**
+ * @brief 直通采集任务
+ * 
+ * 前端功能全部关闭时代替 AFE Manager：直接读取麦克风，按与 AFE 输出相同的块大小
+ * 交给录音路径（同样受 running/recording 控制，同样支持预录和软件 VAD）。
+ * 
+ * @param arg AFE 包装器
+ */
+static void afe_capture_task(void *arg)
+{
+    afe_wrapper_t *wrapper = (afe_wrapper_t *)arg;
+
+    if (afe_prepare_buffers(wrapper, AFE_BYPASS_FRAME_SAMPLES) != ESP_OK) {
+        wrapper->capture_running = false;
+    }
+
+    while (wrapper->capture_running) {
+        if (!wrapper->running_ptr || !*wrapper->running_ptr) {
+            afe_bypass_drain_reference(wrapper);
+            vTaskDelay(pdMS_TO_TICKS(AFE_BYPASS_IDLE_MS));
+            continue;
+        }
+
+        int64_t start = esp_timer_get_time();
+        wrapper->read_wait_us = 0;
+        size_t got = 0;
+        esp_err_t ret = afe_read_mic(wrapper, AFE_BYPASS_FRAME_SAMPLES, &got);
+        if (ret != ESP_OK || got == 0) {
+            vTaskDelay(pdMS_TO_TICKS(AFE_BYPASS_IDLE_MS));
+            continue;
+        }
+
+        audio_frame_info_t mic_info = {
+            .sample_index = wrapper->mic_index,
+            .timestamp_us = esp_timer_get_time() - (int64_t)got * 1000000 / wrapper->sample_rate,
+        };
+        wrapper->mic_index += got;
+        afe_bypass_drain_reference(wrapper);
+
+        portENTER_CRITICAL(&wrapper->timing_lock);
+        wrapper->timing.mic = mic_info;
+        wrapper->timing.reference_valid = false;
+        portEXIT_CRITICAL(&wrapper->timing_lock);
+
+        afe_handle_output(wrapper, wrapper->mic_buffer, got);
+        afe_stats_add_load(wrapper, &wrapper->stats.feed, &wrapper->feed_task, &wrapper->feed_run_base,
+                           esp_timer_get_time() - start - wrapper->read_wait_us);
+    }
+
+    ESP_LOGI(TAG, "直通采集任务结束");
+    xSemaphoreGive(wrapper->capture_done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 前端功能全部关闭时进入直通模式
+ * 
+ * AEC/NS/AGC/唤醒词全部关闭，且不需要 AFE VAD（未启用 VAD 或用软件 VAD）
+ * 
+ * @param wrapper AFE 包装器
+ * @return true 直通模式
+ */
+static bool afe_is_bypass(const afe_wrapper_t *wrapper)
+{
+    const afe_feature_config_t *features = &wrapper->feature_config;
+    return !features->aec_enabled && !features->ns_enabled && !features->agc_enabled &&
+           !wrapper->wakeup_config.enabled &&
+           (!wrapper->vad_config.enabled || wrapper->vad_config.listen_only);
+}
+
+/**
+ * @brief 按当前模式分配 AFE 模式才需要的资源（已分配的保留）
+ * 
+ * 直通模式没有回采消费者，不需要漂移补偿；门始终打开，不需要关门期间的历史。
+ * 
+ * @param wrapper AFE 包装器
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 分配失败
+ */
+static esp_err_t afe_pipeline_prepare(afe_wrapper_t *wrapper)
+{
+    if (wrapper->bypass) {
+        return ESP_OK;
+    }
+
+    // 低功耗监听：关门期间的麦克风历史（覆盖 VAD 判定延迟和预录时长）
+    if (wrapper->soft_vad && !wrapper->gate_hist) {
+        int backlog_ms = wrapper->vad_config.preroll_ms > AFE_GATE_MIN_BACKLOG_MS ?
+                         wrapper->vad_config.preroll_ms : AFE_GATE_MIN_BACKLOG_MS;
+        backlog_ms += wrapper->vad_config.min_speech_ms;
+        wrapper->gate_hist_cap = (size_t)wrapper->sample_rate * backlog_ms / 1000;
+        wrapper->gate_hist = (int16_t *)malloc(wrapper->gate_hist_cap * sizeof(int16_t));
+        if (!wrapper->gate_hist) {
+            ESP_LOGE(TAG, "低功耗监听历史缓冲区分配失败");
+            return ESP_ERR_NO_MEM;
+        }
+        ESP_LOGI(TAG, "低功耗监听：检测到人声后才启动 AFE 处理（历史 %d ms）", backlog_ms);
+    }
+
+    // 时钟漂移补偿
+    if (wrapper->feature_config.drift_comp_enabled && !wrapper->drift) {
+        drift_comp_config_t drift_cfg = { .sample_rate = wrapper->sample_rate };
+        wrapper->drift = drift_comp_create(&drift_cfg);
+        if (!wrapper->drift) {
+            ESP_LOGE(TAG, "漂移补偿器创建失败");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 启动采集流水线：直通模式创建采集任务，否则按当前配置和 wrapper->models 创建 AFE Manager
+ * 
+ * @param wrapper AFE 包装器
+ * @return esp_err_t ESP_OK 成功，其他值失败
+ */
+static esp_err_t afe_pipeline_start(afe_wrapper_t *wrapper)
+{
+    const afe_task_config_t *tasks = &wrapper->task_config;
+
+    // 直通模式：一个采集任务代替 AFE Manager 的 feed/fetch 任务和 AFE 环形缓冲区
+    if (wrapper->bypass) {
+        if (!wrapper->capture_done) {
+            wrapper->capture_done = xSemaphoreCreateBinary();
+        }
+        wrapper->capture_running = true;
+        if (!wrapper->capture_done ||
+            xTaskCreatePinnedToCore(afe_capture_task, "afe_capture", AFE_BYPASS_TASK_STACK, wrapper,
+                                    tasks->feed_priority, &wrapper->capture_task,
+                                    tasks->feed_core) != pdPASS) {
+            ESP_LOGE(TAG, "直通采集任务创建失败");
+            wrapper->capture_task = NULL;
+            wrapper->capture_running = false;
+            return ESP_ERR_NO_MEM;
+        }
+        ESP_LOGI(TAG, "✅ AFE 直通模式：前端功能全部关闭，直接采集麦克风");
+        return ESP_OK;
+    }
+
+    // 配置 AFE
+    ESP_LOGI(TAG, "配置 AFE Manager...");
+    afe_config_t *afe_config = afe_config_init("MR", wrapper->models, AFE_TYPE_SR, 
+                                                wrapper->feature_config.afe_mode);
+    if (!afe_config) {
+        ESP_LOGE(TAG, "AFE 配置失败");
+        return ESP_FAIL;
+    }
+
+    // 配置音频处理功能
+    afe_config->aec_init = wrapper->feature_config.aec_enabled;     // 回声消除
+    afe_config->se_init = false;                                    // 语音增强（未启用）
+    afe_config->vad_init = wrapper->vad_config.enabled && !wrapper->soft_vad;  // 语音活动检测（低功耗监听时用软件 VAD）
+    afe_config->vad_mode = wrapper->vad_config.vad_mode;            // VAD 模式
+    afe_config->vad_min_speech_ms = wrapper->vad_config.min_speech_ms;  // 最小语音时长
+    afe_config->vad_min_noise_ms = wrapper->vad_config.min_silence_ms;  // 最小静音时长
+    afe_config->wakenet_init = wrapper->wakeup_config.enabled;     // 唤醒词检测
+    afe_config->wakenet_mode = wrapper->wakeup_config.sensitivity;  // 唤醒词灵敏度
+    afe_config->afe_perferred_core = tasks->fetch_core;             // 与 fetch 任务同核
+    afe_config->afe_perferred_priority = tasks->fetch_priority;     // 任务优先级
+    afe_config->memory_alloc_mode = AFE_MEMORY_ALLOC_MORE_PSRAM;    // 优先使用 PSRAM
+    afe_config->agc_init = wrapper->feature_config.agc_enabled;    // 自动增益控制
+    afe_config->ns_init = wrapper->feature_config.ns_enabled;      // 噪声抑制
+    afe_config->afe_ringbuf_size = AFE_RINGBUF_FRAMES;              // 环形缓冲区大小（加大以提供更多缓冲空间）
+    wrapper->stats.ringbuf_capacity = AFE_RINGBUF_FRAMES;
+
+    // 唤醒词名称匹配分区中的模型名时使用该模型，否则使用分区中的第一个唤醒词模型
+    if (wrapper->wakeup_config.enabled && wrapper->wakeup_config.wake_word_name) {
+        char *wn_name = esp_srmodel_filter(wrapper->models, ESP_WN_PREFIX,
+                                           wrapper->wakeup_config.wake_word_name);
+        if (wn_name) {
+            afe_config->wakenet_model_name = wn_name;
+        }
+    }
+
+    // 验证配置并创建 AFE 句柄
+    afe_config = afe_config_check(afe_config);
+    wrapper->afe_handle = esp_afe_handle_from_config(afe_config);
+
+    // 创建 AFE Manager
+    esp_gmf_afe_manager_cfg_t mgr_cfg = {
+        .afe_cfg = afe_config,
+        .read_cb = afe_read_callback,              // 数据读取回调
+        .read_ctx = wrapper,                       // 读取回调上下文
+        .feed_task_setting = {
+            .stack_size = 10 * 1024,               // Feed 任务栈大小（缩减以降低内部RAM占用）
+            .prio = tasks->feed_priority,          // Feed 任务优先级
+            .core = tasks->feed_core,              // Feed 任务运行核心（默认 CPU1）
+        },
+        .fetch_task_setting = {
+            .stack_size = 10 * 1024,                // Fetch 任务栈大小（缩减占用）
+            .prio = tasks->fetch_priority,         // Fetch 任务优先级（默认与Feed相同，时间片轮转）
+            .core = tasks->fetch_core,             // Fetch 任务运行核心（默认 CPU0，与 Feed 分核）
+        },
+    };
 
-        // 如果回采数据不足，用静音填充
-        if (ref_got < mic_got) {
-            memset(wrapper->ref_buffer + ref_got, 0, (mic_got - ref_got) * sizeof(int16_t));
-        }
+    esp_err_t ret = esp_gmf_afe_manager_create(&mgr_cfg, &wrapper->afe_manager);
+    afe_config_free(afe_config);
 
-        // 交织数据: MR 格式（M=麦克风，R=回采）
-        for (size_t i = 0; i < mic_got; i++) {
-            out_buf[i * 2 + 0] = wrapper->mic_buffer[i];  // M: 麦克风
-            out_buf[i * 2 + 1] = wrapper->ref_buffer[i];  // R: 回采
-        }
-    } else {
-        // 未运行时填充静音，并临时不向 AFE 提供有效数据，避免在系统尚未开始监听时填满内部 ringbuffer
-        memset(out_buf, 0, buf_sz);
-        return 0;
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "AFE Manager 创建失败");
+        wrapper->afe_manager = NULL;
+        return ret;
     }
 
-    return mic_got * channels * sizeof(int16_t);
+    // 设置结果回调
+    esp_gmf_afe_manager_set_result_cb(wrapper->afe_manager, afe_result_callback, wrapper);
+    return ESP_OK;
 }
 
 /**
- * @brief AFE 结果回调函数
+ * @brief 停止采集流水线（直通采集任务或 AFE Manager）
  * 
- * 处理 AFE 的处理结果，包括唤醒词检测、VAD 状态变化和录音数据
+ * 返回后 feed/fetch 任务不再运行，其私有状态可由调用者直接修改
  * 
- * @param result AFE 处理结果
- * @param user_ctx 用户上下文，指向 afe_wrapper_t 结构体
+ * @param wrapper AFE 包装器
  */
-static void afe_result_callback(afe_fetch_result_t *result, void *user_ctx)
+static void afe_pipeline_stop(afe_wrapper_t *wrapper)
 {
-    afe_wrapper_t *wrapper = (afe_wrapper_t *)user_ctx;
-    if (!result || !wrapper || !wrapper->event_callback) return;
-
-    afe_event_t event = {0};
+    // 停止直通采集任务（麦克风读取最长阻塞 100ms）
+    if (wrapper->capture_task) {
+        wrapper->capture_running = false;
+        if (xSemaphoreTake(wrapper->capture_done, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ESP_LOGW(TAG, "直通采集任务未按时退出，强制删除");
+            vTaskDelete(wrapper->capture_task);
+        }
+        wrapper->capture_task = NULL;
+    }
 
-    // 处理唤醒词检测事件
-    if (result->wakeup_state == WAKENET_DETECTED) {
-        event.type = AFE_EVENT_WAKEUP_DETECTED;
-        event.data.wakeup.wake_word_index = result->wake_word_index;
-        event.data.wakeup.volume_db = result->data_volume;
+    // 销毁 AFE Manager
+    if (wrapper->afe_manager) {
+        esp_gmf_afe_manager_destroy(wrapper->afe_manager);
+        wrapper->afe_manager = NULL;
+        wrapper->afe_handle = NULL;
+    }
 
-        ESP_LOGI(TAG, "🎤 唤醒词检测: 索引=%d, 音量=%.1f dB",
-                 result->wake_word_index, result->data_volume);
+    // 任务已删除，不能再读取其运行时间
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    wrapper->feed_task = NULL;
+    wrapper->fetch_task = NULL;
+    portEXIT_CRITICAL(&wrapper->stats_lock);
+}
 
-        wrapper->event_callback(&event, wrapper->event_ctx);
-    }
+/**
+ * @brief 流水线重建后重新同步输入/输出流
+ * 
+ * 旧 AFE 环形缓冲区中未取出的数据随之丢弃，输出序号直接对齐到输入；
+ * AFE 内部状态（VAD、AEC）从头开始，回采在下一块重新对齐。
+ * 
+ * @param wrapper AFE 包装器
+ */
+static void afe_pipeline_resync(afe_wrapper_t *wrapper)
+{
+    wrapper->out_index = wrapper->mic_index;
+    wrapper->ref_streaming = false;
 
-    // 处理 VAD（语音活动检测）状态变化
-    static bool vad_active = false;
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    wrapper->fed_index = wrapper->mic_index;
+    wrapper->stamp_count = 0;
+    portEXIT_CRITICAL(&wrapper->stats_lock);
 
-    if (result->vad_state == VAD_SPEECH && !vad_active) {
-        // 检测到语音开始
-        vad_active = true;
-        event.type = AFE_EVENT_VAD_START;
-        wrapper->event_callback(&event, wrapper->event_ctx);
-    } else if (result->vad_state == VAD_SILENCE && vad_active) {
-        // 检测到语音结束
-        vad_active = false;
-        event.type = AFE_EVENT_VAD_END;
-        wrapper->event_callback(&event, wrapper->event_ctx);
+    if (wrapper->vad_active) {
+        wrapper->vad_active = false;
+        afe_emit_vad_event(wrapper, AFE_EVENT_VAD_END);
     }
-
-    // 处理录音数据回调
-    if (wrapper->recording_ptr && *wrapper->recording_ptr && 
-        result->data && result->data_size > 0 && wrapper->record_callback) {
-        size_t samples = result->data_size / sizeof(int16_t);
-        wrapper->record_callback((const int16_t *)result->data, samples, wrapper->record_ctx);
+    if (wrapper->soft_vad && wrapper->bypass) {
+        wrapper->gate_open = true;  // 直通模式下门始终打开
+        wrapper->gate_backlog = 0;
     }
+    wrapper->gate_idle = 0;
 }
 
 /**
  * @brief 创建 AFE 包装器
  * 
- * 初始化 AFE Manager，加载唤醒词模型，配置各种音频处理功能
+ * 初始化 AFE Manager，加载唤醒词模型，配置各种音频处理功能。
+ * 前端功能（AEC/NS/AGC/唤醒词/AFE VAD）全部关闭时进入直通模式，只创建一个采集任务。
  * 
  * @param config AFE 包装器配置
  * @return afe_wrapper_handle_t AFE 包装器句柄，失败返回 NULL
@@ -187,12 +1312,83 @@ afe_wrapper_handle_t afe_wrapper_create(const afe_wrapper_config_t *config)
     wrapper->bsp_handle = config->bsp_handle;
     wrapper->reference_rb = config->reference_rb;
     wrapper->wakeup_config = config->wakeup_config;
+    wrapper->vad_config = config->vad_config;
+    wrapper->feature_config = config->feature_config;
     wrapper->event_callback = config->event_callback;
     wrapper->event_ctx = config->event_ctx;
     wrapper->record_callback = config->record_callback;
     wrapper->record_ctx = config->record_ctx;
     wrapper->running_ptr = config->running_ptr;
     wrapper->recording_ptr = config->recording_ptr;
+    wrapper->sample_rate = config->sample_rate ? config->sample_rate : 16000;
+    portMUX_INITIALIZE(&wrapper->timing_lock);
+    portMUX_INITIALIZE(&wrapper->stats_lock);
+    wrapper->stats_start_us = esp_timer_get_time();
+
+    // feed/fetch 任务调度（优先级为 0 时该任务使用默认优先级和核心）
+    wrapper->task_config = config->task_config;
+    if (wrapper->task_config.feed_priority <= 0) {
+        wrapper->task_config.feed_priority = AFE_TASK_DEFAULT_PRIO;
+        wrapper->task_config.feed_core = AFE_FEED_DEFAULT_CORE;
+    }
+    if (wrapper->task_config.fetch_priority <= 0) {
+        wrapper->task_config.fetch_priority = AFE_TASK_DEFAULT_PRIO;
+        wrapper->task_config.fetch_core = AFE_FETCH_DEFAULT_CORE;
+    }
+
+    // 录音预录缓冲区
+    if (config->vad_config.preroll_ms > 0) {
+        wrapper->preroll_cap = (size_t)wrapper->sample_rate * config->vad_config.preroll_ms / 1000;
+        wrapper->preroll_buf = (int16_t *)malloc(wrapper->preroll_cap * sizeof(int16_t));
+        if (!wrapper->preroll_buf) {
+            ESP_LOGE(TAG, "预录缓冲区分配失败");
+            afe_wrapper_destroy(wrapper);
+            return NULL;
+        }
+    }
+
+    wrapper->bypass = afe_is_bypass(wrapper);
+
+    // 低功耗监听：软件 VAD（关门期间的历史在 afe_pipeline_prepare 中分配）
+    // 直通模式下软件 VAD 只负责产生事件，门始终打开
+    if (config->vad_config.enabled && config->vad_config.listen_only) {
+        portMUX_INITIALIZE(&wrapper->vad_lock);
+        soft_vad_config_t vad_cfg = {
+            .sample_rate = wrapper->sample_rate,
+            .start_ms = config->vad_config.min_speech_ms,
+            .hangover_ms = config->vad_config.min_silence_ms,
+            .threshold_db = 18.0f - 3.0f * config->vad_config.vad_mode,  // 模式越大越灵敏，与 AFE VAD 一致
+        };
+        wrapper->soft_vad = soft_vad_create(&vad_cfg);
+        if (!wrapper->soft_vad) {
+            ESP_LOGE(TAG, "软件 VAD 创建失败");
+            afe_wrapper_destroy(wrapper);
+            return NULL;
+        }
+        wrapper->gate_open = wrapper->bypass;
+    }
+
+    // 回采延迟对齐（只对 AEC 有意义）
+    wrapper->delay.delay_samples = config->ref_delay;
+    wrapper->delay.valid = config->ref_delay >= 0;
+    wrapper->delay_auto = config->ref_delay < 0;
+    if (config->feature_config.aec_enabled) {
+        delay_est_config_t est_cfg = {
+            .sample_rate = wrapper->sample_rate,
+            .max_lag = AFE_REF_DELAY_MAX_LAG,
+        };
+        wrapper->delay_est = delay_est_create(&est_cfg);
+        if (!wrapper->delay_est) {
+            ESP_LOGE(TAG, "延迟估计器创建失败");
+            afe_wrapper_destroy(wrapper);
+            return NULL;
+        }
+    }
+
+    if (afe_pipeline_prepare(wrapper) != ESP_OK) {
+        afe_wrapper_destroy(wrapper);
+        return NULL;
+    }
 
     // 加载唤醒词模型
     if (config->wakeup_config.enabled) {
@@ -200,73 +1396,17 @@ afe_wrapper_handle_t afe_wrapper_create(const afe_wrapper_config_t *config)
         wrapper->models = esp_srmodel_init(config->wakeup_config.model_partition);
         if (!wrapper->models) {
             ESP_LOGE(TAG, "模型加载失败");
-            free(wrapper);
+            afe_wrapper_destroy(wrapper);
             return NULL;
         }
         ESP_LOGI(TAG, "✅ 加载了 %d 个模型", wrapper->models->num);
     }
 
-    // 配置 AFE
-    ESP_LOGI(TAG, "配置 AFE Manager...");
-    afe_config_t *afe_config = afe_config_init("MR", wrapper->models, AFE_TYPE_SR, 
-                                                config->feature_config.afe_mode);
-    if (!afe_config) {
-        ESP_LOGE(TAG, "AFE 配置失败");
-        if (wrapper->models) esp_srmodel_deinit(wrapper->models);
-        free(wrapper);
-        return NULL;
-    }
-
-    // 配置音频处理功能
-    afe_config->aec_init = config->feature_config.aec_enabled;      // 回声消除
-    afe_config->se_init = false;                                    // 语音增强（未启用）
-    afe_config->vad_init = config->vad_config.enabled;              // 语音活动检测
-    afe_config->vad_mode = config->vad_config.vad_mode;             // VAD 模式
-    afe_config->vad_min_speech_ms = config->vad_config.min_speech_ms;   // 最小语音时长
-    afe_config->vad_min_noise_ms = config->vad_config.min_silence_ms;   // 最小静音时长
-    afe_config->wakenet_init = config->wakeup_config.enabled;      // 唤醒词检测
-    afe_config->wakenet_mode = config->wakeup_config.sensitivity;   // 唤醒词灵敏度
-    afe_config->afe_perferred_core = 0;                             // 优先运行在核心 0
-    afe_config->afe_perferred_priority = 8;                         // 任务优先级
-    afe_config->memory_alloc_mode = AFE_MEMORY_ALLOC_MORE_PSRAM;    // 优先使用 PSRAM
-    afe_config->agc_init = config->feature_config.agc_enabled;     // 自动增益控制
-    afe_config->ns_init = config->feature_config.ns_enabled;       // 噪声抑制
-    afe_config->afe_ringbuf_size = 120;                             // 环形缓冲区大小（加大以提供更多缓冲空间）
-
-    // 验证配置并创建 AFE 句柄
-    afe_config = afe_config_check(afe_config);
-    wrapper->afe_handle = esp_afe_handle_from_config(afe_config);
-
-    // 创建 AFE Manager
-    esp_gmf_afe_manager_cfg_t mgr_cfg = {
-        .afe_cfg = afe_config,
-        .read_cb = afe_read_callback,              // 数据读取回调
-        .read_ctx = wrapper,                       // 读取回调上下文
-        .feed_task_setting = {
-            .stack_size = 10 * 1024,               // Feed 任务栈大小（缩减以降低内部RAM占用）
-            .prio = 8,                             // Feed 任务优先级
-            .core = 1,                             // Feed 任务运行核心（保持在 CPU1）
-        },
-        .fetch_task_setting = {
-            .stack_size = 10 * 1024,                // Fetch 任务栈大小（缩减占用）
-            .prio = 8,                             // Fetch 任务优先级（与Feed相同，时间片轮转）
-            .core = 0,                             // Fetch 任务运行在 CPU0，与 Feed 分核
-        },
-    };
-
-    esp_err_t ret = esp_gmf_afe_manager_create(&mgr_cfg, &wrapper->afe_manager);
-    afe_config_free(afe_config);
-
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "AFE Manager 创建失败");
-        if (wrapper->models) esp_srmodel_deinit(wrapper->models);
-        free(wrapper);
+    if (afe_pipeline_start(wrapper) != ESP_OK) {
+        afe_wrapper_destroy(wrapper);
         return NULL;
     }
 
-    // 设置结果回调
-    esp_gmf_afe_manager_set_result_cb(wrapper->afe_manager, afe_result_callback, wrapper);
-
     ESP_LOGI(TAG, "✅ AFE 包装器创建成功");
     return wrapper;
 }
@@ -282,9 +1422,9 @@ void afe_wrapper_destroy(afe_wrapper_handle_t wrapper)
 {
     if (!wrapper) return;
 
-    // 销毁 AFE Manager
-    if (wrapper->afe_manager) {
-        esp_gmf_afe_manager_destroy(wrapper->afe_manager);
+    afe_pipeline_stop(wrapper);
+    if (wrapper->capture_done) {
+        vSemaphoreDelete(wrapper->capture_done);
     }
 
     // 释放模型资源
@@ -292,17 +1432,44 @@ void afe_wrapper_destroy(afe_wrapper_handle_t wrapper)
         esp_srmodel_deinit(wrapper->models);
     }
 
-    // 释放包装器内存
+    drift_comp_destroy(wrapper->drift);
+    delay_est_destroy(wrapper->delay_est);
+    soft_vad_destroy(wrapper->soft_vad);
+
+    // 释放包装器内存（AFE Manager 已销毁，feed 任务不再访问缓冲区）
+    free(wrapper->mic_buffer);
+    free(wrapper->preroll_buf);
+    free(wrapper->gate_hist);
     free(wrapper);
     ESP_LOGI(TAG, "AFE 包装器已销毁");
 }
 
+/**
+ * @brief 比较两个可能为 NULL 的字符串
+ * 
+ * @return true 相同
+ */
+static bool afe_str_equal(const char *a, const char *b)
+{
+    if (!a || !b) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
 /**
  * @brief 更新唤醒词配置
  * 
+ * 开关唤醒词、切换模型分区/模型或修改灵敏度时重建采集流水线：
+ * 1. 先加载新模型（耗时最长，此时旧流水线照常工作）；
+ * 2. 停止旧流水线并按新配置启动（采集在这段时间中断，I2S DMA 缓冲区之外的数据丢失）；
+ * 3. 新流水线启动成功后才释放旧模型，失败时恢复旧配置。
+ * 需要在同一任务中调用，不能与 afe_wrapper_destroy 并发。
+ * 
  * @param wrapper AFE 包装器句柄
  * @param config 新的唤醒词配置
- * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效，ESP_ERR_NOT_FOUND 模型加载失败，
+ *                   其他值为新流水线启动失败（已恢复旧配置）
  */
 esp_err_t afe_wrapper_update_wakeup_config(afe_wrapper_handle_t wrapper, 
                                             const afe_wakeup_config_t *config)
@@ -311,9 +1478,83 @@ esp_err_t afe_wrapper_update_wakeup_config(afe_wrapper_handle_t wrapper,
         return ESP_ERR_INVALID_ARG;
     }
 
-    memcpy(&wrapper->wakeup_config, config, sizeof(afe_wakeup_config_t));
-    ESP_LOGI(TAG, "唤醒词配置已更新: %s", config->wake_word_name);
+    const afe_wakeup_config_t old_config = wrapper->wakeup_config;
+    bool rebuild = config->enabled != old_config.enabled;
+    if (config->enabled && !rebuild) {
+        rebuild = config->sensitivity != old_config.sensitivity ||
+                  !afe_str_equal(config->model_partition, old_config.model_partition) ||
+                  !afe_str_equal(config->wake_word_name, old_config.wake_word_name);
+    }
+    if (!rebuild) {
+        wrapper->wakeup_config = *config;
+        ESP_LOGI(TAG, "唤醒词配置已更新: %s", config->wake_word_name);
+        return ESP_OK;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+
+    // 按需加载模型（同一分区的模型继续使用）
+    srmodel_list_t *old_models = wrapper->models;
+    srmodel_list_t *models = NULL;
+    if (config->enabled) {
+        if (old_models && afe_str_equal(config->model_partition, old_config.model_partition)) {
+            models = old_models;
+        } else {
+            ESP_LOGI(TAG, "加载唤醒词模型: %s", config->wake_word_name);
+            models = esp_srmodel_init(config->model_partition);
+            if (!models) {
+                ESP_LOGE(TAG, "模型加载失败，保持原配置");
+                return ESP_ERR_NOT_FOUND;
+            }
+        }
+    }
+
+    const bool old_bypass = wrapper->bypass;
+    wrapper->wakeup_config = *config;
+    wrapper->models = models;
+    wrapper->bypass = afe_is_bypass(wrapper);
+
+    esp_err_t ret = afe_pipeline_prepare(wrapper);
+    int64_t gap_start_us = esp_timer_get_time();
+    if (ret == ESP_OK) {
+        afe_pipeline_stop(wrapper);
+        afe_pipeline_resync(wrapper);
+        ret = afe_pipeline_start(wrapper);
+    }
+
+    if (ret != ESP_OK) {
+        // 恢复旧配置（旧模型尚未释放）
+        ESP_LOGE(TAG, "唤醒词重新配置失败，恢复原配置");
+        wrapper->wakeup_config = old_config;
+        wrapper->models = old_models;
+        wrapper->bypass = old_bypass;
+        if (!wrapper->afe_manager && !wrapper->capture_task) {
+            afe_pipeline_resync(wrapper);
+            if (afe_pipeline_start(wrapper) != ESP_OK) {
+                ESP_LOGE(TAG, "原配置恢复失败，音频采集已停止");
+            }
+        }
+        if (models && models != old_models) {
+            esp_srmodel_deinit(models);
+        }
+        return ret;
+    }
+
+    int64_t end_us = esp_timer_get_time();
+    if (old_models && old_models != models) {
+        esp_srmodel_deinit(old_models);
+    }
+
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    wrapper->reconfig.count++;
+    wrapper->reconfig.total_us = (uint32_t)(end_us - start_us);
+    wrapper->reconfig.gap_us = (uint32_t)(end_us - gap_start_us);
+    portEXIT_CRITICAL(&wrapper->stats_lock);
 
+    ESP_LOGI(TAG, "⏱️ 唤醒词配置已切换: %s（%s），耗时 %d ms，采集中断 %d ms",
+             config->enabled ? config->wake_word_name : "关闭",
+             wrapper->bypass ? "直通模式" : "AFE",
+             (int)((end_us - start_us) / 1000), (int)((end_us - gap_start_us) / 1000));
     return ESP_OK;
 }
 
@@ -335,3 +1576,242 @@ esp_err_t afe_wrapper_get_wakeup_config(afe_wrapper_handle_t wrapper,
     return ESP_OK;
 }
 
+/**
+ * @brief 获取最近一次唤醒词重新配置的耗时
+ * 
+ * @param wrapper AFE 包装器句柄
+ * @param info 用于返回耗时的缓冲区
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t afe_wrapper_get_reconfig_info(afe_wrapper_handle_t wrapper, afe_reconfig_info_t *info)
+{
+    if (!wrapper || !info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    *info = wrapper->reconfig;
+    portEXIT_CRITICAL(&wrapper->stats_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取麦克风与回采流的时间信息
+ * 
+ * skew_us 为正表示麦克风采集时刻晚于配对回采数据送入扬声器的时刻，
+ * 即 AEC 需要覆盖的回声路径延迟（不含 I2S DMA 队列延迟）。
+ * 
+ * @param wrapper AFE 包装器句柄
+ * @param timing 用于返回时间信息的缓冲区
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t afe_wrapper_get_stream_timing(afe_wrapper_handle_t wrapper, afe_stream_timing_t *timing)
+{
+    if (!wrapper || !timing) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    *timing = wrapper->timing;
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 开始一次回采延迟估计
+ * 
+ * 由 feed 任务在下一块开始执行；估计在有效回采累计约 2 秒后完成，
+ * 成功后立即按新延迟重新对齐，结果可通过 afe_wrapper_get_ref_delay 读取并持久化。
+ * 
+ * @param wrapper AFE 包装器句柄
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效，ESP_ERR_NOT_SUPPORTED 未启用 AEC
+ */
+esp_err_t afe_wrapper_start_delay_estimation(afe_wrapper_handle_t wrapper)
+{
+    if (!wrapper) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!wrapper->delay_est) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    wrapper->delay_start_req = true;
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 设置回采对齐延迟
+ * 
+ * @param wrapper AFE 包装器句柄
+ * @param delay_samples 延迟（采样点数），<0 表示清除（之后不再对齐）
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t afe_wrapper_set_ref_delay(afe_wrapper_handle_t wrapper, int32_t delay_samples)
+{
+    if (!wrapper) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    wrapper->delay_set_req = true;
+    wrapper->delay_set_value = delay_samples;
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取回采对齐延迟状态
+ * 
+ * @param wrapper AFE 包装器句柄
+ * @param delay 用于返回状态的缓冲区
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t afe_wrapper_get_ref_delay(afe_wrapper_handle_t wrapper, afe_ref_delay_t *delay)
+{
+    if (!wrapper || !delay) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL(&wrapper->timing_lock);
+    *delay = wrapper->delay;
+    portEXIT_CRITICAL(&wrapper->timing_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取 AFE 流水线统计
+ * 
+ * 任务运行时间需要开启 CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS（计数单位按微秒换算），
+ * 计数为 32 位，统计时长应小于约 71 分钟（定期清零）。
+ * 
+ * @param wrapper AFE 包装器句柄
+ * @param stats 用于返回统计的缓冲区
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t afe_wrapper_get_pipeline_stats(afe_wrapper_handle_t wrapper, afe_pipeline_stats_t *stats)
+{
+    if (!wrapper || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    // 任务句柄在锁内读取运行时间：重建流水线时先删除任务、再在锁内清空句柄
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    *stats = wrapper->stats;
+    stats->window_us = (uint64_t)(now - wrapper->stats_start_us);
+    stats->ringbuf_depth_avg = wrapper->depth_samples ?
+                               (float)wrapper->depth_sum / wrapper->depth_samples : 0.0f;
+    if (wrapper->feed_task) {
+        stats->feed.run_time_us = (uint32_t)(afe_task_run_time(wrapper->feed_task) - wrapper->feed_run_base);
+    }
+    if (wrapper->fetch_task) {
+        stats->fetch.run_time_us = (uint32_t)(afe_task_run_time(wrapper->fetch_task) - wrapper->fetch_run_base);
+    }
+    portEXIT_CRITICAL(&wrapper->stats_lock);
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    stats->feed.cpu_percent = stats->window_us ? stats->feed.run_time_us * 100.0f / stats->window_us : 0.0f;
+    stats->fetch.cpu_percent = stats->window_us ? stats->fetch.run_time_us * 100.0f / stats->window_us : 0.0f;
+#else
+    stats->feed.cpu_percent = -1.0f;
+    stats->fetch.cpu_percent = -1.0f;
+#endif
+    return ESP_OK;
+}
+
+/**
+ * @brief 清零 AFE 流水线统计（开始新的统计时段）
+ * 
+ * 已送入未取出的块时间戳保留，跨时段的块在新时段内计入
+ * 
+ * @param wrapper AFE 包装器句柄
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t afe_wrapper_reset_pipeline_stats(afe_wrapper_handle_t wrapper)
+{
+    if (!wrapper) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&wrapper->stats_lock);
+    uint32_t capacity = wrapper->stats.ringbuf_capacity;
+    memset(&wrapper->stats, 0, sizeof(wrapper->stats));
+    wrapper->stats.ringbuf_capacity = capacity;
+    wrapper->depth_sum = 0;
+    wrapper->depth_samples = 0;
+    wrapper->feed_run_base = afe_task_run_time(wrapper->feed_task);
+    wrapper->fetch_run_base = afe_task_run_time(wrapper->fetch_task);
+    wrapper->stats_start_us = now;
+    portEXIT_CRITICAL(&wrapper->stats_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief 打印一个延迟直方图的摘要
+ * 
+ * @param name 名称
+ * @param hist 直方图
+ */
+static void afe_log_latency(const char *name, const afe_latency_hist_t *hist)
+{
+    if (hist->count == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "   %s: 平均 %.1f ms, P95 <= %u ms, 最大 %.1f ms（%u 块）", name,
+             hist->sum_us / 1000.0 / hist->count,
+             (unsigned)afe_latency_hist_percentile_ms(hist, 95.0f),
+             hist->max_us / 1000.0, (unsigned)hist->count);
+}
+
+/**
+ * @brief 打印一个任务的负载摘要
+ * 
+ * @param name 名称
+ * @param load 任务负载
+ * @param window_us 统计时长
+ */
+static void afe_log_load(const char *name, const afe_task_load_t *load, uint64_t window_us)
+{
+    if (load->calls == 0 || window_us == 0) {
+        return;
+    }
+    float callback_percent = load->callback_us * 100.0f / window_us;
+    if (load->cpu_percent >= 0) {
+        ESP_LOGI(TAG, "   %s: CPU %.1f%%（回调 %.1f%%，单次最长 %u us）", name,
+                 load->cpu_percent, callback_percent, (unsigned)load->callback_max_us);
+    } else {
+        ESP_LOGI(TAG, "   %s: 回调 %.1f%%，单次最长 %u us", name,
+                 callback_percent, (unsigned)load->callback_max_us);
+    }
+}
+
+/**
+ * @brief 打印 AFE 流水线统计摘要
+ * 
+ * @param wrapper AFE 包装器句柄
+ */
+void afe_wrapper_log_pipeline_stats(afe_wrapper_handle_t wrapper)
+{
+    afe_pipeline_stats_t stats;
+    if (afe_wrapper_get_pipeline_stats(wrapper, &stats) != ESP_OK) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "📊 AFE 流水线统计（%d 秒%s）", (int)(stats.window_us / 1000000),
+             wrapper->bypass ? "，直通模式" : "");
+    afe_log_latency("送入→取出", &stats.feed_to_fetch);
+    afe_log_latency("采集→取出", &stats.capture_to_fetch);
+    if (!wrapper->bypass && stats.ringbuf_capacity > 0) {
+        ESP_LOGI(TAG, "   环形缓冲区: 最大 %u/%u 帧, 平均 %.1f 帧",
+                 (unsigned)stats.ringbuf_depth_max, (unsigned)stats.ringbuf_capacity,
+                 stats.ringbuf_depth_avg);
+        if (stats.ringbuf_depth_max * 4 >= stats.ringbuf_capacity * 3) {
+            ESP_LOGW(TAG, "⚠️ AFE 环形缓冲区接近写满，fetch 任务处理不及时");
+        }
+    }
+    afe_log_load(wrapper->bypass ? "采集任务" : "feed 任务", &stats.feed, stats.window_us);
+    afe_log_load("fetch 任务", &stats.fetch, stats.window_us);
+}
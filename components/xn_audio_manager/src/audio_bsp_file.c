@@ -0,0 +1,302 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27
+ * @FilePath: \xn_esp32_audio\components\xn_audio_manager\src\audio_bsp_file.c
+ * @Description: 文件虚拟 BSP 实现（麦克风读文件，扬声器写文件/内存）
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+
+#include "audio_bsp_priv.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "audio_bsp_file";
+
+#define BSP_FILE_CHUNK_FRAMES  256   ///< 多声道 WAV 取首声道时每次读取的帧数
+
+typedef struct {
+    // 麦克风输入
+    FILE *mic_file;                  ///< 输入文件（NULL 表示输出静音）
+    long mic_data_offset;            ///< PCM 数据在文件中的起始偏移
+    size_t mic_data_frames;          ///< PCM 数据总帧数
+    size_t mic_pos;                  ///< 当前读取帧位置
+    uint16_t mic_channels;           ///< 声道数（多声道时只取第一个声道）
+    bool mic_loop;                   ///< 末尾循环
+    int64_t mic_start_us;            ///< 实时节奏起点
+    uint64_t mic_delivered;          ///< 已交付的采样点数
+
+    // 扬声器输出
+    FILE *speaker_file;              ///< 输出文件（可选）
+    int16_t *sink;                   ///< 内存接收区（可选）
+    size_t sink_capacity;            ///< 内存接收区容量
+    size_t speaker_total;            ///< 累计输出采样点数
+    int64_t speaker_start_us;        ///< 实时节奏起点
+
+    uint32_t sample_rate;            ///< 采样率
+    audio_bsp_file_pacing_t pacing;  ///< 读写节奏
+} bsp_file_t;
+
+static inline uint16_t bsp_rd16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t bsp_rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief 解析输入文件：RIFF/WAVE 取 fmt 和 data 块，否则按原始 16bit 单声道 PCM 处理
+ */
+static esp_err_t bsp_file_open_mic(bsp_file_t *bsp, const char *path)
+{
+    bsp->mic_file = fopen(path, "rb");
+    if (!bsp->mic_file) {
+        ESP_LOGE(TAG, "麦克风输入文件打开失败: %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t hdr[12];
+    bool is_wav = fread(hdr, 1, sizeof(hdr), bsp->mic_file) == sizeof(hdr) &&
+                  memcmp(hdr, "RIFF", 4) == 0 && memcmp(hdr + 8, "WAVE", 4) == 0;
+
+    if (!is_wav) {
+        fseek(bsp->mic_file, 0, SEEK_END);
+        bsp->mic_data_offset = 0;
+        bsp->mic_data_frames = (size_t)ftell(bsp->mic_file) / sizeof(int16_t);
+        bsp->mic_channels = 1;
+        ESP_LOGI(TAG, "麦克风输入: 原始 PCM %s, %d 个采样点", path, (int)bsp->mic_data_frames);
+        return ESP_OK;
+    }
+
+    bool have_fmt = false;
+    uint8_t chunk[8];
+    while (fread(chunk, 1, sizeof(chunk), bsp->mic_file) == sizeof(chunk)) {
+        uint32_t size = bsp_rd32(chunk + 4);
+        long next = ftell(bsp->mic_file) + (long)size + (size & 1);  // 块按偶数字节对齐
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t fmt[16];
+            if (fread(fmt, 1, sizeof(fmt), bsp->mic_file) != sizeof(fmt)) {
+                break;
+            }
+            uint16_t format = bsp_rd16(fmt);
+            bsp->mic_channels = bsp_rd16(fmt + 2);
+            bsp->sample_rate = bsp_rd32(fmt + 4);
+            uint16_t bits = bsp_rd16(fmt + 14);
+            if ((format != 1 && format != 0xFFFE) || bits != 16 || bsp->mic_channels == 0) {
+                ESP_LOGE(TAG, "不支持的 WAV 格式: fmt=%d, %d bit, %d 声道",
+                         format, bits, bsp->mic_channels);
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            have_fmt = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) {
+                break;
+            }
+            bsp->mic_data_offset = ftell(bsp->mic_file);
+            bsp->mic_data_frames = size / (sizeof(int16_t) * bsp->mic_channels);
+            ESP_LOGI(TAG, "麦克风输入: WAV %s, %d Hz, %d 声道, %d 帧", path,
+                     (int)bsp->sample_rate, bsp->mic_channels, (int)bsp->mic_data_frames);
+            return ESP_OK;
+        }
+        fseek(bsp->mic_file, next, SEEK_SET);
+    }
+
+    ESP_LOGE(TAG, "无效的 WAV 文件: %s", path);
+    return ESP_ERR_INVALID_RESPONSE;
+}
+
+/**
+ * @brief 实时节奏：把累计交付量换算成目标时刻，提前则休眠（按 tick 粒度，误差不累积）
+ */
+static void bsp_file_pace(const bsp_file_t *bsp, int64_t *start_us, uint64_t total_samples)
+{
+    if (bsp->pacing != AUDIO_BSP_FILE_PACING_REALTIME) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (*start_us == 0) {
+        *start_us = now;
+    }
+    int64_t target = *start_us + (int64_t)(total_samples * 1000000ULL / bsp->sample_rate);
+    TickType_t ticks = pdMS_TO_TICKS((target - now) / 1000);
+    if (target > now && ticks > 0) {
+        vTaskDelay(ticks);
+    }
+}
+
+/**
+ * @brief 从当前位置读取至多 n 帧的首声道数据
+ */
+static size_t bsp_file_read_frames(bsp_file_t *bsp, int16_t *out, size_t n)
+{
+    if (bsp->mic_channels == 1) {
+        return fread(out, sizeof(int16_t), n, bsp->mic_file);
+    }
+
+    int16_t chunk[BSP_FILE_CHUNK_FRAMES * 2];
+    size_t max_frames = sizeof(chunk) / sizeof(int16_t) / bsp->mic_channels;
+    size_t got = 0;
+    while (got < n && max_frames > 0) {
+        size_t want = n - got < max_frames ? n - got : max_frames;
+        size_t frames = fread(chunk, sizeof(int16_t) * bsp->mic_channels, want, bsp->mic_file);
+        for (size_t i = 0; i < frames; i++) {
+            out[got + i] = chunk[i * bsp->mic_channels];
+        }
+        got += frames;
+        if (frames < want) {
+            break;
+        }
+    }
+    return got;
+}
+
+static esp_err_t bsp_file_read_mic(void *impl, int16_t *out_samples,
+                                   size_t sample_count, size_t *out_got)
+{
+    bsp_file_t *bsp = (bsp_file_t *)impl;
+    if (!out_samples) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t got = 0;
+    while (bsp->mic_file && got < sample_count) {
+        if (bsp->mic_pos >= bsp->mic_data_frames) {
+            if (!bsp->mic_loop || bsp->mic_data_frames == 0) {
+                break;
+            }
+            fseek(bsp->mic_file, bsp->mic_data_offset, SEEK_SET);
+            bsp->mic_pos = 0;
+        }
+
+        size_t want = sample_count - got;
+        if (want > bsp->mic_data_frames - bsp->mic_pos) {
+            want = bsp->mic_data_frames - bsp->mic_pos;
+        }
+        size_t n = bsp_file_read_frames(bsp, out_samples + got, want);
+        bsp->mic_pos += n;
+        got += n;
+        if (n < want) {
+            bsp->mic_data_frames = bsp->mic_pos;  // 文件比头部声明的短，以实际长度为准
+        }
+    }
+
+    // 文件结束（或未配置输入）后输出静音，保持与 I2S 相同的“总能读满”语义
+    memset(out_samples + got, 0, (sample_count - got) * sizeof(int16_t));
+
+    bsp->mic_delivered += sample_count;
+    bsp_file_pace(bsp, &bsp->mic_start_us, bsp->mic_delivered);
+
+    if (out_got) *out_got = sample_count;
+    return ESP_OK;
+}
+
+static esp_err_t bsp_file_write_speaker(void *impl, const int16_t *samples,
+                                        size_t sample_count, uint8_t volume)
+{
+    bsp_file_t *bsp = (bsp_file_t *)impl;
+    (void)volume;  // 记录音量前的原始数据，便于主机端逐样本比对
+    if (!samples) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (bsp->speaker_file &&
+        fwrite(samples, sizeof(int16_t), sample_count, bsp->speaker_file) != sample_count) {
+        ESP_LOGE(TAG, "扬声器输出文件写入失败");
+        return ESP_FAIL;
+    }
+
+    if (bsp->sink && bsp->speaker_total < bsp->sink_capacity) {
+        size_t n = bsp->sink_capacity - bsp->speaker_total;
+        if (n > sample_count) {
+            n = sample_count;
+        }
+        memcpy(bsp->sink + bsp->speaker_total, samples, n * sizeof(int16_t));
+    }
+
+    bsp->speaker_total += sample_count;
+    bsp_file_pace(bsp, &bsp->speaker_start_us, bsp->speaker_total);
+    return ESP_OK;
+}
+
+static void bsp_file_destroy(void *impl)
+{
+    bsp_file_t *bsp = (bsp_file_t *)impl;
+
+    if (bsp->mic_file) {
+        fclose(bsp->mic_file);
+    }
+    if (bsp->speaker_file) {
+        fclose(bsp->speaker_file);
+    }
+    free(bsp);
+}
+
+static const audio_bsp_ops_t s_file_ops = {
+    .name = "file",
+    .destroy = bsp_file_destroy,
+    .read_mic = bsp_file_read_mic,
+    .write_speaker = bsp_file_write_speaker,
+};
+
+audio_bsp_handle_t audio_bsp_create_file(const audio_bsp_file_config_t *config)
+{
+    if (!config) {
+        return NULL;
+    }
+
+    bsp_file_t *bsp = (bsp_file_t *)calloc(1, sizeof(bsp_file_t));
+    if (!bsp) {
+        ESP_LOGE(TAG, "文件 BSP 分配失败");
+        return NULL;
+    }
+
+    bsp->sample_rate = config->sample_rate ? config->sample_rate : 16000;
+    bsp->pacing = config->pacing;
+    bsp->mic_loop = config->mic_loop;
+    bsp->sink = config->speaker_sink;
+    bsp->sink_capacity = config->speaker_sink ? config->speaker_sink_samples : 0;
+
+    if (config->mic_path && bsp_file_open_mic(bsp, config->mic_path) != ESP_OK) {
+        bsp_file_destroy(bsp);
+        return NULL;
+    }
+
+    if (config->speaker_path) {
+        bsp->speaker_file = fopen(config->speaker_path, "wb");
+        if (!bsp->speaker_file) {
+            ESP_LOGE(TAG, "扬声器输出文件打开失败: %s", config->speaker_path);
+            bsp_file_destroy(bsp);
+            return NULL;
+        }
+    }
+
+    audio_bsp_handle_t handle = audio_bsp_alloc(&s_file_ops, bsp);
+    if (!handle) {
+        bsp_file_destroy(bsp);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "文件 BSP 创建成功: %d Hz, %s", (int)bsp->sample_rate,
+             bsp->pacing == AUDIO_BSP_FILE_PACING_REALTIME ? "实时节奏" : "快速");
+    return handle;
+}
+
+size_t audio_bsp_file_get_speaker_samples(audio_bsp_handle_t handle)
+{
+    if (!handle || handle->ops != &s_file_ops || !handle->impl) {
+        return 0;
+    }
+    return ((bsp_file_t *)handle->impl)->speaker_total;
+}
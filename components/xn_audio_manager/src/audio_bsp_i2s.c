@@ -0,0 +1,130 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27
+ * @FilePath: \xn_esp32_audio\components\xn_audio_manager\src\audio_bsp_i2s.c
+ * @Description: 默认 I2S BSP 实现
+ */
+
+#include "audio_bsp_priv.h"
+#include "i2s_hal.h"
+#include "esp_log.h"
+#include <stdlib.h>
+
+static const char *TAG = "audio_bsp";
+
+static void bsp_i2s_destroy(void *impl)
+{
+    i2s_hal_destroy((i2s_hal_handle_t)impl);
+}
+
+static esp_err_t bsp_i2s_read_mic(void *impl, int16_t *out_samples,
+                                  size_t sample_count, size_t *out_got)
+{
+    return i2s_hal_read_mic((i2s_hal_handle_t)impl, out_samples, sample_count, out_got);
+}
+
+static esp_err_t bsp_i2s_write_speaker(void *impl, const int16_t *samples,
+                                       size_t sample_count, uint8_t volume)
+{
+    return i2s_hal_write_speaker((i2s_hal_handle_t)impl, samples, sample_count, volume);
+}
+
+static esp_err_t bsp_i2s_flush_speaker(void *impl)
+{
+    return i2s_hal_flush_speaker((i2s_hal_handle_t)impl);
+}
+
+static size_t bsp_i2s_get_speaker_pending(void *impl)
+{
+    return i2s_hal_get_speaker_pending((i2s_hal_handle_t)impl);
+}
+
+static esp_err_t bsp_i2s_get_mic_level(void *impl, audio_bsp_mic_level_t *level)
+{
+    i2s_mic_level_t hal_level;
+    esp_err_t ret = i2s_hal_get_mic_level((i2s_hal_handle_t)impl, &hal_level);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    level->bit_shift = hal_level.bit_shift;
+    level->peak = hal_level.peak;
+    level->rms = hal_level.rms;
+    level->clipped = hal_level.clipped;
+    level->shift_changes = hal_level.shift_changes;
+    return ESP_OK;
+}
+
+static esp_err_t bsp_i2s_set_mic_frame_samples(void *impl, size_t samples)
+{
+    return i2s_hal_set_mic_frame_samples((i2s_hal_handle_t)impl, samples);
+}
+
+static i2s_chan_handle_t bsp_i2s_get_rx(void *impl)
+{
+    return i2s_hal_get_rx_handle((i2s_hal_handle_t)impl);
+}
+
+static i2s_chan_handle_t bsp_i2s_get_tx(void *impl)
+{
+    return i2s_hal_get_tx_handle((i2s_hal_handle_t)impl);
+}
+
+static const audio_bsp_ops_t s_i2s_ops = {
+    .name = "I2S",
+    .destroy = bsp_i2s_destroy,
+    .read_mic = bsp_i2s_read_mic,
+    .write_speaker = bsp_i2s_write_speaker,
+    .get_speaker_pending = bsp_i2s_get_speaker_pending,
+    .flush_speaker = bsp_i2s_flush_speaker,
+    .get_mic_level = bsp_i2s_get_mic_level,
+    .set_mic_frame_samples = bsp_i2s_set_mic_frame_samples,
+    .get_rx = bsp_i2s_get_rx,
+    .get_tx = bsp_i2s_get_tx,
+};
+
+audio_bsp_handle_t audio_bsp_create(const audio_bsp_hw_config_t *config)
+{
+    if (!config) {
+        return NULL;
+    }
+
+    i2s_mic_config_t mic_cfg = {
+        .port = config->mic.port,
+        .bclk_gpio = config->mic.bclk_gpio,
+        .lrck_gpio = config->mic.lrck_gpio,
+        .din_gpio = config->mic.din_gpio,
+        .sample_rate = config->mic.sample_rate,
+        .bits = config->mic.bits,
+        .max_frame_samples = config->mic.max_frame_samples ? config->mic.max_frame_samples : 512,
+        .bit_shift = config->mic.bit_shift ? config->mic.bit_shift : 14,
+        .auto_gain = config->mic.auto_gain,
+    };
+
+    i2s_speaker_config_t speaker_cfg = {
+        .port = config->speaker.port,
+        .bclk_gpio = config->speaker.bclk_gpio,
+        .lrck_gpio = config->speaker.lrck_gpio,
+        .dout_gpio = config->speaker.dout_gpio,
+        .sample_rate = config->speaker.sample_rate,
+        .bits = config->speaker.bits,
+        .max_frame_samples = config->speaker.max_frame_samples ? config->speaker.max_frame_samples : 1024,
+    };
+
+    i2s_hal_handle_t hal = i2s_hal_create(&mic_cfg, &speaker_cfg);
+    if (!hal) {
+        ESP_LOGE(TAG, "create I2S HAL failed");
+        return NULL;
+    }
+
+    audio_bsp_handle_t handle = audio_bsp_alloc(&s_i2s_ops, hal);
+    if (!handle) {
+        i2s_hal_destroy(hal);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "audio BSP (I2S) ready");
+    return handle;
+}
@@ -0,0 +1,57 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27
+ * @FilePath: \xn_esp32_audio\components\xn_audio_manager\src\audio_bsp_priv.h
+ * @Description: 音频 BSP 后端接口（组件内部使用）
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "audio_bsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief BSP 后端操作表
+ *
+ * 每个后端（I2S、文件……）提供一份静态操作表，audio_bsp.c 中的公共接口只做分发。
+ */
+typedef struct {
+    const char *name;                                        ///< 后端名称（日志用）
+    void (*destroy)(void *impl);                             ///< 释放后端资源
+    esp_err_t (*read_mic)(void *impl, int16_t *out_samples,
+                          size_t sample_count, size_t *out_got);
+    esp_err_t (*write_speaker)(void *impl, const int16_t *samples,
+                               size_t sample_count, uint8_t volume);
+    size_t (*get_speaker_pending)(void *impl);               ///< 可为 NULL（同步写入，返回时已输出）
+    esp_err_t (*flush_speaker)(void *impl);                  ///< 可为 NULL（没有排队的数据）
+    esp_err_t (*get_mic_level)(void *impl, audio_bsp_mic_level_t *level);  ///< 可为 NULL
+    esp_err_t (*set_mic_frame_samples)(void *impl, size_t samples);        ///< 可为 NULL（读取长度不受限）
+#if AUDIO_BSP_HAS_I2S
+    i2s_chan_handle_t (*get_rx)(void *impl);                 ///< 可为 NULL
+    i2s_chan_handle_t (*get_tx)(void *impl);                 ///< 可为 NULL
+#endif
+} audio_bsp_ops_t;
+
+/** BSP 句柄：操作表 + 后端私有数据 */
+struct audio_bsp_s {
+    const audio_bsp_ops_t *ops;
+    void *impl;
+};
+
+/**
+ * @brief 用后端操作表和私有数据创建 BSP 句柄
+ * @param ops 后端操作表
+ * @param impl 后端私有数据（失败时由调用者释放）
+ * @return BSP 句柄，失败返回 NULL
+ */
+audio_bsp_handle_t audio_bsp_alloc(const audio_bsp_ops_t *ops, void *impl);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,260 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\audio_decoder.c
+ * @Description: 播放解码器实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "audio_decoder.h"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+#if AUDIO_DECODER_HAS_OPUS
+#include "esp_opus_dec.h"
+#endif
+
+static const char *TAG = "AUDIO_DEC";
+
+#define IMA_ADPCM_HEADER_BYTES  4
+#define IMA_ADPCM_MAX_INDEX     88
+
+/** 解码器结构体 */
+struct audio_decoder_s {
+    audio_codec_t codec;        ///< 压缩格式
+    uint32_t sample_rate;       ///< 采样率
+    void *opus;                 ///< Opus 解码器（esp_audio_codec）
+};
+
+/** IMA-ADPCM 步长表 */
+static const int16_t s_ima_step_table[IMA_ADPCM_MAX_INDEX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/** IMA-ADPCM 步长索引调整表 */
+static const int8_t s_ima_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/**
+ * @brief 解码一个 IMA-ADPCM 采样点并更新预测值和步长索引
+ */
+static inline int16_t ima_decode_nibble(uint8_t nibble, int32_t *predictor, int *index)
+{
+    int32_t step = s_ima_step_table[*index];
+    int32_t diff = step >> 3;
+    if (nibble & 1) diff += step >> 2;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 4) diff += step;
+
+    int32_t pred = (nibble & 8) ? *predictor - diff : *predictor + diff;
+    if (pred > INT16_MAX) pred = INT16_MAX;
+    if (pred < INT16_MIN) pred = INT16_MIN;
+    *predictor = pred;
+
+    int idx = *index + s_ima_index_table[nibble];
+    if (idx < 0) idx = 0;
+    if (idx > IMA_ADPCM_MAX_INDEX) idx = IMA_ADPCM_MAX_INDEX;
+    *index = idx;
+    return (int16_t)pred;
+}
+
+/**
+ * @brief 解码一个 IMA-ADPCM 块（WAV 格式，单声道）
+ */
+static esp_err_t ima_adpcm_decode(const uint8_t *data, size_t len,
+                                  int16_t *out, size_t out_capacity, size_t *out_samples)
+{
+    if (len < IMA_ADPCM_HEADER_BYTES) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t samples = 1 + (len - IMA_ADPCM_HEADER_BYTES) * 2;
+    if (samples > out_capacity) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int32_t predictor = (int16_t)(data[0] | (data[1] << 8));
+    int index = data[2];
+    if (index > IMA_ADPCM_MAX_INDEX) {
+        return ESP_FAIL;
+    }
+
+    // 块头中的预测值即第一个采样点
+    *out++ = (int16_t)predictor;
+    for (size_t i = IMA_ADPCM_HEADER_BYTES; i < len; i++) {
+        *out++ = ima_decode_nibble(data[i] & 0x0F, &predictor, &index);
+        *out++ = ima_decode_nibble(data[i] >> 4, &predictor, &index);
+    }
+
+    *out_samples = samples;
+    return ESP_OK;
+}
+
+/**
+ * @brief G.711 μ-law 解码（ITU-T G.711）
+ */
+static inline int16_t g711_ulaw_decode(uint8_t u)
+{
+    u = ~u;
+    int32_t t = (((int32_t)u & 0x0F) << 3) + 0x84;
+    t <<= (u & 0x70) >> 4;
+    return (int16_t)((u & 0x80) ? (0x84 - t) : (t - 0x84));
+}
+
+/**
+ * @brief G.711 A-law 解码（ITU-T G.711）
+ */
+static inline int16_t g711_alaw_decode(uint8_t a)
+{
+    a ^= 0x55;
+    int32_t t = ((int32_t)a & 0x0F) << 4;
+    int seg = (a & 0x70) >> 4;
+    if (seg == 0) {
+        t += 8;
+    } else {
+        t += 0x108;
+        if (seg > 1) t <<= seg - 1;
+    }
+    return (int16_t)((a & 0x80) ? t : -t);
+}
+
+#if AUDIO_DECODER_HAS_OPUS
+/**
+ * @brief 解码一个 Opus 包
+ */
+static esp_err_t opus_decode(audio_decoder_handle_t dec, const uint8_t *data, size_t len,
+                             int16_t *out, size_t out_capacity, size_t *out_samples)
+{
+    esp_audio_dec_in_raw_t raw = {
+        .buffer = (uint8_t *)data,
+        .len = len,
+    };
+    esp_audio_dec_out_frame_t frame = {
+        .buffer = (uint8_t *)out,
+        .len = out_capacity * sizeof(int16_t),
+    };
+    esp_audio_dec_info_t info = {0};
+
+    esp_audio_err_t ret = esp_opus_dec_decode(dec->opus, &raw, &frame, &info);
+    if (ret == ESP_AUDIO_ERR_BUFF_NOT_ENOUGH) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (ret != ESP_AUDIO_ERR_OK) {
+        return ESP_FAIL;
+    }
+
+    *out_samples = frame.decoded_size / sizeof(int16_t);
+    return ESP_OK;
+}
+#endif
+
+audio_decoder_handle_t audio_decoder_create(audio_codec_t codec, uint32_t sample_rate)
+{
+    if (codec > AUDIO_CODEC_OPUS || (codec == AUDIO_CODEC_OPUS && !AUDIO_DECODER_HAS_OPUS)) {
+        ESP_LOGE(TAG, "不支持的格式: %s", audio_codec_name(codec));
+        return NULL;
+    }
+
+    audio_decoder_handle_t dec = (audio_decoder_handle_t)calloc(1, sizeof(struct audio_decoder_s));
+    if (!dec) {
+        ESP_LOGE(TAG, "解码器分配失败");
+        return NULL;
+    }
+    dec->codec = codec;
+    dec->sample_rate = sample_rate ? sample_rate : 16000;
+
+#if AUDIO_DECODER_HAS_OPUS
+    if (codec == AUDIO_CODEC_OPUS) {
+        esp_opus_dec_cfg_t cfg = ESP_OPUS_DEC_CONFIG_DEFAULT();
+        cfg.sample_rate = dec->sample_rate;
+        cfg.channel = 1;
+        if (esp_opus_dec_open(&cfg, sizeof(cfg), &dec->opus) != ESP_AUDIO_ERR_OK) {
+            ESP_LOGE(TAG, "Opus 解码器创建失败（%u Hz）", (unsigned)dec->sample_rate);
+            free(dec);
+            return NULL;
+        }
+    }
+#endif
+
+    ESP_LOGI(TAG, "解码器创建: %s, %u Hz", audio_codec_name(codec), (unsigned)dec->sample_rate);
+    return dec;
+}
+
+void audio_decoder_destroy(audio_decoder_handle_t dec)
+{
+    if (!dec) {
+        return;
+    }
+#if AUDIO_DECODER_HAS_OPUS
+    if (dec->opus) {
+        esp_opus_dec_close(dec->opus);
+    }
+#endif
+    free(dec);
+}
+
+esp_err_t audio_decoder_decode(audio_decoder_handle_t dec, const uint8_t *data, size_t len,
+                               int16_t *out, size_t out_capacity, size_t *out_samples)
+{
+    if (!dec || !data || !out || !out_samples) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_samples = 0;
+
+    switch (dec->codec) {
+    case AUDIO_CODEC_PCM16:
+        if (len % sizeof(int16_t) || len / sizeof(int16_t) > out_capacity) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(out, data, len);
+        *out_samples = len / sizeof(int16_t);
+        return ESP_OK;
+
+    case AUDIO_CODEC_IMA_ADPCM:
+        return ima_adpcm_decode(data, len, out, out_capacity, out_samples);
+
+    case AUDIO_CODEC_G711_ULAW:
+    case AUDIO_CODEC_G711_ALAW:
+        if (len > out_capacity) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (dec->codec == AUDIO_CODEC_G711_ULAW) {
+            for (size_t i = 0; i < len; i++) out[i] = g711_ulaw_decode(data[i]);
+        } else {
+            for (size_t i = 0; i < len; i++) out[i] = g711_alaw_decode(data[i]);
+        }
+        *out_samples = len;
+        return ESP_OK;
+
+#if AUDIO_DECODER_HAS_OPUS
+    case AUDIO_CODEC_OPUS:
+        return opus_decode(dec, data, len, out, out_capacity, out_samples);
+#endif
+
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+const char *audio_codec_name(audio_codec_t codec)
+{
+    switch (codec) {
+    case AUDIO_CODEC_PCM16:     return "PCM16";
+    case AUDIO_CODEC_IMA_ADPCM: return "IMA-ADPCM";
+    case AUDIO_CODEC_G711_ULAW: return "G.711 u-law";
+    case AUDIO_CODEC_G711_ALAW: return "G.711 A-law";
+    case AUDIO_CODEC_OPUS:      return "Opus";
+    default:                    return "unknown";
+    }
+}
@@ -17,6 +17,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include <string.h>
 
 static const char *TAG = "AUDIO_MGR";
@@ -65,6 +66,7 @@ typedef struct {
     
     // 共享缓冲区
     ring_buffer_handle_t reference_rb;     ///< 回采缓冲区句柄（播放控制器和 AFE 共享）
+    broadcast_ring_handle_t record_tap;    ///< 录音分接缓冲区（多读者）
     
     // 状态
     bool initialized;                       ///< 是否已初始化
@@ -75,10 +77,17 @@ typedef struct {
     audio_mgr_state_t state;                ///< 状态机
     bool wake_active;                       ///< 是否处于唤醒窗口
     TickType_t wake_deadline_tick;          ///< 唤醒超时tick
+    TickType_t stats_log_tick;              ///< 下次打印流水线统计的tick
     
     // 回调
     audio_record_callback_t record_callback; ///< 录音数据回调函数
     void *record_ctx;                        ///< 录音回调的用户上下文
+    audio_record_callback_ex_t record_callback_ex; ///< 带时间信息的录音回调
+    void *record_ex_ctx;                     ///< 带时间信息录音回调的用户上下文
+    record_sub_handle_t record_subs[AUDIO_MANAGER_MAX_RECORD_SUBSCRIBERS]; ///< 录音订阅者
+    SemaphoreHandle_t record_sub_mutex;      ///< 保护订阅者列表（入队期间不允许取消订阅）
+    volatile uint32_t record_sub_skipped;    ///< 等锁超时、AFE 未能入队的累计帧数
+    uint32_t record_sub_skipped_logged;      ///< 已打印过的跳过帧数
 
     // 调度
     QueueHandle_t event_queue;
@@ -99,6 +108,7 @@ static bool audio_manager_post_event(const audio_mgr_internal_msg_t *msg);
 static void audio_manager_handle_internal_event(const audio_mgr_internal_msg_t *msg);
 static void audio_manager_task(void *arg);
 static void audio_manager_tick(void);
+static void audio_manager_stats_tick(void);
 static void audio_manager_arm_wake_timer(int duration_ms);
 static void audio_manager_clear_wake_timer(void);
 
@@ -183,6 +193,20 @@ static void audio_manager_tick(void)
     }
 }
 
+static void audio_manager_stats_tick(void)
+{
+    uint32_t interval_ms = s_ctx.config.afe_config.stats_log_interval_ms;
+    if (interval_ms == 0 || !s_ctx.afe_wrapper) {
+        return;
+    }
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t)(now - s_ctx.stats_log_tick) >= 0) {
+        s_ctx.stats_log_tick = now + pdMS_TO_TICKS(interval_ms);
+        afe_wrapper_log_pipeline_stats(s_ctx.afe_wrapper);
+        afe_wrapper_reset_pipeline_stats(s_ctx.afe_wrapper);
+    }
+}
+
 // ============ 内部回调函数 ============
 
 /**
@@ -244,18 +268,43 @@ static void afe_event_handler(const afe_event_t *event, void *user_ctx)
 /**
  * @brief AFE 录音数据回调函数
  * 
- * 当 AFE 处理完音频数据后，调用此函数将处理后的音频数据传递给上层应用。
+ * 当 AFE 处理完音频数据后，调用此函数将处理后的音频数据传递给上层应用，
+ * 同时写入录音分接缓冲区供其他读者消费，并放入各订阅者的队列（不阻塞）。
+ * AFE 只在录音期间调用本回调，分接和订阅者因此也只收到录音期间的数据。
+ * 订阅/取消订阅只在更新列表时短暂持锁，这里最多等待 AUDIO_MANAGER_RECORD_SUB_LOCK_MS（至少一个 tick），
+ * 不会因列表更新让所有订阅者丢帧；仍超时（持锁任务被长时间抢占）时本帧不入队，计入 record_sub_skipped。
  * 
  * @param pcm_data PCM 音频数据指针
  * @param samples 采样点数
+ * @param info 本块首个采样点的序号和采集时间
  * @param user_ctx 用户上下文（未使用）
  */
-static void afe_record_handler(const int16_t *pcm_data, size_t samples, void *user_ctx)
+static void afe_record_handler(const int16_t *pcm_data, size_t samples,
+                               const audio_frame_info_t *info, void *user_ctx)
 {
+    // 写入分接缓冲区（不等待任何读者；未录音时不会走到这里）
+    broadcast_ring_write(s_ctx.record_tap, pcm_data, samples);
+
+    // 放入订阅者队列（只拷贝，回调在订阅者任务中执行）；等锁有上限，AFE 回调不会被阻塞
+    TickType_t lock_ticks = pdMS_TO_TICKS(AUDIO_MANAGER_RECORD_SUB_LOCK_MS);
+    if (xSemaphoreTake(s_ctx.record_sub_mutex, lock_ticks > 0 ? lock_ticks : 1) == pdTRUE) {
+        for (int i = 0; i < AUDIO_MANAGER_MAX_RECORD_SUBSCRIBERS; i++) {
+            if (s_ctx.record_subs[i]) {
+                record_sub_push(s_ctx.record_subs[i], pcm_data, samples, info);
+            }
+        }
+        xSemaphoreGive(s_ctx.record_sub_mutex);
+    } else {
+        s_ctx.record_sub_skipped++;
+    }
+
     // 如果设置了录音回调，则调用它
     if (s_ctx.record_callback) {
         s_ctx.record_callback(pcm_data, samples, s_ctx.record_ctx);
     }
+    if (s_ctx.record_callback_ex) {
+        s_ctx.record_callback_ex(pcm_data, samples, info, s_ctx.record_ex_ctx);
+    }
 }
 
 static void audio_manager_handle_internal_event(const audio_mgr_internal_msg_t *msg)
@@ -345,6 +394,7 @@ static void audio_manager_task(void *arg)
             audio_manager_handle_internal_event(&msg);
         }
         audio_manager_tick();
+        audio_manager_stats_tick();
     }
 }
 
@@ -405,6 +455,10 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
         .reference_callback = NULL,
         .reference_ctx = NULL,
         .volume_ptr = &s_ctx.volume,
+        .overflow_policy = AUDIO_MANAGER_PLAYBACK_OVERFLOW_POLICY,
+        .block_timeout_ms = AUDIO_MANAGER_PLAYBACK_BLOCK_TIMEOUT_MS,
+        .sample_rate = s_ctx.config.hw_config.speaker.sample_rate,
+        .encoded_buffer_bytes = AUDIO_MANAGER_ENCODED_BUFFER_BYTES,
     };
 
     s_ctx.playback_ctrl = playback_controller_create(&playback_cfg);
@@ -435,9 +489,25 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
         goto fail;
     }
 
+    s_ctx.record_tap = broadcast_ring_create(AUDIO_MANAGER_RECORD_TAP_SAMPLES);
+    if (!s_ctx.record_tap) {
+        ESP_LOGE(TAG, "录音分接缓冲区创建失败");
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
+    s_ctx.record_sub_mutex = xSemaphoreCreateMutex();
+    if (!s_ctx.record_sub_mutex) {
+        ESP_LOGE(TAG, "录音订阅锁创建失败");
+        ret = ESP_ERR_NO_MEM;
+        goto fail;
+    }
+
     afe_wrapper_config_t afe_cfg = {
         .bsp_handle = s_ctx.bsp,
         .reference_rb = s_ctx.reference_rb,
+        .sample_rate = s_ctx.config.hw_config.mic.sample_rate,
+        .ref_delay = s_ctx.config.afe_config.ref_delay_samples,
         .wakeup_config = (afe_wakeup_config_t){
             .enabled = s_ctx.config.wakeup_config.enabled,
             .wake_word_name = s_ctx.config.wakeup_config.wake_word_name,
@@ -449,13 +519,22 @@ esp_err_t audio_manager_init(const audio_mgr_config_t *config)
             .vad_mode = s_ctx.config.vad_config.vad_mode,
             .min_speech_ms = s_ctx.config.vad_config.min_speech_ms,
             .min_silence_ms = s_ctx.config.vad_config.min_silence_ms,
+            .preroll_ms = s_ctx.config.vad_config.preroll_ms,
+            .listen_only = s_ctx.config.vad_config.listen_only,
         },
         .feature_config = (afe_feature_config_t){
             .aec_enabled = s_ctx.config.afe_config.aec_enabled,
             .ns_enabled = s_ctx.config.afe_config.ns_enabled,
             .agc_enabled = s_ctx.config.afe_config.agc_enabled,
+            .drift_comp_enabled = s_ctx.config.afe_config.drift_comp_enabled,
             .afe_mode = s_ctx.config.afe_config.afe_mode,
         },
+        .task_config = (afe_task_config_t){
+            .feed_priority = s_ctx.config.afe_config.feed_task_priority,
+            .feed_core = s_ctx.config.afe_config.feed_task_core,
+            .fetch_priority = s_ctx.config.afe_config.fetch_task_priority,
+            .fetch_core = s_ctx.config.afe_config.fetch_task_core,
+        },
         .event_callback = afe_event_handler,
         .event_ctx = NULL,
         .record_callback = afe_record_handler,
@@ -536,6 +615,24 @@ void audio_manager_deinit(void)
         s_ctx.afe_wrapper = NULL;
     }
 
+    // 销毁录音订阅者（AFE 已停止写入）
+    for (int i = 0; i < AUDIO_MANAGER_MAX_RECORD_SUBSCRIBERS; i++) {
+        if (s_ctx.record_subs[i]) {
+            record_sub_destroy(s_ctx.record_subs[i], AUDIO_MANAGER_RECORD_SUB_STOP_MS);
+            s_ctx.record_subs[i] = NULL;
+        }
+    }
+    if (s_ctx.record_sub_mutex) {
+        vSemaphoreDelete(s_ctx.record_sub_mutex);
+        s_ctx.record_sub_mutex = NULL;
+    }
+
+    // 销毁录音分接缓冲区（AFE 已停止写入，尚未关闭的读者句柄随之失效）
+    if (s_ctx.record_tap) {
+        broadcast_ring_destroy(s_ctx.record_tap);
+        s_ctx.record_tap = NULL;
+    }
+
     // 销毁播放控制器
     if (s_ctx.playback_ctrl) {
         playback_controller_destroy(s_ctx.playback_ctrl);
@@ -655,25 +752,94 @@ esp_err_t audio_manager_stop_recording(void)
  * @brief 播放音频数据
  * 
  * 将 PCM 音频数据写入播放缓冲区，等待播放。
+ * 缓冲区满时按溢出策略处理（见 audio_manager_set_playback_overflow_policy）。
  * 
  * @param pcm_data PCM 音频数据指针
  * @param sample_count 采样点数
- * @return 
- *     - ESP_OK: 写入成功
- *     - ESP_ERR_INVALID_ARG: 参数无效
- *     - ESP_ERR_INVALID_STATE: 未初始化
+ * @return 实际接受的采样点数，未初始化或参数无效时返回 0
  */
-esp_err_t audio_manager_play_audio(const int16_t *pcm_data, size_t sample_count)
+size_t audio_manager_play_audio(const int16_t *pcm_data, size_t sample_count)
 {
     // 参数检查
     if (!s_ctx.initialized || !pcm_data || sample_count == 0) {
-        return ESP_ERR_INVALID_ARG;
+        return 0;
     }
 
     // 写入播放缓冲区
     return playback_controller_write(s_ctx.playback_ctrl, pcm_data, sample_count);
 }
 
+/**
+ * @brief 设置播放数据的采样率
+ * 
+ * @param sample_rate 输入采样率（0 表示与扬声器采样率相同）
+ * @return 
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_STATE: 未初始化或正在播放
+ *     - ESP_ERR_NOT_SUPPORTED: 采样率比例无法支持
+ */
+esp_err_t audio_manager_set_playback_sample_rate(uint32_t sample_rate)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+
+    return playback_controller_set_input_rate(s_ctx.playback_ctrl, sample_rate);
+}
+
+/**
+ * @brief 设置压缩音频的格式
+ * 
+ * @param codec 压缩格式
+ * @return 
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_STATE: 未初始化或正在播放
+ *     - ESP_ERR_NOT_SUPPORTED: 格式不支持
+ */
+esp_err_t audio_manager_set_playback_codec(audio_codec_t codec)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+
+    return playback_controller_set_codec(s_ctx.playback_ctrl, codec);
+}
+
+/**
+ * @brief 播放一个压缩帧
+ * 
+ * @param frame 压缩帧
+ * @param len 字节数
+ * @param timeout_ms 缓冲区满时最长等待时间（毫秒）
+ * @return 
+ *     - ESP_OK: 写入成功
+ *     - ESP_ERR_TIMEOUT: 缓冲区满
+ *     - ESP_ERR_INVALID_STATE: 未初始化或未设置格式
+ */
+esp_err_t audio_manager_play_encoded(const uint8_t *frame, size_t len, uint32_t timeout_ms)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+
+    return playback_controller_write_encoded(s_ctx.playback_ctrl, frame, len, timeout_ms);
+}
+
+/**
+ * @brief 设置播放缓冲区溢出策略
+ * 
+ * @param policy 溢出策略
+ * @param block_timeout_ms BLOCK 策略下单次写入最长等待时间（毫秒）
+ * @return 
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t audio_manager_set_playback_overflow_policy(ring_buffer_overflow_policy_t policy,
+                                                     uint32_t block_timeout_ms)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+
+    return playback_controller_set_overflow_policy(s_ctx.playback_ctrl, policy, block_timeout_ms);
+}
+
 size_t audio_manager_get_playback_free_space(void)
 {
     // 检查是否已初始化
@@ -684,6 +850,306 @@ size_t audio_manager_get_playback_free_space(void)
     return playback_controller_get_free_space(s_ctx.playback_ctrl);
 }
 
+/**
+ * @brief 打开录音分接读者
+ * 
+ * @return 读者句柄，未初始化或读者已满时返回 NULL
+ */
+broadcast_reader_handle_t audio_manager_open_record_tap(void)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized) return NULL;
+
+    return broadcast_ring_open_reader(s_ctx.record_tap);
+}
+
+/**
+ * @brief 关闭录音分接读者
+ * 
+ * @param reader 读者句柄
+ */
+void audio_manager_close_record_tap(broadcast_reader_handle_t reader)
+{
+    broadcast_ring_close_reader(reader);
+}
+
+/**
+ * @brief 打印等待订阅者列表锁超时、AFE 跳过的帧数（在订阅/取消订阅的调用者任务中打印）
+ */
+static void audio_manager_log_record_sub_skipped(void)
+{
+    uint32_t skipped = s_ctx.record_sub_skipped;
+    if (skipped != s_ctx.record_sub_skipped_logged) {
+        ESP_LOGW(TAG, "等待订阅者列表超时，录音帧未入队: %u 帧（累计 %u 帧）",
+                 (unsigned)(skipped - s_ctx.record_sub_skipped_logged), (unsigned)skipped);
+        s_ctx.record_sub_skipped_logged = skipped;
+    }
+}
+
+/**
+ * @brief 订阅录音数据
+ * 
+ * @param config 订阅配置
+ * @return 订阅者句柄，失败返回 NULL
+ */
+record_sub_handle_t audio_manager_subscribe_record(const record_sub_config_t *config)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized || !config) return NULL;
+
+    record_sub_handle_t sub = record_sub_create(config, s_ctx.config.hw_config.mic.sample_rate);
+    if (!sub) {
+        return NULL;
+    }
+
+    xSemaphoreTake(s_ctx.record_sub_mutex, portMAX_DELAY);
+    int slot = -1;
+    for (int i = 0; i < AUDIO_MANAGER_MAX_RECORD_SUBSCRIBERS; i++) {
+        if (!s_ctx.record_subs[i]) {
+            s_ctx.record_subs[i] = sub;
+            slot = i;
+            break;
+        }
+    }
+    xSemaphoreGive(s_ctx.record_sub_mutex);
+    audio_manager_log_record_sub_skipped();
+
+    if (slot < 0) {
+        ESP_LOGW(TAG, "录音订阅者已满（最多 %d 个）", AUDIO_MANAGER_MAX_RECORD_SUBSCRIBERS);
+        record_sub_destroy(sub, AUDIO_MANAGER_RECORD_SUB_STOP_MS);
+        return NULL;
+    }
+    return sub;
+}
+
+/**
+ * @brief 取消录音订阅
+ * 
+ * @param sub 订阅者句柄
+ * @return 
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_NOT_FOUND: 不是有效的订阅者
+ *     - ESP_ERR_TIMEOUT: 回调仍在执行，返回后由投递任务自行释放
+ */
+esp_err_t audio_manager_unsubscribe_record(record_sub_handle_t sub)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized || !sub) return ESP_ERR_INVALID_ARG;
+
+    // 先从列表移除（持锁期间 AFE 不会入队），再停止投递任务
+    bool found = false;
+    xSemaphoreTake(s_ctx.record_sub_mutex, portMAX_DELAY);
+    for (int i = 0; i < AUDIO_MANAGER_MAX_RECORD_SUBSCRIBERS; i++) {
+        if (s_ctx.record_subs[i] == sub) {
+            s_ctx.record_subs[i] = NULL;
+            found = true;
+            break;
+        }
+    }
+    xSemaphoreGive(s_ctx.record_sub_mutex);
+    audio_manager_log_record_sub_skipped();
+
+    if (!found) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return record_sub_destroy(sub, AUDIO_MANAGER_RECORD_SUB_STOP_MS);
+}
+
+/**
+ * @brief 获取录音订阅者统计
+ * 
+ * @param sub 订阅者句柄
+ * @param stats 输出统计
+ * @return esp_err_t ESP_OK 成功
+ */
+esp_err_t audio_manager_get_record_sub_stats(record_sub_handle_t sub, record_sub_stats_t *stats)
+{
+    return record_sub_get_stats(sub, stats);
+}
+
+/**
+ * @brief 设置播放缓冲区高/低水位回调
+ * 
+ * @param low 低水位（采样点数）
+ * @param high 高水位（采样点数）
+ * @param callback 水位回调，NULL 表示关闭
+ * @param user_ctx 回调上下文
+ * @return 
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ *     - ESP_ERR_INVALID_ARG: 水位无效
+ */
+esp_err_t audio_manager_set_playback_watermarks(size_t low, size_t high,
+                                                ring_buffer_watermark_cb_t callback, void *user_ctx)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized) return ESP_ERR_INVALID_STATE;
+
+    return playback_controller_set_watermarks(s_ctx.playback_ctrl, low, high, callback, user_ctx);
+}
+
+/**
+ * @brief 等待播放缓冲区剩余空间达到 min_free
+ * 
+ * @param min_free 等待的最低剩余空间（采样点数）
+ * @param timeout_ms 最长等待时间（毫秒）
+ * @return 返回时的剩余空间，未初始化时返回 0
+ */
+size_t audio_manager_wait_playback_space(size_t min_free, uint32_t timeout_ms)
+{
+    // 检查是否已初始化
+    if (!s_ctx.initialized || !s_ctx.playback_ctrl) {
+        return 0;
+    }
+
+    return playback_controller_wait_free_space(s_ctx.playback_ctrl, min_free, timeout_ms);
+}
+
+/**
+ * @brief 获取播放/回采缓冲区统计信息
+ * 
+ * @param stats 输出统计信息
+ * @return 
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t audio_manager_get_buffer_stats(audio_mgr_buffer_stats_t *stats)
+{
+    if (!stats) return ESP_ERR_INVALID_ARG;
+    if (!s_ctx.initialized || !s_ctx.playback_ctrl) return ESP_ERR_INVALID_STATE;
+
+    return playback_controller_get_stats(s_ctx.playback_ctrl, &stats->playback, &stats->reference);
+}
+
+/**
+ * @brief 获取麦克风与回采流之间的时间偏差
+ * 
+ * @param timing 输出时间信息
+ * @return 
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t audio_manager_get_stream_skew(audio_mgr_stream_timing_t *timing)
+{
+    if (!timing) return ESP_ERR_INVALID_ARG;
+    if (!s_ctx.initialized || !s_ctx.afe_wrapper) return ESP_ERR_INVALID_STATE;
+
+    afe_stream_timing_t afe_timing;
+    esp_err_t ret = afe_wrapper_get_stream_timing(s_ctx.afe_wrapper, &afe_timing);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    timing->mic = afe_timing.mic;
+    timing->reference = afe_timing.reference;
+    timing->skew_us = afe_timing.skew_us;
+    timing->reference_valid = afe_timing.reference_valid;
+    timing->drift_ppm = afe_timing.drift_ppm;
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取麦克风电平统计
+ * 
+ * @param level 输出统计
+ * @return 
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t audio_manager_get_mic_level(audio_bsp_mic_level_t *level)
+{
+    if (!level) return ESP_ERR_INVALID_ARG;
+    if (!s_ctx.initialized || !s_ctx.bsp) return ESP_ERR_INVALID_STATE;
+
+    return audio_bsp_get_mic_level(s_ctx.bsp, level);
+}
+
+/**
+ * @brief 开始估计回采延迟
+ * 
+ * @return 
+ *     - ESP_OK: 已请求估计
+ *     - ESP_ERR_NOT_SUPPORTED: 未启用 AEC
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t audio_manager_estimate_reference_delay(void)
+{
+    if (!s_ctx.initialized || !s_ctx.afe_wrapper) return ESP_ERR_INVALID_STATE;
+
+    return afe_wrapper_start_delay_estimation(s_ctx.afe_wrapper);
+}
+
+/**
+ * @brief 设置回采对齐延迟
+ * 
+ * @param delay_samples 延迟（采样点数），<0 表示清除
+ * @return 
+ *     - ESP_OK: 设置成功
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t audio_manager_set_reference_delay(int32_t delay_samples)
+{
+    if (!s_ctx.initialized || !s_ctx.afe_wrapper) return ESP_ERR_INVALID_STATE;
+
+    return afe_wrapper_set_ref_delay(s_ctx.afe_wrapper, delay_samples);
+}
+
+/**
+ * @brief 获取回采对齐延迟状态
+ * 
+ * @param delay 输出状态
+ * @return 
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ *     - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t audio_manager_get_reference_delay(audio_mgr_ref_delay_t *delay)
+{
+    if (!delay) return ESP_ERR_INVALID_ARG;
+    if (!s_ctx.initialized || !s_ctx.afe_wrapper) return ESP_ERR_INVALID_STATE;
+
+    afe_ref_delay_t afe_delay;
+    esp_err_t ret = afe_wrapper_get_ref_delay(s_ctx.afe_wrapper, &afe_delay);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    delay->delay_samples = afe_delay.delay_samples;
+    delay->valid = afe_delay.valid;
+    delay->estimating = afe_delay.estimating;
+    delay->confidence = afe_delay.confidence;
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取 AFE 流水线统计
+ * 
+ * @param stats 输出统计
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_get_pipeline_stats(afe_pipeline_stats_t *stats)
+{
+    if (!stats) return ESP_ERR_INVALID_ARG;
+    if (!s_ctx.initialized || !s_ctx.afe_wrapper) return ESP_ERR_INVALID_STATE;
+
+    return afe_wrapper_get_pipeline_stats(s_ctx.afe_wrapper, stats);
+}
+
+/**
+ * @brief 清零 AFE 流水线统计
+ * 
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t audio_manager_reset_pipeline_stats(void)
+{
+    if (!s_ctx.initialized || !s_ctx.afe_wrapper) return ESP_ERR_INVALID_STATE;
+
+    return afe_wrapper_reset_pipeline_stats(s_ctx.afe_wrapper);
+}
+
 /**
  * @brief 启动播放
  * 
@@ -711,7 +1177,9 @@ esp_err_t audio_manager_start_playback(void)
  * 
  * 停止播放控制器，不再播放音频。
  * 
- * @return ESP_OK: 停止成功
+ * @return 
+ *     - ESP_OK: 停止成功
+ *     - ESP_ERR_TIMEOUT: 播放任务未确认停止，播放状态保持不变（可再次调用等待确认）
  */
 esp_err_t audio_manager_stop_playback(void)
 {
@@ -734,6 +1202,7 @@ esp_err_t audio_manager_stop_playback(void)
  * @return 
  *     - ESP_OK: 清空成功
  *     - ESP_ERR_INVALID_STATE: 未初始化
+ *     - ESP_ERR_TIMEOUT: 播放任务未及时确认（请求保留，稍后执行）
  */
 esp_err_t audio_manager_clear_playback_buffer(void)
 {
@@ -773,22 +1242,21 @@ uint8_t audio_manager_get_volume(void)
 /**
  * @brief 更新唤醒词配置
  * 
- * 动态更新唤醒词检测的配置参数。
+ * 动态更新唤醒词检测的配置参数。开关唤醒词、切换模型或修改灵敏度时立即重建 AFE，
+ * 采集中断时长记录在日志中；失败时保持原配置。
  * 
  * @param config 唤醒词配置参数
  * @return 
  *     - ESP_OK: 更新成功
  *     - ESP_ERR_INVALID_ARG: 参数无效
  *     - ESP_ERR_INVALID_STATE: 未初始化
+ *     - ESP_ERR_NOT_FOUND: 模型加载失败
  */
 esp_err_t audio_manager_update_wakeup_config(const audio_mgr_wakeup_config_t *config)
 {
     // 参数检查
     if (!s_ctx.initialized || !config) return ESP_ERR_INVALID_ARG;
 
-    // 更新配置
-    memcpy(&s_ctx.config.wakeup_config, config, sizeof(audio_mgr_wakeup_config_t));
-    
     // 构造 AFE 唤醒词配置
     afe_wakeup_config_t afe_wakeup = {
         .enabled = config->enabled,
@@ -797,8 +1265,13 @@ esp_err_t audio_manager_update_wakeup_config(const audio_mgr_wakeup_config_t *co
         .sensitivity = config->sensitivity,
     };
     
-    // 更新 AFE 配置
-    return afe_wrapper_update_wakeup_config(s_ctx.afe_wrapper, &afe_wakeup);
+    // 更新 AFE 配置（需要时重建 AFE），成功后再保存
+    esp_err_t ret = afe_wrapper_update_wakeup_config(s_ctx.afe_wrapper, &afe_wakeup);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    memcpy(&s_ctx.config.wakeup_config, config, sizeof(audio_mgr_wakeup_config_t));
+    return ESP_OK;
 }
 
 /**
@@ -877,3 +1350,15 @@ void audio_manager_set_record_callback(audio_record_callback_t callback, void *u
     s_ctx.record_callback = callback;
     s_ctx.record_ctx = user_ctx;
 }
+
+/**
+ * @brief 注册带时间信息的录音数据回调
+ * 
+ * @param callback 回调函数，NULL 表示取消
+ * @param user_ctx 用户上下文
+ */
+void audio_manager_set_record_callback_ex(audio_record_callback_ex_t callback, void *user_ctx)
+{
+    s_ctx.record_callback_ex = callback;
+    s_ctx.record_ex_ctx = user_ctx;
+}
@@ -0,0 +1,497 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\broadcast_ring.c
+ * @Description: 广播环形缓冲区实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "broadcast_ring.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "BCAST_RING";
+
+/**
+ * @brief 读者结构体
+ *
+ * 游标为单调递增的采样序号（按 size_t 自然回绕），写入端只读取它来判断是否需要唤醒。
+ */
+struct broadcast_reader_s {
+    struct broadcast_ring_s *ring;    ///< 所属广播缓冲区
+    atomic_bool in_use;               ///< 槽位是否已被打开
+    atomic_size_t cursor;             ///< 读游标（读者独占推进）
+    atomic_size_t wait_threshold;     ///< 读者等待的最低数据量，0 表示没有等待
+    SemaphoreHandle_t data_sem;       ///< 数据可用信号量
+    size_t peek_len;                  ///< 最近一次 peek 的长度（读者私有）
+    broadcast_reader_stats_t stats;   ///< 统计信息（读者私有）
+};
+
+/**
+ * @brief 广播环形缓冲区结构体
+ *
+ * 单写多读，所有读者共享同一块 PSRAM 存储，各自持有游标：
+ * - 容量为 2 的幂，序号到下标只需一次按位与
+ * - 写入端不等待任何读者，落后超过容量的读者直接跳到最旧的有效数据
+ * - 写入前先发布 reserve_seq，读者拷贝完成后据此校验数据是否在拷贝期间被覆盖
+ *   （类似 seqlock），被覆盖的部分丢弃并计入溢出统计，保证不会返回撕裂的数据
+ */
+typedef struct broadcast_ring_s {
+    int16_t *buffer;                  ///< 数据缓冲区（PSRAM）
+    size_t size;                      ///< 容量（采样点数，2 的幂）
+    size_t mask;                      ///< size - 1
+    atomic_size_t write_seq;          ///< 已发布的写入序号
+    atomic_size_t reserve_seq;        ///< 正在写入的最大序号（>= write_seq）
+    struct broadcast_reader_s readers[BROADCAST_RING_MAX_READERS];  ///< 读者槽位
+} broadcast_ring_t;
+
+/**
+ * @brief 将序号区间 [seq, seq + n) 拷出到 out（n <= size）
+ */
+static void br_copy_out(const broadcast_ring_t *br, size_t seq, int16_t *out, size_t n)
+{
+    size_t idx = seq & br->mask;
+    size_t first = br->size - idx;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(out, br->buffer + idx, first * sizeof(int16_t));
+    if (n > first) {
+        memcpy(out + first, br->buffer, (n - first) * sizeof(int16_t));
+    }
+}
+
+/**
+ * @brief 计算读者可读的数据量；落后超过容量时先跳到最旧的有效数据并记入溢出
+ *
+ * @return 可读数据量（不超过容量）
+ */
+static size_t br_reader_sync(struct broadcast_reader_s *rd)
+{
+    broadcast_ring_t *br = rd->ring;
+    size_t w = atomic_load_explicit(&br->write_seq, memory_order_acquire);
+    size_t c = atomic_load_explicit(&rd->cursor, memory_order_relaxed);
+    size_t lag = w - c;
+
+    if (lag > br->size) {
+        size_t skipped = lag - br->size;
+        rd->stats.overrun_samples += skipped;
+        rd->stats.overrun_events++;
+        atomic_store_explicit(&rd->cursor, c + skipped, memory_order_relaxed);
+        lag = br->size;
+    }
+    if (lag > rd->stats.max_lag) {
+        rd->stats.max_lag = lag;
+    }
+    return lag;
+}
+
+/**
+ * @brief 拷贝/访问结束后校验 [seq, seq + n) 是否仍然有效
+ *
+ * @return 区间开头已被写入端覆盖（或正在覆盖）的采样点数
+ */
+static size_t br_clobbered(const broadcast_ring_t *br, size_t seq, size_t n)
+{
+    atomic_thread_fence(memory_order_acquire);
+    size_t reserved = atomic_load_explicit(&br->reserve_seq, memory_order_relaxed);
+    size_t reach = reserved - seq;
+    if (reach <= br->size) {
+        return 0;
+    }
+    size_t lost = reach - br->size;
+    return lost > n ? n : lost;
+}
+
+/**
+ * @brief 等待读者可读数据达到 1 个采样点或超时
+ *
+ * @return 返回时的可读数据量
+ */
+static size_t br_reader_wait(struct broadcast_reader_s *rd, uint32_t timeout_ms)
+{
+    size_t avail = br_reader_sync(rd);
+    if (avail > 0 || timeout_ms == 0) {
+        return avail;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    for (;;) {
+        // 先登记等待再检查数据，与写入端的通知配对，不会丢失唤醒
+        atomic_store_explicit(&rd->wait_threshold, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        avail = br_reader_sync(rd);
+        if (avail > 0) {
+            break;
+        }
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            break;
+        }
+        xSemaphoreTake(rd->data_sem, timeout - elapsed);
+    }
+    atomic_store_explicit(&rd->wait_threshold, 0, memory_order_relaxed);
+    return avail;
+}
+
+/**
+ * @brief 创建广播环形缓冲区
+ *
+ * 容量向上取整为 2 的幂，并为每个读者槽位预先创建信号量，
+ * 打开/关闭读者不再分配内存，写入端也不会访问已删除的同步对象。
+ *
+ * @param samples 最小容量（采样点数）
+ *
+ * @return 广播缓冲区句柄，失败返回 NULL
+ */
+broadcast_ring_handle_t broadcast_ring_create(size_t samples)
+{
+    if (samples == 0) {
+        ESP_LOGE(TAG, "无效的缓冲区大小");
+        return NULL;
+    }
+
+    size_t size = 1;
+    while (size < samples) {
+        size <<= 1;
+    }
+
+    broadcast_ring_t *br = (broadcast_ring_t *)calloc(1, sizeof(broadcast_ring_t));
+    if (!br) {
+        ESP_LOGE(TAG, "广播缓冲区句柄分配失败");
+        return NULL;
+    }
+
+    br->buffer = (int16_t *)heap_caps_malloc(size * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+    if (!br->buffer) {
+        ESP_LOGE(TAG, "广播缓冲区分配失败: %d samples", (int)size);
+        free(br);
+        return NULL;
+    }
+
+    br->size = size;
+    br->mask = size - 1;
+    atomic_init(&br->write_seq, 0);
+    atomic_init(&br->reserve_seq, 0);
+
+    for (int i = 0; i < BROADCAST_RING_MAX_READERS; i++) {
+        struct broadcast_reader_s *rd = &br->readers[i];
+        rd->ring = br;
+        atomic_init(&rd->in_use, false);
+        atomic_init(&rd->cursor, 0);
+        atomic_init(&rd->wait_threshold, 0);
+        rd->data_sem = xSemaphoreCreateBinary();
+        if (!rd->data_sem) {
+            ESP_LOGE(TAG, "信号量创建失败");
+            broadcast_ring_destroy(br);
+            return NULL;
+        }
+    }
+
+    ESP_LOGI(TAG, "广播缓冲区创建成功: %d samples, 最多 %d 个读者",
+             (int)size, BROADCAST_RING_MAX_READERS);
+    return br;
+}
+
+/**
+ * @brief 销毁广播环形缓冲区
+ *
+ * @param br 广播缓冲区句柄，允许为 NULL
+ *
+ * @note 调用前确保写入端和所有读者都已停止访问，销毁后读者句柄失效
+ */
+void broadcast_ring_destroy(broadcast_ring_handle_t br)
+{
+    if (!br) return;
+
+    for (int i = 0; i < BROADCAST_RING_MAX_READERS; i++) {
+        if (br->readers[i].data_sem) {
+            vSemaphoreDelete(br->readers[i].data_sem);
+        }
+    }
+    if (br->buffer) {
+        heap_caps_free(br->buffer);
+    }
+    free(br);
+}
+
+/**
+ * @brief 写入数据
+ *
+ * 写入端从不等待读者。一次写入超过容量时只保留最后 size 个采样点，
+ * 前面的部分视为已写入并立即被覆盖。
+ *
+ * @param br 广播缓冲区句柄
+ * @param data 数据指针
+ * @param samples 采样点数
+ *
+ * @return 写入的采样点数（等于 samples，参数无效时为 0）
+ */
+size_t broadcast_ring_write(broadcast_ring_handle_t br, const int16_t *data, size_t samples)
+{
+    if (!br || !data || samples == 0) {
+        return 0;
+    }
+
+    size_t w = atomic_load_explicit(&br->write_seq, memory_order_relaxed);
+    size_t end = w + samples;
+    if (samples > br->size) {
+        data += samples - br->size;
+        w = end - br->size;
+    }
+    size_t n = end - w;
+
+    // 先发布将要覆盖的范围，读者据此校验拷贝期间数据是否被改写
+    atomic_store_explicit(&br->reserve_seq, end, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    size_t idx = w & br->mask;
+    size_t first = br->size - idx;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(br->buffer + idx, data, first * sizeof(int16_t));
+    if (n > first) {
+        memcpy(br->buffer, data + first, (n - first) * sizeof(int16_t));
+    }
+
+    atomic_store_explicit(&br->write_seq, end, memory_order_release);
+
+    // 与读者登记等待配对的全屏障，只唤醒正在等待的读者
+    atomic_thread_fence(memory_order_seq_cst);
+    for (int i = 0; i < BROADCAST_RING_MAX_READERS; i++) {
+        struct broadcast_reader_s *rd = &br->readers[i];
+        if (atomic_load_explicit(&rd->in_use, memory_order_relaxed) &&
+            atomic_load_explicit(&rd->wait_threshold, memory_order_relaxed) > 0) {
+            xSemaphoreGive(rd->data_sem);
+        }
+    }
+
+    return samples;
+}
+
+/**
+ * @brief 打开一个读者
+ *
+ * 读者从当前写入位置开始，只能看到打开之后写入的数据。
+ *
+ * @param br 广播缓冲区句柄
+ *
+ * @return 读者句柄，槽位已满时返回 NULL
+ */
+broadcast_reader_handle_t broadcast_ring_open_reader(broadcast_ring_handle_t br)
+{
+    if (!br) {
+        return NULL;
+    }
+
+    for (int i = 0; i < BROADCAST_RING_MAX_READERS; i++) {
+        struct broadcast_reader_s *rd = &br->readers[i];
+        bool expected = false;
+        if (!atomic_compare_exchange_strong(&rd->in_use, &expected, true)) {
+            continue;
+        }
+        atomic_store(&rd->cursor, atomic_load(&br->write_seq));
+        atomic_store(&rd->wait_threshold, 0);
+        rd->peek_len = 0;
+        memset(&rd->stats, 0, sizeof(rd->stats));
+        xSemaphoreTake(rd->data_sem, 0);
+        return rd;
+    }
+
+    ESP_LOGW(TAG, "读者数量已达上限: %d", BROADCAST_RING_MAX_READERS);
+    return NULL;
+}
+
+/**
+ * @brief 关闭读者，释放槽位
+ *
+ * @param reader 读者句柄，允许为 NULL
+ */
+void broadcast_ring_close_reader(broadcast_reader_handle_t reader)
+{
+    if (!reader) return;
+    atomic_store(&reader->in_use, false);
+}
+
+/**
+ * @brief 读取数据（拷贝）
+ *
+ * 拷贝完成后校验数据是否在拷贝期间被写入端覆盖，被覆盖的开头部分丢弃，
+ * 其余数据前移后返回。
+ *
+ * @param reader 读者句柄
+ * @param out 输出缓冲区
+ * @param samples 最多读取的采样点数
+ * @param timeout_ms 无数据时的最长等待时间（毫秒），0 表示不阻塞
+ *
+ * @return 实际读取的采样点数
+ */
+size_t broadcast_ring_read(broadcast_reader_handle_t reader, int16_t *out,
+                           size_t samples, uint32_t timeout_ms)
+{
+    if (!reader || !out || samples == 0) {
+        return 0;
+    }
+
+    broadcast_ring_t *br = reader->ring;
+    size_t avail = br_reader_wait(reader, timeout_ms);
+    size_t n = avail < samples ? avail : samples;
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t c = atomic_load_explicit(&reader->cursor, memory_order_relaxed);
+    br_copy_out(br, c, out, n);
+
+    size_t lost = br_clobbered(br, c, n);
+    if (lost > 0) {
+        reader->stats.overrun_samples += lost;
+        reader->stats.overrun_events++;
+        memmove(out, out + lost, (n - lost) * sizeof(int16_t));
+    }
+
+    atomic_store_explicit(&reader->cursor, c + n, memory_order_relaxed);
+    reader->stats.total_read += n - lost;
+    return n - lost;
+}
+
+/**
+ * @brief 零拷贝读取：获取可读数据的内部区间
+ *
+ * 区间在 broadcast_ring_release 之前有效；读者落后太多时写入端可能在访问期间
+ * 覆盖该区间，由 release 的返回值报告。
+ *
+ * @param reader 读者句柄
+ * @param samples 期望读取的采样点数
+ * @param span 输出区间
+ * @param timeout_ms 无数据时的最长等待时间（毫秒）
+ *
+ * @return 区间内的采样点数
+ */
+size_t broadcast_ring_peek(broadcast_reader_handle_t reader, size_t samples,
+                           ring_buffer_span_t *span, uint32_t timeout_ms)
+{
+    if (!reader || !span) {
+        return 0;
+    }
+
+    memset(span, 0, sizeof(*span));
+    reader->peek_len = 0;
+
+    broadcast_ring_t *br = reader->ring;
+    size_t avail = br_reader_wait(reader, timeout_ms);
+    size_t n = avail < samples ? avail : samples;
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t idx = atomic_load_explicit(&reader->cursor, memory_order_relaxed) & br->mask;
+    size_t first = br->size - idx;
+    if (first > n) {
+        first = n;
+    }
+    span->data[0] = br->buffer + idx;
+    span->len[0] = first;
+    if (n > first) {
+        span->data[1] = br->buffer;
+        span->len[1] = n - first;
+    }
+
+    reader->peek_len = n;
+    return n;
+}
+
+/**
+ * @brief 释放 peek 得到的区间并推进游标
+ *
+ * @param reader 读者句柄
+ * @param samples 释放的采样点数（截断为 peek 的长度）
+ *
+ * @return true 访问期间数据完整；false 部分数据已被覆盖
+ */
+bool broadcast_ring_release(broadcast_reader_handle_t reader, size_t samples)
+{
+    if (!reader) {
+        return false;
+    }
+
+    if (samples > reader->peek_len) {
+        samples = reader->peek_len;
+    }
+    reader->peek_len = 0;
+
+    size_t c = atomic_load_explicit(&reader->cursor, memory_order_relaxed);
+    size_t lost = br_clobbered(reader->ring, c, samples);
+    if (lost > 0) {
+        reader->stats.overrun_samples += lost;
+        reader->stats.overrun_events++;
+    }
+
+    atomic_store_explicit(&reader->cursor, c + samples, memory_order_relaxed);
+    reader->stats.total_read += samples - lost;
+    return lost == 0;
+}
+
+/**
+ * @brief 获取读者可读的采样点数
+ *
+ * @param reader 读者句柄
+ *
+ * @return 可读采样点数（落后超过容量时截断为容量）
+ */
+size_t broadcast_ring_reader_available(broadcast_reader_handle_t reader)
+{
+    if (!reader) {
+        return 0;
+    }
+
+    broadcast_ring_t *br = reader->ring;
+    size_t lag = atomic_load_explicit(&br->write_seq, memory_order_acquire) -
+                 atomic_load_explicit(&reader->cursor, memory_order_relaxed);
+    return lag > br->size ? br->size : lag;
+}
+
+/**
+ * @brief 获取读者统计信息
+ *
+ * 快照不加锁，应由读者所在任务调用，或容忍与读取并发时的轻微不一致。
+ *
+ * @param reader 读者句柄
+ * @param stats 输出统计信息
+ *
+ * @return
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t broadcast_ring_get_reader_stats(broadcast_reader_handle_t reader,
+                                          broadcast_reader_stats_t *stats)
+{
+    if (!reader || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *stats = reader->stats;
+    stats->lag = broadcast_ring_reader_available(reader);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取广播缓冲区的容量
+ *
+ * @param br 广播缓冲区句柄
+ *
+ * @return 缓冲区容量（采样点数），句柄无效时返回 0
+ */
+size_t broadcast_ring_get_size(broadcast_ring_handle_t br)
+{
+    return br ? br->size : 0;
+}
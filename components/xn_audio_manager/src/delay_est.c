@@ -0,0 +1,195 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\delay_est.c
+ * @Description: 回声延迟估计实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "delay_est.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DELAY_EST_DECIMATE          8       ///< 降采样倍数（16kHz -> 2kHz，分辨率由抛物线插值补足；运算量与其平方成反比）
+#define DELAY_EST_DEFAULT_MAX_LAG   2048
+#define DELAY_EST_DEFAULT_WINDOW_MS 2000
+#define DELAY_EST_DEFAULT_CONF      5.0f
+
+/**
+ * @brief 延迟估计器结构体
+ *
+ * 以降采样域的序号 n 计：取 mic[n - L] 与 ref[n - k]（k = 0..2L）相乘累加到 acc[k]，
+ * 对应延迟 k - L。mic 只需保留 L 个历史，ref 保留 2L 个。
+ */
+struct delay_est_s {
+    uint32_t max_lag_dec;       ///< 降采样域最大延迟 L
+    uint32_t window_dec;        ///< 降采样域窗口长度
+    float min_confidence;       ///< 最低置信度
+
+    int32_t mic_sum;            ///< 当前降采样组的麦克风累加
+    int32_t ref_sum;            ///< 当前降采样组的回采累加
+    uint32_t phase;             ///< 当前降采样组已累加的点数
+    int16_t mic_prev;           ///< 上一个降采样麦克风值（差分用）
+    int16_t ref_prev;           ///< 上一个降采样回采值
+
+    int16_t *mic_hist;          ///< 麦克风历史（L + 1，环形）
+    int16_t *ref_hist;          ///< 回采历史（2L + 1，环形）
+    uint32_t hist_pos;          ///< 已写入的降采样点数
+    int64_t *acc;               ///< 互相关累加（2L + 1）
+    uint32_t accumulated;       ///< 已累加的降采样点数
+};
+
+delay_est_handle_t delay_est_create(const delay_est_config_t *config)
+{
+    delay_est_config_t cfg = config ? *config : (delay_est_config_t){0};
+    uint32_t rate = cfg.sample_rate ? cfg.sample_rate : 16000;
+    uint32_t max_lag = cfg.max_lag ? cfg.max_lag : DELAY_EST_DEFAULT_MAX_LAG;
+    uint32_t window_ms = cfg.window_ms ? cfg.window_ms : DELAY_EST_DEFAULT_WINDOW_MS;
+
+    delay_est_handle_t de = (delay_est_handle_t)calloc(1, sizeof(struct delay_est_s));
+    if (!de) {
+        return NULL;
+    }
+
+    de->max_lag_dec = (max_lag + DELAY_EST_DECIMATE - 1) / DELAY_EST_DECIMATE;
+    de->window_dec = (uint32_t)((uint64_t)rate * window_ms / 1000 / DELAY_EST_DECIMATE);
+    de->min_confidence = cfg.min_confidence > 0 ? cfg.min_confidence : DELAY_EST_DEFAULT_CONF;
+
+    uint32_t lags = 2 * de->max_lag_dec + 1;
+    de->mic_hist = (int16_t *)calloc(de->max_lag_dec + 1, sizeof(int16_t));
+    de->ref_hist = (int16_t *)calloc(lags, sizeof(int16_t));
+    de->acc = (int64_t *)calloc(lags, sizeof(int64_t));
+    if (!de->mic_hist || !de->ref_hist || !de->acc) {
+        delay_est_destroy(de);
+        return NULL;
+    }
+    return de;
+}
+
+void delay_est_destroy(delay_est_handle_t de)
+{
+    if (!de) {
+        return;
+    }
+    free(de->mic_hist);
+    free(de->ref_hist);
+    free(de->acc);
+    free(de);
+}
+
+void delay_est_reset(delay_est_handle_t de)
+{
+    if (!de) {
+        return;
+    }
+
+    uint32_t lags = 2 * de->max_lag_dec + 1;
+    de->mic_sum = 0;
+    de->ref_sum = 0;
+    de->phase = 0;
+    de->mic_prev = 0;
+    de->ref_prev = 0;
+    de->hist_pos = 0;
+    de->accumulated = 0;
+    memset(de->mic_hist, 0, (de->max_lag_dec + 1) * sizeof(int16_t));
+    memset(de->ref_hist, 0, lags * sizeof(int16_t));
+    memset(de->acc, 0, lags * sizeof(int64_t));
+}
+
+/**
+ * @brief 送入一个降采样点并累加互相关
+ *
+ * 差分后的值右移 2 位（15 位以内），乘积在 int32 内，再累加到 int64
+ */
+static void delay_est_push(delay_est_handle_t de, int16_t mic, int16_t ref)
+{
+    const uint32_t L = de->max_lag_dec;
+    const uint32_t lags = 2 * L + 1;
+
+    int16_t dm = (int16_t)(((int32_t)mic - de->mic_prev) >> 2);
+    int16_t dr = (int16_t)(((int32_t)ref - de->ref_prev) >> 2);
+    de->mic_prev = mic;
+    de->ref_prev = ref;
+
+    uint32_t n = de->hist_pos++;
+    de->mic_hist[n % (L + 1)] = dm;
+    de->ref_hist[n % lags] = dr;
+    if (n < 2 * L) {
+        return;  // 历史未填满
+    }
+
+    // mic[n - L] 与 ref[n - k]，k = 0..2L
+    int32_t m = de->mic_hist[(n - L) % (L + 1)];
+    // 环形历史按回绕点拆成两段连续访问，内层循环无取模和分支
+    uint32_t base = n % lags;
+    const int16_t *r = de->ref_hist;
+    int64_t *acc = de->acc;
+    for (uint32_t k = 0; k <= base; k++) {
+        acc[k] += m * r[base - k];
+    }
+    for (uint32_t k = base + 1; k < lags; k++) {
+        acc[k] += m * r[base + lags - k];
+    }
+    de->accumulated++;
+}
+
+bool delay_est_feed(delay_est_handle_t de, const int16_t *mic, const int16_t *ref, size_t n)
+{
+    if (!de || !mic || !ref) {
+        return false;
+    }
+
+    for (size_t i = 0; i < n && de->accumulated < de->window_dec; i++) {
+        de->mic_sum += mic[i];
+        de->ref_sum += ref[i];
+        if (++de->phase == DELAY_EST_DECIMATE) {
+            // 组内平均作为抗混叠低通
+            delay_est_push(de, (int16_t)(de->mic_sum / DELAY_EST_DECIMATE),
+                           (int16_t)(de->ref_sum / DELAY_EST_DECIMATE));
+            de->mic_sum = 0;
+            de->ref_sum = 0;
+            de->phase = 0;
+        }
+    }
+    return de->accumulated >= de->window_dec;
+}
+
+bool delay_est_get_result(delay_est_handle_t de, delay_est_result_t *result)
+{
+    if (!de || !result || de->accumulated == 0) {
+        return false;
+    }
+
+    const uint32_t lags = 2 * de->max_lag_dec + 1;
+    uint32_t peak = 0;
+    double peak_abs = 0;
+    double sum_sq = 0;
+    for (uint32_t k = 0; k < lags; k++) {
+        double v = fabs((double)de->acc[k]);
+        sum_sq += v * v;
+        if (v > peak_abs) {
+            peak_abs = v;
+            peak = k;
+        }
+    }
+
+    double rms = sqrt(sum_sq / lags);
+    result->confidence = rms > 0 ? (float)(peak_abs / rms) : 0.0f;
+
+    // 抛物线插值求亚采样峰位置
+    double offset = 0;
+    if (peak > 0 && peak + 1 < lags) {
+        double ym = fabs((double)de->acc[peak - 1]);
+        double yp = fabs((double)de->acc[peak + 1]);
+        double denom = ym - 2 * peak_abs + yp;
+        if (denom < 0) {
+            offset = 0.5 * (ym - yp) / denom;
+        }
+    }
+    result->lag = (int32_t)lround(((double)peak + offset - de->max_lag_dec) * DELAY_EST_DECIMATE);
+
+    return de->accumulated >= de->window_dec && result->confidence >= de->min_confidence;
+}
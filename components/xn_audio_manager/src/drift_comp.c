@@ -0,0 +1,165 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\drift_comp.c
+ * @Description: 时钟漂移补偿实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "drift_comp.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DRIFT_COMP_ONE_Q32          (1ULL << 32)     ///< 相位 1.0（Q32）
+#define DRIFT_COMP_DAMPING          0.7f             ///< PI 环路阻尼比
+#define DRIFT_COMP_DEFAULT_MAX_PPM  1000.0f
+#define DRIFT_COMP_DEFAULT_BW_HZ    0.008f
+#define DRIFT_COMP_DEFAULT_TC_S     4.0f
+
+/**
+ * @brief 漂移补偿器结构体
+ *
+ * 控制环路：水位变化率 = fs * 1e-6 * (实际偏差 - 补偿量)，
+ * 补偿量 = kp * 误差 + 积分项，按给定自然频率和阻尼比求出 kp/ki。
+ * 重采样相位用 Q32 定点累加，1 ppm 约 4295 LSB，长时间运行也不会累积舍入误差。
+ */
+struct drift_comp_s {
+    uint32_t sample_rate;   ///< 采样率
+    float max_ppm;          ///< 补偿量上限
+    float kp;               ///< 比例增益（ppm / 采样点）
+    float ki;               ///< 积分增益（ppm / (采样点·秒)）
+    float fill_tc_s;        ///< 水位低通时间常数
+
+    bool locked;            ///< 是否已确定目标水位
+    float fill_avg;         ///< 低通后的水位
+    float target;           ///< 目标水位（锁定时的水位）
+    float integ;            ///< 积分项（ppm）
+    float ppm;              ///< 当前补偿量
+
+    uint64_t step_q32;      ///< 每个输出采样点的输入步长（Q32）
+    uint64_t mu_q32;        ///< 当前插值相位（Q32，>= 1.0 时需要移入新输入）
+    int16_t hist[4];        ///< 插值窗口，在 hist[1] 和 hist[2] 之间插值
+};
+
+static inline float drift_comp_clamp(float v, float limit)
+{
+    return v > limit ? limit : (v < -limit ? -limit : v);
+}
+
+drift_comp_handle_t drift_comp_create(const drift_comp_config_t *config)
+{
+    drift_comp_handle_t dc = (drift_comp_handle_t)calloc(1, sizeof(struct drift_comp_s));
+    if (!dc) {
+        return NULL;
+    }
+
+    drift_comp_config_t cfg = config ? *config : (drift_comp_config_t){0};
+    dc->sample_rate = cfg.sample_rate ? cfg.sample_rate : 16000;
+    dc->max_ppm = cfg.max_ppm > 0 ? cfg.max_ppm : DRIFT_COMP_DEFAULT_MAX_PPM;
+    dc->fill_tc_s = cfg.fill_time_constant_s > 0 ? cfg.fill_time_constant_s : DRIFT_COMP_DEFAULT_TC_S;
+
+    // 对象增益：1 ppm 的偏差使水位每秒变化 fs * 1e-6 个采样点
+    float plant = dc->sample_rate * 1e-6f;
+    float wn = 2.0f * (float)M_PI *
+               (cfg.loop_bandwidth_hz > 0 ? cfg.loop_bandwidth_hz : DRIFT_COMP_DEFAULT_BW_HZ);
+    dc->kp = 2.0f * DRIFT_COMP_DAMPING * wn / plant;
+    dc->ki = wn * wn / plant;
+
+    dc->step_q32 = DRIFT_COMP_ONE_Q32;
+    return dc;
+}
+
+void drift_comp_destroy(drift_comp_handle_t dc)
+{
+    free(dc);
+}
+
+void drift_comp_relock(drift_comp_handle_t dc)
+{
+    if (!dc) {
+        return;
+    }
+
+    dc->locked = false;
+    dc->mu_q32 = 0;
+    memset(dc->hist, 0, sizeof(dc->hist));
+}
+
+void drift_comp_update(drift_comp_handle_t dc, float fill, size_t elapsed)
+{
+    if (!dc) {
+        return;
+    }
+
+    if (!dc->locked) {
+        dc->fill_avg = fill;
+        dc->target = fill;
+        dc->locked = true;
+    } else {
+        float dt = (float)elapsed / dc->sample_rate;
+        dc->fill_avg += dt / (dc->fill_tc_s + dt) * (fill - dc->fill_avg);
+
+        // 水位高于目标说明回采写入快于取出（扬声器时钟快），需要多消耗
+        float err = dc->fill_avg - dc->target;
+        dc->integ = drift_comp_clamp(dc->integ + dc->ki * err * dt, dc->max_ppm);
+        dc->ppm = drift_comp_clamp(dc->kp * err + dc->integ, dc->max_ppm);
+    }
+
+    dc->step_q32 = DRIFT_COMP_ONE_Q32 + (int64_t)llroundf(dc->ppm * (DRIFT_COMP_ONE_Q32 * 1e-6f));
+}
+
+/**
+ * @brief 4 点三次插值（Catmull-Rom），mu 为 hist[1] 到 hist[2] 之间的位置
+ */
+static inline int16_t drift_comp_interp(const int16_t *w, float mu)
+{
+    float w0 = w[0], w1 = w[1], w2 = w[2], w3 = w[3];
+    float y = w1 + 0.5f * mu * (w2 - w0 +
+                                mu * (2.0f * w0 - 5.0f * w1 + 4.0f * w2 - w3 +
+                                      mu * (3.0f * (w1 - w2) + w3 - w0)));
+    long v = lrintf(y);
+    return (int16_t)(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+}
+
+size_t drift_comp_process(drift_comp_handle_t dc, const int16_t *in, size_t in_len,
+                          int16_t *out, size_t out_len, size_t *produced)
+{
+    size_t consumed = 0;
+    size_t n = 0;
+
+    if (!dc || !in || !out) {
+        if (produced) *produced = 0;
+        return 0;
+    }
+
+    while (n < out_len) {
+        // 相位越过 1.0 时移入新输入，输入不足则保留相位等待下一段
+        while (dc->mu_q32 >= DRIFT_COMP_ONE_Q32) {
+            if (consumed >= in_len) {
+                goto done;
+            }
+            dc->hist[0] = dc->hist[1];
+            dc->hist[1] = dc->hist[2];
+            dc->hist[2] = dc->hist[3];
+            dc->hist[3] = in[consumed++];
+            dc->mu_q32 -= DRIFT_COMP_ONE_Q32;
+        }
+
+        float mu = (float)(dc->mu_q32 >> 8) * (1.0f / 16777216.0f);  // 取高 24 位
+        out[n++] = drift_comp_interp(dc->hist, mu);
+        dc->mu_q32 += dc->step_q32;
+    }
+
+done:
+    if (produced) *produced = n;
+    return consumed;
+}
+
+float drift_comp_get_ppm(drift_comp_handle_t dc)
+{
+    return dc ? dc->ppm : 0.0f;
+}
@@ -9,33 +9,133 @@
  * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved. 
  */
 #include "i2s_hal.h"
+#include "pcm_kernels.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <math.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <stdlib.h>
 
 static const char *TAG = "I2S_HAL";
 
+#define I2S_HAL_TX_BUFFERS       2      ///< 立体声转换缓冲区数量（乒乓）
+#define I2S_HAL_TX_TASK_STACK    (3 * 1024)
+#define I2S_HAL_TX_TASK_PRIORITY 8      ///< 高于播放任务，缓冲区转换完成后尽快送入 DMA
+#define I2S_HAL_TX_TASK_CORE     1
+
+#define I2S_HAL_MIC_SHIFT_MIN    12     ///< 右移位数下限（增益最大）
+#define I2S_HAL_MIC_SHIFT_MAX    16     ///< 右移位数上限（增益最小）
+#define I2S_HAL_MIC_WINDOW_MS    250    ///< 电平统计窗口
+#define I2S_HAL_MIC_LOUD_PEAK    29491  ///< 峰值超过约 -1 dBFS（或出现截断）立即增大右移
+#define I2S_HAL_MIC_QUIET_PEAK   8192   ///< 峰值低于 -12 dBFS 的窗口计为安静窗口
+#define I2S_HAL_MIC_RELEASE_WINDOWS 8   ///< 连续安静窗口数（约 2 秒）后减小右移
+
+/** 待写入 I2S 的立体声块 */
+typedef struct {
+    int16_t *data;                  ///< 立体声数据（指向某个转换缓冲区），NULL 为退出消息
+    size_t bytes;                   ///< 字节数
+    uint32_t gen;                   ///< 提交时的清空代数，与当前代数不同的块直接丢弃
+} i2s_hal_tx_block_t;
+
 /**
  * @brief I2S HAL 上下文结构体
  * 
  * 存储 I2S 硬件抽象层的所有状态信息，包括：
  * - TX 和 RX 通道句柄
- * - 立体声转换缓冲区（用于单声道到立体声的转换）
+ * - 两个立体声转换缓冲区（乒乓）和 TX 任务：转换下一块的同时 TX 任务写入上一块
  * - 麦克风临时缓冲区（预分配，避免频繁 malloc/free）
  */
 typedef struct i2s_hal_s {
     i2s_chan_handle_t tx_handle;    ///< 扬声器（TX）通道句柄
     i2s_chan_handle_t rx_handle;    ///< 麦克风（RX）通道句柄
-    int16_t *stereo_buffer;         ///< 立体声转换缓冲区（PSRAM），用于单声道到立体声转换
-    size_t stereo_buffer_size;      ///< 立体声缓冲区大小（采样点数）
+    int16_t *stereo_buffer[I2S_HAL_TX_BUFFERS];  ///< 立体声转换缓冲区（PSRAM），轮流使用
+    size_t stereo_buffer_size;      ///< 每个立体声缓冲区可容纳的单声道采样点数（即分块大小）
+    QueueHandle_t tx_queue;         ///< 待写入块队列（按提交顺序写入）
+    QueueHandle_t tx_free;          ///< 空闲转换缓冲区队列（元素为缓冲区指针）
+    atomic_uint tx_flush_gen;       ///< 清空代数，每次 i2s_hal_flush_speaker 加一
+    TaskHandle_t tx_task;           ///< TX 任务句柄
+    SemaphoreHandle_t tx_exit;      ///< TX 任务处理完退出消息后释放
+    volatile esp_err_t tx_error;    ///< TX 任务最近一次写入错误（在下一次写入时返回）
+    atomic_size_t tx_pending;       ///< 已提交但尚未送入 DMA 的单声道采样点数
     int32_t *mic_temp_buffer;       ///< 麦克风临时缓冲区（PSRAM），用于32位数据读取
     size_t mic_temp_buffer_size;    ///< 麦克风临时缓冲区大小（采样点数）
-    uint8_t mic_bit_shift;          ///< 32位转16位的右移位数（默认14，可调12-16）
+    volatile uint8_t mic_bit_shift; ///< 32位转16位的右移位数（默认14，可调12-16）
+    uint32_t mic_clipped;           ///< 转换时被饱和截断的累计采样点数
+    bool mic_auto_gain;             ///< 是否自动量程
+    uint32_t mic_window_samples;    ///< 电平统计窗口长度（采样点数）
+    uint32_t mic_window_count;      ///< 当前窗口已统计的采样点数
+    int32_t mic_window_peak;        ///< 当前窗口峰值
+    uint64_t mic_window_energy;     ///< 当前窗口平方和
+    uint8_t mic_quiet_windows;      ///< 连续安静窗口数
+    int32_t mic_peak;               ///< 上一个完整窗口的峰值
+    int32_t mic_rms;                ///< 上一个完整窗口的 RMS
+    uint32_t mic_shift_changes;     ///< 自动量程调整次数
+    int32_t speaker_gain_q15;       ///< 当前扬声器增益（Q15）
+    uint8_t speaker_volume;         ///< 当前增益对应的音量（0-100）
 } i2s_hal_t;
 
+/**
+ * @brief 将音量（0-100）换算为 Q15 增益
+ * 
+ * 线性映射（音量 / 100），音量 100 为单位增益，0 为静音；只在音量变化时计算一次。
+ */
+static int32_t i2s_hal_volume_to_q15(uint8_t volume)
+{
+    if (volume >= 100) {
+        return PCM_GAIN_Q15_UNITY;
+    }
+    return (int32_t)volume * PCM_GAIN_Q15_UNITY / 100;
+}
+
+/**
+ * @brief I2S TX 任务
+ * 
+ * 按提交顺序把转换好的立体声块写入 I2S（阻塞直到 DMA 有空间），
+ * 写完后归还对应的转换缓冲区。调用者因此可以在本块写入期间转换下一块。
+ * 清空之前提交的块（代数过期）不写入，直接归还。
+ * 收到退出消息（data 为 NULL）时，之前提交的块都已写完，释放 tx_exit 后删除自身。
+ * 
+ * @param arg I2S HAL 上下文指针
+ */
+static void i2s_hal_tx_task(void *arg)
+{
+    i2s_hal_t *hal = (i2s_hal_t *)arg;
+    i2s_hal_tx_block_t block;
+
+    while (1) {
+        if (xQueueReceive(hal->tx_queue, &block, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (!block.data) {
+            break;
+        }
+
+        if (block.gen == atomic_load(&hal->tx_flush_gen)) {
+            size_t written = 0;
+            esp_err_t ret = i2s_channel_write(hal->tx_handle, block.data, block.bytes,
+                                              &written, portMAX_DELAY);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "❌ I2S 写入失败: %s (期望%d字节)", esp_err_to_name(ret), block.bytes);
+                hal->tx_error = ret;
+            } else if (written < block.bytes) {
+                ESP_LOGW(TAG, "⚠️ I2S 写入不完整: 期望%d, 实际%d", block.bytes, written);
+            }
+        }
+        atomic_fetch_sub(&hal->tx_pending, block.bytes / (2 * sizeof(int16_t)));
+
+        xQueueSend(hal->tx_free, &block.data, 0);
+    }
+
+    xSemaphoreGive(hal->tx_exit);
+    vTaskDelete(NULL);
+}
+
 /**
  * @brief 创建 I2S HAL 实例
  * 
@@ -188,37 +288,59 @@ i2s_hal_handle_t i2s_hal_create(const i2s_mic_config_t *mic_config,
         return NULL;
     }
 
-    // 保存右移位数配置
-    hal->mic_bit_shift = (mic_config->bit_shift >= 12 && mic_config->bit_shift <= 16) ? 
+    // 保存右移位数配置（自动量程时作为初始值）
+    hal->mic_bit_shift = (mic_config->bit_shift >= I2S_HAL_MIC_SHIFT_MIN &&
+                          mic_config->bit_shift <= I2S_HAL_MIC_SHIFT_MAX) ?
                           mic_config->bit_shift : 14;  // 默认 14
+    hal->mic_auto_gain = mic_config->auto_gain;
+    hal->mic_window_samples = (mic_config->sample_rate > 0 ? mic_config->sample_rate : 16000) *
+                              I2S_HAL_MIC_WINDOW_MS / 1000;
 
-    ESP_LOGI(TAG, "✅ 麦克风临时缓冲区初始化: %d samples (%.1f KB) at PSRAM, 右移 %d 位",
+    ESP_LOGI(TAG, "✅ 麦克风临时缓冲区初始化: %d samples (%.1f KB) at PSRAM, 右移 %d 位%s",
              hal->mic_temp_buffer_size,
              (hal->mic_temp_buffer_size * sizeof(int32_t)) / 1024.0f,
-             hal->mic_bit_shift);
+             hal->mic_bit_shift, hal->mic_auto_gain ? "（自动量程）" : "");
 
     // ========== 分配立体声转换缓冲区（PSRAM）==========
-    // 缓冲区大小：最大帧采样数 × 2（左右声道）× sizeof(int16_t)
+    // 每个缓冲区大小：分块采样数 × 2（左右声道）× sizeof(int16_t)
     hal->stereo_buffer_size = speaker_config->max_frame_samples;
-    hal->stereo_buffer = (int16_t *)heap_caps_malloc(
-        hal->stereo_buffer_size * 2 * sizeof(int16_t), 
-        MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);  // 使用 PSRAM 分配，节省内部 RAM
-    
-    if (!hal->stereo_buffer) {
-        ESP_LOGE(TAG, "立体声缓冲区分配失败");
-        // 清理已创建的资源
-        if (hal->mic_temp_buffer) heap_caps_free(hal->mic_temp_buffer);
-        i2s_channel_disable(hal->rx_handle);
-        i2s_del_channel(hal->rx_handle);
-        i2s_channel_disable(hal->tx_handle);
-        i2s_del_channel(hal->tx_handle);
-        free(hal);
+    for (int i = 0; i < I2S_HAL_TX_BUFFERS; i++) {
+        hal->stereo_buffer[i] = (int16_t *)heap_caps_malloc(
+            hal->stereo_buffer_size * 2 * sizeof(int16_t), 
+            MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);  // 使用 PSRAM 分配，节省内部 RAM
+        if (!hal->stereo_buffer[i]) {
+            ESP_LOGE(TAG, "立体声缓冲区分配失败");
+            i2s_hal_destroy(hal);
+            return NULL;
+        }
+    }
+
+    ESP_LOGI(TAG, "✅ 立体声缓冲区初始化: %d x %d samples (%.1f KB) at PSRAM",
+             I2S_HAL_TX_BUFFERS, hal->stereo_buffer_size * 2, 
+             (I2S_HAL_TX_BUFFERS * hal->stereo_buffer_size * 2 * sizeof(int16_t)) / 1024.0f);
+
+    // ========== 创建 TX 任务 ==========
+    hal->tx_queue = xQueueCreate(I2S_HAL_TX_BUFFERS, sizeof(i2s_hal_tx_block_t));
+    hal->tx_free = xQueueCreate(I2S_HAL_TX_BUFFERS, sizeof(int16_t *));
+    hal->tx_exit = xSemaphoreCreateBinary();
+    if (hal->tx_free) {
+        for (int i = 0; i < I2S_HAL_TX_BUFFERS; i++) {
+            xQueueSend(hal->tx_free, &hal->stereo_buffer[i], 0);
+        }
+    }
+    if (!hal->tx_queue || !hal->tx_free || !hal->tx_exit ||
+        xTaskCreatePinnedToCore(i2s_hal_tx_task, "i2s_tx", I2S_HAL_TX_TASK_STACK, hal,
+                                I2S_HAL_TX_TASK_PRIORITY, &hal->tx_task,
+                                I2S_HAL_TX_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "TX 任务创建失败");
+        hal->tx_task = NULL;
+        i2s_hal_destroy(hal);
         return NULL;
     }
 
-    ESP_LOGI(TAG, "✅ 立体声缓冲区初始化: %d samples (%.1f KB) at PSRAM",
-             hal->stereo_buffer_size * 2, 
-             (hal->stereo_buffer_size * 2 * sizeof(int16_t)) / 1024.0f);
+    // 增益在首次写入时按当时音量直接设定（不做斜坡）
+    hal->speaker_volume = UINT8_MAX;
+    hal->speaker_gain_q15 = 0;
 
     return hal;
 }
@@ -228,6 +350,7 @@ i2s_hal_handle_t i2s_hal_create(const i2s_mic_config_t *mic_config,
  * 
  * 释放所有分配的资源，包括：
  * - 禁用并删除 RX 和 TX 通道
+ * - 通过 TX 队列发送退出消息，等待 TX 任务写完已提交的块并确认退出
  * - 释放立体声转换缓冲区
  * - 释放 HAL 上下文内存
  * 
@@ -237,6 +360,23 @@ void i2s_hal_destroy(i2s_hal_handle_t hal)
 {
     if (!hal) return;
 
+    // 退出消息排在已提交的块之后：TX 任务确认时队列和转换缓冲区都已不再使用。
+    // TX 通道仍处于使能状态，已提交的块总能写完，因此无限等待确认
+    if (hal->tx_task) {
+        i2s_hal_tx_block_t exit_msg = { .data = NULL, .bytes = 0 };
+        xQueueSend(hal->tx_queue, &exit_msg, portMAX_DELAY);
+        xSemaphoreTake(hal->tx_exit, portMAX_DELAY);
+    }
+    if (hal->tx_exit) {
+        vSemaphoreDelete(hal->tx_exit);
+    }
+    if (hal->tx_queue) {
+        vQueueDelete(hal->tx_queue);
+    }
+    if (hal->tx_free) {
+        vQueueDelete(hal->tx_free);
+    }
+
     // 禁用并删除 RX 通道
     if (hal->rx_handle) {
         i2s_channel_disable(hal->rx_handle);
@@ -255,8 +395,10 @@ void i2s_hal_destroy(i2s_hal_handle_t hal)
     }
 
     // 释放立体声转换缓冲区（PSRAM）
-    if (hal->stereo_buffer) {
-        heap_caps_free(hal->stereo_buffer);
+    for (int i = 0; i < I2S_HAL_TX_BUFFERS; i++) {
+        if (hal->stereo_buffer[i]) {
+            heap_caps_free(hal->stereo_buffer[i]);
+        }
     }
 
     // 释放 HAL 上下文内存
@@ -264,6 +406,70 @@ void i2s_hal_destroy(i2s_hal_handle_t hal)
     ESP_LOGI(TAG, "I2S HAL 已销毁");
 }
 
+/**
+ * @brief 统计麦克风电平，自动量程时调整右移位数
+ * 
+ * 快攻慢放的迟滞控制，每次只调整 1 位（6 dB）：
+ * - 出现截断或峰值超过 I2S_HAL_MIC_LOUD_PEAK：立即增大右移，重新开始统计窗口
+ * - 连续 I2S_HAL_MIC_RELEASE_WINDOWS 个窗口峰值低于 I2S_HAL_MIC_QUIET_PEAK：减小右移
+ * 放大后的峰值仍低于 2 * I2S_HAL_MIC_QUIET_PEAK，远离衰减门限，不会来回振荡。
+ * 
+ * @param hal I2S HAL 上下文
+ * @param pcm 本次转换输出（16bit）
+ * @param n 采样点数
+ * @param clipped 本次转换的截断采样点数
+ */
+static void i2s_hal_mic_track_level(i2s_hal_t *hal, const int16_t *pcm, size_t n, size_t clipped)
+{
+    int32_t peak;
+    uint64_t energy;
+    pcm_s16_level(pcm, n, &peak, &energy);
+
+    if (peak > hal->mic_window_peak) {
+        hal->mic_window_peak = peak;
+    }
+    hal->mic_window_energy += energy;
+    hal->mic_window_count += n;
+
+    if (hal->mic_auto_gain && (clipped > 0 || peak >= I2S_HAL_MIC_LOUD_PEAK) &&
+        hal->mic_bit_shift < I2S_HAL_MIC_SHIFT_MAX) {
+        hal->mic_bit_shift++;
+        hal->mic_shift_changes++;
+        hal->mic_quiet_windows = 0;
+        hal->mic_window_peak = 0;
+        hal->mic_window_energy = 0;
+        hal->mic_window_count = 0;
+        ESP_LOGD(TAG, "麦克风过载（峰值 %d，截断 %d），右移增至 %d", (int)peak, (int)clipped,
+                 hal->mic_bit_shift);
+        return;
+    }
+
+    if (hal->mic_window_count < hal->mic_window_samples) {
+        return;
+    }
+
+    // 窗口结束：更新统计快照
+    hal->mic_peak = hal->mic_window_peak;
+    hal->mic_rms = (int32_t)sqrtf((float)(hal->mic_window_energy / hal->mic_window_count));
+
+    if (hal->mic_auto_gain && hal->mic_window_peak < I2S_HAL_MIC_QUIET_PEAK &&
+        hal->mic_bit_shift > I2S_HAL_MIC_SHIFT_MIN) {
+        if (++hal->mic_quiet_windows >= I2S_HAL_MIC_RELEASE_WINDOWS) {
+            hal->mic_bit_shift--;
+            hal->mic_shift_changes++;
+            hal->mic_quiet_windows = 0;
+            ESP_LOGD(TAG, "麦克风电平偏低（峰值 %d），右移减至 %d", (int)hal->mic_window_peak,
+                     hal->mic_bit_shift);
+        }
+    } else {
+        hal->mic_quiet_windows = 0;
+    }
+
+    hal->mic_window_peak = 0;
+    hal->mic_window_energy = 0;
+    hal->mic_window_count = 0;
+}
+
 /**
  * @brief 从麦克风读取音频数据
  * 
@@ -276,7 +482,7 @@ void i2s_hal_destroy(i2s_hal_handle_t hal)
  * @param out_got 实际读取的采样点数（可选）
  * @return esp_err_t ESP_OK 成功，其他值表示错误
  * 
- * @note 数据格式转换：32位右移可配置位数（默认14）得到16位数据
+ * @note 数据格式转换：32位右移可配置位数（默认14）得到16位数据，自动量程时动态调整
  * @note 根据 MSM261S4030H0R 数据手册：24-bit 有效数据在 32-bit 字中
  */
 esp_err_t i2s_hal_read_mic(i2s_hal_handle_t hal, int16_t *out_samples, 
@@ -302,10 +508,15 @@ esp_err_t i2s_hal_read_mic(i2s_hal_handle_t hal, int16_t *out_samples,
 
     // 将 32 位数据转换为 16 位
     // 根据数据手册：24-bit 有效数据 + 8-bit 低位填充
-    // 右移位数可配置，以适应不同的音量需求
+    // 右移位数可配置，以适应不同的音量需求；大音量时饱和截断而不是回绕
     size_t got = bytes_read / sizeof(int32_t);
-    for (size_t i = 0; i < got; i++) {
-        out_samples[i] = (int16_t)(hal->mic_temp_buffer[i] >> hal->mic_bit_shift);
+    size_t clipped = pcm_s32_to_s16_sat(out_samples, hal->mic_temp_buffer, got,
+                                        hal->mic_bit_shift);
+    hal->mic_clipped += clipped;
+
+    // 电平统计（自动量程时据此调整下一次读取的右移位数）
+    if (got > 0) {
+        i2s_hal_mic_track_level(hal, out_samples, got, clipped);
     }
 
     if (out_got) *out_got = got;
@@ -315,61 +526,198 @@ esp_err_t i2s_hal_read_mic(i2s_hal_handle_t hal, int16_t *out_samples,
 /**
  * @brief 向扬声器写入音频数据
  * 
- * 将单声道音频数据转换为立体声并写入 I2S TX 通道。
- * 支持音量控制（0-100）。
+ * 将单声道音频数据转换为立体声并交给 TX 任务写入 I2S TX 通道。
+ * 支持任意长度：内部按 stereo_buffer_size 分块，两个转换缓冲区轮流使用，
+ * 第 N+1 块的转换与第 N 块的 I2S 写入重叠进行。
+ * 写入期间被 i2s_hal_flush_speaker 清空时放弃剩余数据并返回。
+ * 支持音量控制（0-100），音量变化时在第一块内线性过渡到新增益，避免咔哒声。
  * 
  * @param hal I2S HAL 句柄
  * @param samples 输入音频数据（16位单声道）
- * @param sample_count 采样点数
+ * @param sample_count 采样点数（任意长度）
  * @param volume 音量（0-100）
- * @return esp_err_t ESP_OK 成功，其他值表示错误
+ * @return esp_err_t ESP_OK 成功，其他值表示错误（包括之前异步写入的错误）
  * 
+ * @note 返回时数据已全部转换并提交（samples 可以立即复用），
+ *       但最后至多两块可能仍在 TX 队列中（见 i2s_hal_get_speaker_pending）；同一时刻只允许一个任务调用
  * @note 转换过程：
- *       1. 检查缓冲区大小
- *       2. 应用音量控制
- *       3. 单声道复制到左右声道
- *       4. 写入 I2S TX 通道
+ *       1. 音量变化时重新计算 Q15 增益
+ *       2. 等待一个空闲的转换缓冲区（期间被清空则放弃剩余数据）
+ *       3. 融合内核：应用增益（或斜坡）并复制到左右声道
+ *       4. 提交给 TX 任务写入 I2S TX 通道
  */
 esp_err_t i2s_hal_write_speaker(i2s_hal_handle_t hal, const int16_t *samples, 
                                  size_t sample_count, uint8_t volume)
 {
     // 参数有效性检查
-    if (!hal || !hal->tx_handle || !samples || !hal->stereo_buffer) {
+    if (!hal || !hal->tx_handle || !samples || !hal->tx_task) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 防止缓冲区溢出：检查采样点数是否超过缓冲区大小
-    if (sample_count > hal->stereo_buffer_size) {
-        ESP_LOGE(TAG, "❌ 样本数超出限制: %d > %d", sample_count, hal->stereo_buffer_size);
+    // 音量变化时重新计算目标增益（dB -> 线性只在此处计算一次）
+    if (volume > 100) {
+        volume = 100;
+    }
+    int32_t gain_start = hal->speaker_gain_q15;
+    if (volume != hal->speaker_volume) {
+        int32_t target = i2s_hal_volume_to_q15(volume);
+        if (hal->speaker_volume == UINT8_MAX) {
+            gain_start = target;  // 首次写入，直接使用目标增益
+        }
+        hal->speaker_volume = volume;
+        hal->speaker_gain_q15 = target;
+    }
+
+    uint32_t gen = atomic_load(&hal->tx_flush_gen);
+    size_t offset = 0;
+    while (offset < sample_count) {
+        size_t n = sample_count - offset;
+        if (n > hal->stereo_buffer_size) {
+            n = hal->stereo_buffer_size;
+        }
+
+        // 等待一个空闲的转换缓冲区；等待期间被清空（停止播放）则放弃剩余数据
+        int16_t *stereo;
+        xQueueReceive(hal->tx_free, &stereo, portMAX_DELAY);
+        if (atomic_load(&hal->tx_flush_gen) != gen) {
+            xQueueSend(hal->tx_free, &stereo, 0);
+            break;
+        }
+
+        // 单声道 -> 立体声转换，并应用增益（音量变化时只在第一块内线性过渡）
+        pcm_mono_to_stereo_gain_q15(stereo, samples + offset, n,
+                                    gain_start, hal->speaker_gain_q15);
+        gain_start = hal->speaker_gain_q15;
+
+        // 提交给 TX 任务，随即开始转换下一块
+        i2s_hal_tx_block_t block = {
+            .data = stereo,
+            .bytes = n * 2 * sizeof(int16_t),  // 立体声字节数
+            .gen = gen,
+        };
+        atomic_fetch_add(&hal->tx_pending, n);
+        xQueueSend(hal->tx_queue, &block, portMAX_DELAY);
+        offset += n;
+    }
+
+    // 报告 TX 任务异步写入中出现的错误
+    esp_err_t ret = hal->tx_error;
+    hal->tx_error = ESP_OK;
+    return ret;
+}
+
+/**
+ * @brief 丢弃已提交但尚未送入 DMA 的扬声器数据
+ * 
+ * 清空代数加一后取出 TX 队列中的块并归还转换缓冲区：
+ * 正在等待空闲缓冲区的写入随即被唤醒并放弃剩余数据，
+ * TX 任务之后取到的旧代数块也直接丢弃。已送入 DMA 的数据照常播完（auto_clear 之后输出静音）。
+ * 
+ * @param hal I2S HAL 句柄
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ * 
+ * @note 可以在写入任务之外的任务中调用，但不能与 i2s_hal_destroy 并发
+ */
+esp_err_t i2s_hal_flush_speaker(i2s_hal_handle_t hal)
+{
+    if (!hal || !hal->tx_task) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 单声道 -> 立体声转换，并应用音量控制
-    // 音量因子：将 0-100 映射到 0.0-1.0
-    float factor = (volume > 100 ? 100 : volume) / 100.0f;
-    for (size_t i = 0; i < sample_count; i++) {
-        int16_t v = (int16_t)(samples[i] * factor);  // 应用音量
-        hal->stereo_buffer[i * 2] = v;      // Left 声道
-        hal->stereo_buffer[i * 2 + 1] = v;  // Right 声道
+    atomic_fetch_add(&hal->tx_flush_gen, 1);
+
+    i2s_hal_tx_block_t block;
+    while (xQueueReceive(hal->tx_queue, &block, 0) == pdTRUE) {
+        atomic_fetch_sub(&hal->tx_pending, block.bytes / (2 * sizeof(int16_t)));
+        xQueueSend(hal->tx_free, &block.data, 0);
     }
+    return ESP_OK;
+}
 
-    // 写入 I2S TX 通道
-    size_t written = 0;
-    size_t bytes_to_write = sample_count * 2 * sizeof(int16_t);  // 立体声字节数
-    esp_err_t ret = i2s_channel_write(hal->tx_handle, hal->stereo_buffer, 
-                                      bytes_to_write, &written, portMAX_DELAY);
+/**
+ * @brief 获取已提交但尚未送入 DMA 的采样点数
+ * 
+ * 写入前调用：新数据要等这些采样点送入 DMA 后才会送入，
+ * 调用者据此把回采时间戳推迟到新数据实际送入 DMA 的时刻
+ * 
+ * @param hal I2S HAL 句柄
+ * @return 单声道采样点数，hal 为 NULL 时返回 0
+ */
+size_t i2s_hal_get_speaker_pending(i2s_hal_handle_t hal)
+{
+    return hal ? atomic_load(&hal->tx_pending) : 0;
+}
 
-    // 检查写入结果
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "❌ I2S 写入失败: %s (期望%d字节)", esp_err_to_name(ret), bytes_to_write);
-        return ret;
+/**
+ * @brief 获取麦克风转换时被饱和截断的累计采样点数
+ * 
+ * @param hal I2S HAL 句柄
+ * @return uint32_t 累计截断采样点数，hal 为 NULL 时返回 0
+ */
+uint32_t i2s_hal_get_mic_clip_count(i2s_hal_handle_t hal)
+{
+    return hal ? hal->mic_clipped : 0;
+}
+
+/**
+ * @brief 获取麦克风电平统计
+ * 
+ * @param hal I2S HAL 句柄
+ * @param level 输出统计（峰值/RMS 为最近一个完整统计窗口的值）
+ * @return 
+ *     - ESP_OK: 获取成功
+ *     - ESP_ERR_INVALID_ARG: 参数无效
+ */
+esp_err_t i2s_hal_get_mic_level(i2s_hal_handle_t hal, i2s_mic_level_t *level)
+{
+    if (!hal || !level) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    level->bit_shift = hal->mic_bit_shift;
+    level->peak = hal->mic_peak;
+    level->rms = hal->mic_rms;
+    level->clipped = hal->mic_clipped;
+    level->shift_changes = hal->mic_shift_changes;
+    return ESP_OK;
+}
+
+/**
+ * @brief 按实际读取块大小重新分配麦克风临时缓冲区
+ * 
+ * 上层（AFE）的读取块大小在运行时才能确定，按它分配可避免请求超出缓冲区而读取失败，
+ * 也不会多占 PSRAM。
+ * 
+ * @param hal I2S HAL 句柄
+ * @param samples 单次读取的最大采样点数
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 分配失败（原缓冲区保持不变）
+ * 
+ * @note 与 i2s_hal_read_mic 不加锁，只能由读取麦克风的任务调用（或在开始读取前调用）
+ */
+esp_err_t i2s_hal_set_mic_frame_samples(i2s_hal_handle_t hal, size_t samples)
+{
+    if (!hal || samples == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (samples == hal->mic_temp_buffer_size && hal->mic_temp_buffer) {
+        return ESP_OK;
+    }
+
+    int32_t *buffer = (int32_t *)heap_caps_malloc(samples * sizeof(int32_t),
+                                                  MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buffer) {
+        ESP_LOGE(TAG, "麦克风临时缓冲区分配失败: %d samples", samples);
+        return ESP_ERR_NO_MEM;
     }
 
-    // 检查是否完整写入
-    if (written < bytes_to_write) {
-        ESP_LOGW(TAG, "⚠️ I2S 写入不完整: 期望%d, 实际%d", bytes_to_write, written);
+    if (hal->mic_temp_buffer) {
+        heap_caps_free(hal->mic_temp_buffer);
     }
+    hal->mic_temp_buffer = buffer;
+    hal->mic_temp_buffer_size = samples;
 
+    ESP_LOGI(TAG, "麦克风临时缓冲区调整为 %d samples (%.1f KB)",
+             samples, (samples * sizeof(int32_t)) / 1024.0f);
     return ESP_OK;
 }
 
@@ -0,0 +1,220 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\pcm_kernels.c
+ * @Description: PCM 转换内核实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "pcm_kernels.h"
+
+/**
+ * @brief 常量移位的饱和窄化实现
+ *
+ * 循环体无分支（钳位用比较选择，截断计数为简单归约），没有跨迭代依赖，
+ * 移位量为编译期常量，编译器可展开并映射到 SIMD/条件移动指令
+ */
+static inline __attribute__((always_inline))
+size_t pcm_narrow_const(int16_t *restrict dst, const int32_t *restrict src, size_t n,
+                        const unsigned shift)
+{
+    uint32_t clipped = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = src[i] >> shift;
+        int32_t c = v > INT16_MAX ? INT16_MAX : v;
+        c = c < INT16_MIN ? INT16_MIN : c;
+        clipped += (uint32_t)(c != v);
+        dst[i] = (int16_t)c;
+    }
+
+    return clipped;
+}
+
+#define PCM_DEFINE_NARROW(s)                                                        \
+    static size_t pcm_narrow_s##s(int16_t *dst, const int32_t *src, size_t n)      \
+    {                                                                               \
+        return pcm_narrow_const(dst, src, n, s);                                    \
+    }
+
+PCM_DEFINE_NARROW(12)
+PCM_DEFINE_NARROW(13)
+PCM_DEFINE_NARROW(14)
+PCM_DEFINE_NARROW(15)
+PCM_DEFINE_NARROW(16)
+
+/**
+ * @brief 32bit 转 16bit：算术右移后饱和截断
+ *
+ * 原实现直接强转 int16_t，大音量时高位被丢弃导致回绕（正峰变负峰），
+ * 这里改为饱和截断并返回截断数量，供上层统计削波或调整增益。
+ *
+ * @param dst 输出（16bit）
+ * @param src 输入（32bit）
+ * @param n 采样点数
+ * @param shift 右移位数（超过 31 时按 31 处理）
+ *
+ * @return 被饱和截断的采样点数
+ */
+size_t pcm_s32_to_s16_sat(int16_t *dst, const int32_t *src, size_t n, unsigned shift)
+{
+    switch (shift) {
+    case 12: return pcm_narrow_s12(dst, src, n);
+    case 13: return pcm_narrow_s13(dst, src, n);
+    case 14: return pcm_narrow_s14(dst, src, n);
+    case 15: return pcm_narrow_s15(dst, src, n);
+    case 16: return pcm_narrow_s16(dst, src, n);
+    default:
+        break;
+    }
+
+    if (shift > 31) {
+        shift = 31;
+    }
+    return pcm_narrow_const(dst, src, n, shift);
+}
+
+/**
+ * @brief 逐样本参考实现
+ *
+ * 与 pcm_s32_to_s16_sat 结果逐位一致，仅用于校验和性能对比。
+ */
+size_t pcm_s32_to_s16_sat_ref(int16_t *dst, const int32_t *src, size_t n, unsigned shift)
+{
+    size_t clipped = 0;
+
+    if (shift > 31) {
+        shift = 31;
+    }
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = src[i] >> shift;
+        if (v > INT16_MAX) {
+            v = INT16_MAX;
+            clipped++;
+        } else if (v < INT16_MIN) {
+            v = INT16_MIN;
+            clipped++;
+        }
+        dst[i] = (int16_t)v;
+    }
+    return clipped;
+}
+
+/**
+ * @brief 统计 16bit 数据的峰值和能量
+ *
+ * 两个独立归约（最大值、平方和），无分支，编译器可向量化。
+ * 16bit 平方最大 2^30，n 小于 2^33 时 64 位累加不会溢出。
+ *
+ * @param src 输入（16bit）
+ * @param n 采样点数
+ * @param peak 输出峰值绝对值（0-32768）
+ * @param energy 输出平方和
+ */
+void pcm_s16_level(const int16_t *src, size_t n, int32_t *peak, uint64_t *energy)
+{
+    int32_t max_abs = 0;
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = src[i];
+        int32_t a = v < 0 ? -v : v;
+        max_abs = a > max_abs ? a : max_abs;
+        sum += (uint64_t)(v * v);
+    }
+
+    *peak = max_abs;
+    *energy = sum;
+}
+
+/**
+ * @brief 将增益限制在 [0, PCM_GAIN_Q15_UNITY]
+ *
+ * 在此范围内 (x * g + 0x4000) >> 15 不会超出 int16，乘加后无需饱和
+ */
+static inline int32_t pcm_clamp_gain(int32_t g)
+{
+    return g < 0 ? 0 : (g > PCM_GAIN_Q15_UNITY ? PCM_GAIN_Q15_UNITY : g);
+}
+
+/**
+ * @brief 单声道转立体声并应用 Q15 增益
+ *
+ * 原实现每个采样点做一次浮点乘法并分别写左右声道。这里：
+ * - 增益为 Q15 定点数，乘法后加 0x4000 舍入再右移
+ * - 单声道复制到左右声道与增益在同一个循环内完成
+ * - 斜坡增益用 Q16 小数累加器逐点递增，避免音量突变产生咔哒声
+ *
+ * @param dst 输出（交织立体声）
+ * @param src 输入（单声道）
+ * @param n 单声道采样点数
+ * @param gain_start 起始增益（Q15）
+ * @param gain_end 结束增益（Q15）
+ */
+void pcm_mono_to_stereo_gain_q15(int16_t *dst, const int16_t *src, size_t n,
+                                 int32_t gain_start, int32_t gain_end)
+{
+    gain_start = pcm_clamp_gain(gain_start);
+    gain_end = pcm_clamp_gain(gain_end);
+
+    if (gain_start == gain_end) {
+        const int32_t g = gain_end;
+        if (g == PCM_GAIN_Q15_UNITY) {
+            for (size_t i = 0; i < n; i++) {
+                dst[2 * i] = src[i];
+                dst[2 * i + 1] = src[i];
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                int16_t v = (int16_t)((src[i] * g + 0x4000) >> 15);
+                dst[2 * i] = v;
+                dst[2 * i + 1] = v;
+            }
+        }
+        return;
+    }
+
+    if (n == 0) {
+        return;
+    }
+
+    // Q16 小数累加：第 i 个采样点的增益为 gain_start + (i + 1) * step。
+    // 增益上限 PCM_GAIN_Q15_UNITY << 16 = 2^31 超出 int32_t，用无符号累加（负步长按模回绕），
+    // 累加值始终落在 [0, 2^31] 内，右移结果与参考实现的 64 位计算一致
+    int32_t step = (int32_t)((int64_t)(gain_end - gain_start) * 65536 / (int64_t)n);
+    uint32_t acc = (uint32_t)gain_start << 16;
+    for (size_t i = 0; i + 1 < n; i++) {
+        acc += (uint32_t)step;
+        int16_t v = (int16_t)((src[i] * (int32_t)(acc >> 16) + 0x4000) >> 15);
+        dst[2 * i] = v;
+        dst[2 * i + 1] = v;
+    }
+
+    // 最后一个采样点精确落在目标增益上，消除累加误差
+    int16_t last = (int16_t)((src[n - 1] * gain_end + 0x4000) >> 15);
+    dst[2 * (n - 1)] = last;
+    dst[2 * (n - 1) + 1] = last;
+}
+
+/**
+ * @brief 逐样本参考实现
+ *
+ * 直接按下标计算每个采样点的增益，与 pcm_mono_to_stereo_gain_q15 逐位一致。
+ */
+void pcm_mono_to_stereo_gain_q15_ref(int16_t *dst, const int16_t *src, size_t n,
+                                     int32_t gain_start, int32_t gain_end)
+{
+    gain_start = pcm_clamp_gain(gain_start);
+    gain_end = pcm_clamp_gain(gain_end);
+
+    int32_t step = n ? (int32_t)((int64_t)(gain_end - gain_start) * 65536 / (int64_t)n) : 0;
+    for (size_t i = 0; i < n; i++) {
+        int32_t g = (i + 1 == n) ? gain_end
+                                 : (int32_t)((((int64_t)gain_start << 16) + (int64_t)(i + 1) * step) >> 16);
+        int32_t v = ((int32_t)src[i] * g + 0x4000) >> 15;
+        dst[2 * i] = (int16_t)v;
+        dst[2 * i + 1] = (int16_t)v;
+    }
+}
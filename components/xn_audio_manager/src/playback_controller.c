@@ -10,13 +10,29 @@
  */
 #include "playback_controller.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/ringbuf.h"
+#include "esp_heap_caps.h"
+#include "resampler.h"
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "PLAYBACK_CTRL";
 
+#define PLAYBACK_TASK_STACK         (5 * 1024)
+#define PLAYBACK_TASK_PRIO          7
+#define PLAYBACK_TASK_CORE          1
+#define PLAYBACK_STOP_TIMEOUT_MS    50      ///< 停止时等待播放任务回到空闲的最长时间
+#define PLAYBACK_EXIT_TIMEOUT_MS    500     ///< 销毁时等待播放任务退出的最长时间
+#define PLAYBACK_DECODE_AHEAD       2       ///< 播放缓冲区中提前解码的帧数（以 frame_samples 计）
+#define PLAYBACK_DECODE_MAX_SAMPLES 5760    ///< 解码缓冲区容量（48kHz 下 120ms 的 Opus 包，也可容纳 1020 字节的 ADPCM 块）
+#define PLAYBACK_RESAMPLE_CHUNK     256     ///< 每次重采样的输入采样点数
+#define PLAYBACK_LOG_INTERVAL_MS    1000    ///< 播放任务中同类错误日志的最短间隔
+
 /**
  * @brief 播放控制器上下文结构体
  * 
@@ -26,62 +42,294 @@ typedef struct playback_controller_s {
     audio_bsp_handle_t bsp_handle;                  ///< BSP 句柄，用于音频输出
     ring_buffer_handle_t playback_rb;               ///< 播放缓冲区，存储待播放的音频数据
     ring_buffer_handle_t reference_rb;              ///< 回采缓冲区，存储回采的音频数据供AFE使用
-    TaskHandle_t playback_task;                     ///< 播放任务句柄，用于管理播放任务
-    bool running;                                   ///< 运行状态标志，true表示正在运行
+    TaskHandle_t playback_task;                     ///< 播放任务句柄（常驻，空闲时等待任务通知）
+    SemaphoreHandle_t idle_sem;                     ///< 播放任务离开播放循环后，每次被唤醒都释放一次
+    SemaphoreHandle_t exit_sem;                     ///< 播放任务退出时释放
+    SemaphoreHandle_t flush_sem;                    ///< 播放任务执行完清空请求后释放
+    SemaphoreHandle_t write_mutex;                  ///< 外部写入与解码器/重采样器替换互斥
+    atomic_bool flush_requested;                    ///< 清空请求，由播放任务执行
+    atomic_bool running;                            ///< 运行请求，由 start/stop 设置
+    atomic_bool active;                             ///< 播放任务在播放循环中（由播放任务发布），
+                                                    ///< 为 false 时解码器和重采样器才能替换
+    volatile bool exiting;                          ///< 销毁中，播放任务应退出
     size_t frame_samples;                           ///< 每帧采样点数，用于分配帧缓冲区
     playback_reference_callback_t reference_callback; ///< 回采回调函数，用于将音频数据传递给AFE
     void *reference_ctx;                            ///< 回采回调上下文，传递给回调函数的用户数据
     uint8_t *volume_ptr;                            ///< 音量指针，指向音量值（0-100）
+    uint32_t sample_rate;                           ///< 播放采样率（I2S），用于回采时间戳
+    uint32_t input_rate;                            ///< 写入数据的采样率（与 sample_rate 不同时经过重采样）
+    resampler_handle_t resampler;                   ///< 重采样器，NULL 表示不需要
+    ring_buffer_overflow_policy_t overflow_policy;  ///< 播放缓冲区溢出策略（重采样前据此检查空间）
+    uint32_t block_timeout_ms;                      ///< BLOCK 策略下等待空间的最长时间
+    int16_t *resample_buf;                          ///< 重采样输出缓冲区
+    RingbufHandle_t encoded_rb;                     ///< 压缩帧缓冲区（NOSPLIT，一项一帧），NULL 表示未启用
+    audio_decoder_handle_t decoder;                 ///< 压缩帧解码器（设置非 PCM16 格式后创建，只在停止时替换），
+                                                    ///< 非 NULL 时播放任务是播放缓冲区唯一的生产者
+    audio_codec_t codec;                            ///< 压缩帧格式（PCM16 表示直接写入 PCM）
+    int16_t *decode_buf;                            ///< 解码输出缓冲区
+    size_t decode_buf_samples;                      ///< 解码输出缓冲区容量（采样点数）
+    uint32_t decode_errors;                         ///< 解码失败的帧数
+    uint32_t speaker_errors;                        ///< 扬声器写入失败的次数（包括异步写入的错误）
+    int64_t speaker_error_log_us;                   ///< 上次打印扬声器写入错误的时间
+    int64_t overrun_log_us;                         ///< 上次打印播放区间被覆盖的时间
 } playback_controller_t;
 
 /**
- * @brief 播放任务函数
+ * @brief 播放任务中的错误日志限频
  * 
- * 从播放缓冲区读取音频数据，先回采给AFE，再输出到扬声器
+ * @param last_us 上次打印的时间，到期时更新
+ * @return true 距上次打印已超过 PLAYBACK_LOG_INTERVAL_MS（或从未打印）
+ */
+static bool playback_log_due(int64_t *last_us)
+{
+    int64_t now = esp_timer_get_time();
+    if (*last_us != 0 && now - *last_us < PLAYBACK_LOG_INTERVAL_MS * 1000LL) {
+        return false;
+    }
+    *last_us = now;
+    return true;
+}
+
+/**
+ * @brief 丢弃压缩帧缓冲区中尚未解码的帧
  * 
- * @param arg 播放控制器上下文指针
+ * @param controller 播放控制器句柄
  */
-static void playback_task(void *arg)
+static void playback_drain_encoded(playback_controller_t *controller)
 {
-    playback_controller_t *ctrl = (playback_controller_t *)arg;
-    
-    // 分配帧缓冲区，用于存储从环形缓冲区读取的音频数据
-    int16_t *frame = (int16_t *)malloc(ctrl->frame_samples * sizeof(int16_t));
-    if (!frame) {
-        ESP_LOGE(TAG, "播放任务内存分配失败");
-        vTaskDelete(NULL);
+    size_t len;
+    void *frame;
+    while ((frame = xRingbufferReceive(controller->encoded_rb, &len, 0)) != NULL) {
+        vRingbufferReturnItem(controller->encoded_rb, frame);
+    }
+}
+
+/**
+ * @brief 在播放任务中执行清空请求
+ * 
+ * 播放任务是播放缓冲区的消费者、回采缓冲区的生产者，也是压缩帧缓冲区的接收方：
+ * 清空都在自己的读写路径上完成，读位置和水位回调不会被第三个任务改动
+ * 
+ * @param ctrl 播放控制器上下文
+ */
+static void playback_handle_flush(playback_controller_t *ctrl)
+{
+    if (!atomic_exchange(&ctrl->flush_requested, false)) {
         return;
     }
 
-    ESP_LOGI(TAG, "播放任务启动");
+    ring_buffer_clear(ctrl->playback_rb);
+    ring_buffer_clear(ctrl->reference_rb);
+    if (ctrl->encoded_rb) {
+        playback_drain_encoded(ctrl);
+    }
+    xSemaphoreGive(ctrl->flush_sem);
+}
 
-    // 主循环：持续从播放缓冲区读取数据并播放
-    while (ctrl->running) {
-        // 从播放缓冲区读取一帧音频数据，超时时间200ms
-        size_t got = ring_buffer_read(ctrl->playback_rb, frame, ctrl->frame_samples, 200);
+/**
+ * @brief 把输入采样率的 PCM 写入播放缓冲区（采样率不同时先重采样）
+ * 
+ * 调用者是播放缓冲区唯一的生产者：PCM16 格式时为外部写入任务，其余格式时为播放任务，
+ * 两者不会同时写入，重采样器状态也只属于其中一方。外部写入任务持有 write_mutex 调用，
+ * 播放任务只在播放循环中调用，替换重采样器时两者都被排除在外
+ * 
+ * @param ctrl 播放控制器上下文
+ * @param pcm PCM 数据（input_rate）
+ * @param samples 采样点数
+ * @return 被接受的输入采样点数
+ * 
+ * @note 重采样器一旦处理输入就改变了内部状态，因此不能先重采样再部分写入：
+ *       DROP_NEWEST / BLOCK 策略下每块重采样前先确认（或等待）剩余空间足够放下最大输出，
+ *       空间不足时停在块边界，返回值精确对应已写入的输入
+ */
+static size_t playback_write_pcm(playback_controller_t *ctrl, const int16_t *pcm, size_t samples)
+{
+    if (!ctrl->resampler) {
+        return ring_buffer_write(ctrl->playback_rb, pcm, samples);
+    }
 
-        if (got > 0) {
-            // 先回采给 AFE（通过回调或写入缓冲区）
-            // 回采的目的是让AFE能够处理播放的音频，用于回声消除等功能
-            if (ctrl->reference_callback) {
-                // 如果设置了回调函数，直接调用回调函数传递音频数据
-                ctrl->reference_callback(frame, got, ctrl->reference_ctx);
-            } else {
-                // 否则将音频数据写入回采缓冲区，供AFE读取
-                ring_buffer_write(ctrl->reference_rb, frame, got);
+    size_t accepted = 0;
+    while (accepted < samples) {
+        size_t n = samples - accepted < PLAYBACK_RESAMPLE_CHUNK ? samples - accepted : PLAYBACK_RESAMPLE_CHUNK;
+        if (ctrl->overflow_policy != RING_BUFFER_OVERFLOW_DROP_OLDEST) {
+            size_t need = resampler_max_output(ctrl->resampler, n);
+            uint32_t timeout = ctrl->overflow_policy == RING_BUFFER_OVERFLOW_BLOCK ? ctrl->block_timeout_ms : 0;
+            if (ring_buffer_wait_free(ctrl->playback_rb, need, timeout) < need) {
+                break;
             }
+        }
+        size_t out = resampler_process(ctrl->resampler, pcm + accepted, n, ctrl->resample_buf);
+        ring_buffer_write(ctrl->playback_rb, ctrl->resample_buf, out);
+        accepted += n;
+    }
+    return accepted;
+}
+
+/**
+ * @brief 解码压缩帧，使播放缓冲区保持约 PLAYBACK_DECODE_AHEAD 帧 PCM
+ * 
+ * 压缩帧直接在压缩帧缓冲区内解码（零拷贝取出），解码结果写入播放缓冲区，
+ * 压缩数据在播放前才展开，播放缓冲区中只保留少量 PCM
+ * 
+ * @param ctrl 播放控制器上下文
+ * @return true 本次解码了至少一帧
+ */
+static bool playback_decode_ahead(playback_controller_t *ctrl)
+{
+    if (!ctrl->decoder) {
+        return false;
+    }
+
+    bool decoded = false;
+    size_t size = ring_buffer_get_size(ctrl->playback_rb);
+    size_t max_out = ctrl->resampler ? resampler_max_output(ctrl->resampler, ctrl->decode_buf_samples)
+                                     : ctrl->decode_buf_samples;
+    while (atomic_load(&ctrl->running)) {
+        size_t avail = ring_buffer_available(ctrl->playback_rb);
+        if (avail >= PLAYBACK_DECODE_AHEAD * ctrl->frame_samples || size - avail < max_out) {
+            break;
+        }
 
-            // 再播放音频数据到扬声器
-            // 获取音量值，如果未设置音量指针则使用默认值80
-            uint8_t volume = ctrl->volume_ptr ? *ctrl->volume_ptr : 80;
-            // 通过 BSP 将音频数据写入扬声器
-            audio_bsp_write_speaker(ctrl->bsp_handle, frame, got, volume);
+        size_t len = 0;
+        uint8_t *frame = (uint8_t *)xRingbufferReceive(ctrl->encoded_rb, &len, 0);
+        if (!frame) {
+            break;
         }
+
+        size_t samples = 0;
+        esp_err_t ret = audio_decoder_decode(ctrl->decoder, frame, len, ctrl->decode_buf,
+                                             ctrl->decode_buf_samples, &samples);
+        vRingbufferReturnItem(ctrl->encoded_rb, frame);
+        if (ret != ESP_OK) {
+            // 实时路径上只计数，停止播放时汇总打印
+            ctrl->decode_errors++;
+            continue;
+        }
+
+        playback_write_pcm(ctrl, ctrl->decode_buf, samples);
+        decoded = true;
     }
+    return decoded;
+}
 
-    // 清理资源
-    free(frame);
-    ESP_LOGI(TAG, "播放任务结束");
+/**
+ * @brief 播放一帧数据
+ * 
+ * 直接在播放缓冲区内存上工作（零拷贝）：先回采给AFE，再输出到扬声器，
+ * 最后释放已播放的区间。每段回采数据写入前打上送入 DMA 的时间戳
+ * （当前时间加上 TX 队列中尚未送入 DMA 的时长），AFE 据此计算麦克风与回采流之间的时间偏差。
+ * 扬声器写入错误（包括上一次异步写入的错误）计入 speaker_errors，限频打印。
+ * 每段以完整的 DMA 帧写入；停止时 BSP 清空 TX 队列，正在进行的写入随即返回
+ * 
+ * @param ctrl 播放控制器上下文
+ */
+static void playback_play_frame(playback_controller_t *ctrl)
+{
+    // 等待播放缓冲区攒满一帧（最长200ms，超时则播放已有数据），
+    // 保证每次都以完整的 DMA 帧写入 I2S，减少唤醒和零碎写入；停止或清空时被立即打断
+    playback_handle_flush(ctrl);
+    playback_decode_ahead(ctrl);
+    size_t avail = ring_buffer_wait_available(ctrl->playback_rb, ctrl->frame_samples, 200);
+    if (!atomic_load(&ctrl->running) || atomic_load(&ctrl->flush_requested)) {
+        return;
+    }
+
+    // 写入压缩帧也会打断等待：解码后重新等待凑满一帧
+    if (avail < ctrl->frame_samples && playback_decode_ahead(ctrl)) {
+        return;
+    }
+
+    // 查看播放缓冲区中最多一帧的数据
+    ring_buffer_span_t span;
+    size_t got = ring_buffer_peek_read(ctrl->playback_rb, ctrl->frame_samples, &span, 0);
+    if (got == 0) {
+        return;
+    }
+
+    // 获取音量值，如果未设置音量指针则使用默认值80
+    uint8_t volume = ctrl->volume_ptr ? *ctrl->volume_ptr : 80;
+
+    // 区间在缓冲区末尾回绕时分两段处理
+    size_t played = 0;
+    for (int i = 0; i < 2 && span.len[i] > 0 && atomic_load(&ctrl->running); i++) {
+        const int16_t *data = span.data[i];
+        size_t n = span.len[i];
+
+        // 先回采给 AFE（通过回调或写入缓冲区）
+        // 回采的目的是让AFE能够处理播放的音频，用于回声消除等功能
+        if (ctrl->reference_callback) {
+            // 如果设置了回调函数，直接调用回调函数传递音频数据
+            ctrl->reference_callback(data, n, ctrl->reference_ctx);
+        } else {
+            // 否则将音频数据写入回采缓冲区，供AFE读取；
+            // 本段要等 TX 队列中已提交的数据送入 DMA 后才送入，时间戳按队列深度推迟
+            size_t pending = audio_bsp_get_speaker_pending(ctrl->bsp_handle);
+            ring_buffer_stamp(ctrl->reference_rb,
+                              esp_timer_get_time() + (int64_t)pending * 1000000 / ctrl->sample_rate,
+                              ctrl->sample_rate);
+            ring_buffer_write(ctrl->reference_rb, data, n);
+        }
+
+        // 再通过 BSP 将音频数据直接从环形缓冲区写入扬声器
+        esp_err_t ret = audio_bsp_write_speaker(ctrl->bsp_handle, data, n, volume);
+        if (ret != ESP_OK) {
+            ctrl->speaker_errors++;
+            if (playback_log_due(&ctrl->speaker_error_log_us)) {
+                ESP_LOGW(TAG, "扬声器写入失败: %s, 累计 %u 次",
+                         esp_err_to_name(ret), (unsigned)ctrl->speaker_errors);
+            }
+        }
+        played += n;
+    }
+
+    // 释放已播放的区间；失败说明播放期间生产者按 DROP_OLDEST 覆盖了这段数据，
+    // 已送出的音频可能混入了新数据（次数计入 peek_overruns）
+    if (!ring_buffer_release_read(ctrl->playback_rb, played) && playback_log_due(&ctrl->overrun_log_us)) {
+        ring_buffer_stats_t stats;
+        ring_buffer_get_stats(ctrl->playback_rb, &stats);
+        ESP_LOGW(TAG, "播放中的数据被生产者覆盖，累计 %u 次（播放缓冲区偏小或写入过快）",
+                 (unsigned)stats.peek_overruns);
+    }
+}
+
+/**
+ * @brief 播放任务函数
+ * 
+ * 常驻任务：空闲时阻塞在任务通知上，启动后循环播放，销毁时退出；
+ * 空闲时被唤醒也会执行清空请求。
+ * 先发布 active 再检查 running：控制任务清除 running 后看到 active 为 false，
+ * 播放任务就不会再进入播放循环，可以安全替换解码器和重采样器。
+ * 离开播放循环、清除 active 后，每次被唤醒都释放一次 idle_sem：
+ * 启动后任务尚未被唤醒就停止时，任务醒来看到 running 已清除，同样会确认空闲
+ * 
+ * @param arg 播放控制器上下文指针
+ */
+static void playback_task(void *arg)
+{
+    playback_controller_t *ctrl = (playback_controller_t *)arg;
+
+    while (!ctrl->exiting) {
+        playback_handle_flush(ctrl);
+        atomic_store(&ctrl->active, true);
+        if (atomic_load(&ctrl->running)) {
+            ESP_LOGI(TAG, "播放任务启动");
+            uint32_t decode_errors = ctrl->decode_errors;
+            while (atomic_load(&ctrl->running)) {
+                playback_play_frame(ctrl);
+            }
+            if (ctrl->decode_errors != decode_errors) {
+                ESP_LOGW(TAG, "本次播放 %u 个压缩帧解码失败（累计 %u 帧）",
+                         (unsigned)(ctrl->decode_errors - decode_errors), (unsigned)ctrl->decode_errors);
+            }
+            ESP_LOGI(TAG, "播放任务空闲");
+        }
+        atomic_store(&ctrl->active, false);
+
+        xSemaphoreGive(ctrl->idle_sem);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    xSemaphoreGive(ctrl->exit_sem);
     vTaskDelete(NULL);
 }
 
@@ -114,6 +362,8 @@ playback_controller_handle_t playback_controller_create(const playback_controlle
     ctrl->reference_callback = config->reference_callback;
     ctrl->reference_ctx = config->reference_ctx;
     ctrl->volume_ptr = config->volume_ptr;
+    ctrl->sample_rate = config->sample_rate ? config->sample_rate : 16000;
+    ctrl->input_rate = ctrl->sample_rate;
 
     // 创建播放缓冲区（阻塞模式）
     ctrl->playback_rb = ring_buffer_create(config->playback_buffer_samples, true);
@@ -123,6 +373,17 @@ playback_controller_handle_t playback_controller_create(const playback_controlle
         return NULL;
     }
 
+    // 设置播放缓冲区溢出策略（BLOCK 策略可对生产者形成反压）
+    if (ring_buffer_set_overflow_policy(ctrl->playback_rb, config->overflow_policy,
+                                        config->block_timeout_ms) != ESP_OK) {
+        ESP_LOGE(TAG, "播放缓冲区溢出策略设置失败");
+        ring_buffer_destroy(ctrl->playback_rb);
+        free(ctrl);
+        return NULL;
+    }
+    ctrl->overflow_policy = config->overflow_policy;
+    ctrl->block_timeout_ms = config->block_timeout_ms;
+
     // 创建回采缓冲区（非阻塞模式）
     ctrl->reference_rb = ring_buffer_create(config->reference_buffer_samples, false);
     if (!ctrl->reference_rb) {
@@ -132,6 +393,47 @@ playback_controller_handle_t playback_controller_create(const playback_controlle
         return NULL;
     }
 
+    // 创建压缩帧缓冲区（PSRAM）和解码输出缓冲区
+    if (config->encoded_buffer_bytes > 0) {
+        ctrl->decode_buf_samples = PLAYBACK_DECODE_MAX_SAMPLES;
+        ctrl->decode_buf = (int16_t *)malloc(ctrl->decode_buf_samples * sizeof(int16_t));
+        ctrl->encoded_rb = xRingbufferCreateWithCaps(config->encoded_buffer_bytes, RINGBUF_TYPE_NOSPLIT,
+                                                     MALLOC_CAP_SPIRAM);
+        if (!ctrl->decode_buf || !ctrl->encoded_rb) {
+            ESP_LOGE(TAG, "压缩帧缓冲区创建失败");
+            if (ctrl->encoded_rb) vRingbufferDeleteWithCaps(ctrl->encoded_rb);
+            free(ctrl->decode_buf);
+            ring_buffer_destroy(ctrl->reference_rb);
+            ring_buffer_destroy(ctrl->playback_rb);
+            free(ctrl);
+            return NULL;
+        }
+    }
+
+    // 创建常驻播放任务，固定到 Core 1，启动前阻塞在任务通知上
+    ctrl->idle_sem = xSemaphoreCreateBinary();
+    ctrl->exit_sem = xSemaphoreCreateBinary();
+    ctrl->flush_sem = xSemaphoreCreateBinary();
+    ctrl->write_mutex = xSemaphoreCreateMutex();
+    atomic_init(&ctrl->flush_requested, false);
+    atomic_init(&ctrl->running, false);
+    atomic_init(&ctrl->active, false);
+    if (!ctrl->idle_sem || !ctrl->exit_sem || !ctrl->flush_sem || !ctrl->write_mutex ||
+        xTaskCreatePinnedToCore(playback_task, "playback", PLAYBACK_TASK_STACK, ctrl,
+                                PLAYBACK_TASK_PRIO, &ctrl->playback_task, PLAYBACK_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "播放任务创建失败");
+        if (ctrl->idle_sem) vSemaphoreDelete(ctrl->idle_sem);
+        if (ctrl->exit_sem) vSemaphoreDelete(ctrl->exit_sem);
+        if (ctrl->flush_sem) vSemaphoreDelete(ctrl->flush_sem);
+        if (ctrl->write_mutex) vSemaphoreDelete(ctrl->write_mutex);
+        if (ctrl->encoded_rb) vRingbufferDeleteWithCaps(ctrl->encoded_rb);
+        free(ctrl->decode_buf);
+        ring_buffer_destroy(ctrl->reference_rb);
+        ring_buffer_destroy(ctrl->playback_rb);
+        free(ctrl);
+        return NULL;
+    }
+
     ESP_LOGI(TAG, "✅ 播放控制器创建成功");
     return ctrl;
 }
@@ -139,7 +441,7 @@ playback_controller_handle_t playback_controller_create(const playback_controlle
 /**
  * @brief 销毁播放控制器
  * 
- * 停止播放任务并释放所有资源
+ * 停止播放并让常驻播放任务退出，然后释放所有资源
  * 
  * @param controller 播放控制器句柄
  */
@@ -147,8 +449,29 @@ void playback_controller_destroy(playback_controller_handle_t controller)
 {
     if (!controller) return;
 
-    // 先停止播放任务
+    // 先停止播放，再通知播放任务退出
     playback_controller_stop(controller);
+    controller->exiting = true;
+    xTaskNotifyGive(controller->playback_task);
+    if (xSemaphoreTake(controller->exit_sem, pdMS_TO_TICKS(PLAYBACK_EXIT_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "播放任务未在 %d ms 内退出，强制删除", PLAYBACK_EXIT_TIMEOUT_MS);
+        vTaskDelete(controller->playback_task);
+    }
+    vSemaphoreDelete(controller->idle_sem);
+    vSemaphoreDelete(controller->exit_sem);
+    vSemaphoreDelete(controller->flush_sem);
+    vSemaphoreDelete(controller->write_mutex);
+
+    // 销毁解码器和压缩帧缓冲区
+    audio_decoder_destroy(controller->decoder);
+    if (controller->encoded_rb) {
+        vRingbufferDeleteWithCaps(controller->encoded_rb);
+    }
+    free(controller->decode_buf);
+
+    // 销毁重采样器
+    resampler_destroy(controller->resampler);
+    free(controller->resample_buf);
 
     // 销毁播放缓冲区
     if (controller->playback_rb) {
@@ -168,7 +491,7 @@ void playback_controller_destroy(playback_controller_handle_t controller)
 /**
  * @brief 启动播放控制器
  * 
- * 创建并启动播放任务
+ * 唤醒常驻的播放任务开始播放
  * 
  * @param controller 播放控制器句柄
  * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
@@ -180,17 +503,13 @@ esp_err_t playback_controller_start(playback_controller_handle_t controller)
     }
 
     // 如果已经在运行，直接返回
-    if (controller->running) {
+    if (atomic_load(&controller->running)) {
         return ESP_OK;
     }
 
     ESP_LOGI(TAG, "▶️ 启动播放器");
-    controller->running = true;
-
-    // 创建播放任务，固定到 Core 1
-    // 任务优先级7，栈大小5KB
-    xTaskCreatePinnedToCore(playback_task, "playback", 5 * 1024, controller, 
-                            7, &controller->playback_task, 1);
+    atomic_store(&controller->running, true);
+    xTaskNotifyGive(controller->playback_task);
 
     return ESP_OK;
 }
@@ -198,85 +517,320 @@ esp_err_t playback_controller_start(playback_controller_handle_t controller)
 /**
  * @brief 停止播放控制器
  * 
- * 停止播放任务
+ * 清除运行标志，打断播放任务在播放缓冲区上的等待并清空 BSP 的 TX 队列
+ * （正在进行的扬声器写入随即返回），再等待播放任务确认空闲，停止延迟为毫秒级。
+ * 超时后播放任务可能仍在解码或写入扬声器，仍视为正在播放：再次调用会继续等待其确认
  * 
  * @param controller 播放控制器句柄
- * @return ESP_OK 成功
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 播放任务未在 PLAYBACK_STOP_TIMEOUT_MS 内回到空闲
  */
 esp_err_t playback_controller_stop(playback_controller_handle_t controller)
 {
-    if (!controller || !controller->running) {
+    if (!controller || (!atomic_load(&controller->running) && !atomic_load(&controller->active))) {
         return ESP_OK;
     }
 
-    ESP_LOGI(TAG, "⏹️ 停止播放器");
-    controller->running = false;
+    int64_t start = esp_timer_get_time();
+
+    // 丢弃上次停止超时后迟到的信号
+    xSemaphoreTake(controller->idle_sem, 0);
+    atomic_store(&controller->running, false);
+    ring_buffer_abort_wait(controller->playback_rb);
+    audio_bsp_flush_speaker(controller->bsp_handle);
 
-    // 等待任务结束
-    if (controller->playback_task) {
-        vTaskDelay(pdMS_TO_TICKS(300));
-        controller->playback_task = NULL;
+    // 等待播放任务回到空闲
+    if (xSemaphoreTake(controller->idle_sem, pdMS_TO_TICKS(PLAYBACK_STOP_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "播放任务未在 %d ms 内停止", PLAYBACK_STOP_TIMEOUT_MS);
+        return ESP_ERR_TIMEOUT;
     }
 
+    ESP_LOGI(TAG, "⏹️ 播放器已停止（%d us）", (int)(esp_timer_get_time() - start));
     return ESP_OK;
 }
 
 /**
  * @brief 写入音频数据到播放缓冲区
  * 
- * 将PCM音频数据写入播放缓冲区，供播放任务读取
+ * 将PCM音频数据写入播放缓冲区，供播放任务读取。输入采样率与播放采样率不同时先重采样。
+ * 缓冲区满时按溢出策略处理，BLOCK 策略下会阻塞等待空间（带超时）。
+ * 设置了压缩格式时播放任务是播放缓冲区的生产者，拒绝写入 PCM。
+ * 写入期间持有 write_mutex，停止状态下预填充时 set_input_rate 会等本次写入完成再替换重采样器。
  * 
  * @param controller 播放控制器句柄
  * @param pcm_data PCM音频数据指针
  * @param sample_count 采样点数
- * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ * @return 实际接受的采样点数，参数无效或设置了压缩格式时返回 0
  */
-esp_err_t playback_controller_write(playback_controller_handle_t controller, 
-                                     const int16_t *pcm_data, size_t sample_count)
+size_t playback_controller_write(playback_controller_handle_t controller, 
+                                 const int16_t *pcm_data, size_t sample_count)
 {
     if (!controller || !pcm_data || sample_count == 0) {
+        return 0;
+    }
+
+    xSemaphoreTake(controller->write_mutex, portMAX_DELAY);
+    size_t written = 0;
+    if (controller->decoder) {
+        ESP_LOGD(TAG, "当前为 %s 压缩播放，拒绝写入 PCM", audio_codec_name(controller->codec));
+    } else {
+        // 将音频数据写入播放缓冲区
+        written = playback_write_pcm(controller, pcm_data, sample_count);
+    }
+    xSemaphoreGive(controller->write_mutex);
+    return written;
+}
+
+/**
+ * @brief 设置压缩帧的格式
+ * 
+ * 格式同时决定播放缓冲区的生产者：PCM16 时由 playback_controller_write 直接写入，
+ * 其余格式时只接受 playback_controller_write_encoded，由播放任务解码写入。
+ * 解码器只在播放任务确认空闲（active 为 false）时替换，并持有 write_mutex 排除并发的外部写入
+ * 
+ * @param controller 播放控制器句柄
+ * @param codec 压缩格式
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 正在播放（含停止超时未确认）或未启用压缩播放，
+ *         ESP_ERR_NOT_SUPPORTED 格式不支持
+ */
+esp_err_t playback_controller_set_codec(playback_controller_handle_t controller, audio_codec_t codec)
+{
+    if (!controller) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (playback_controller_is_running(controller) || (!controller->encoded_rb && codec != AUDIO_CODEC_PCM16)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    audio_decoder_handle_t decoder = NULL;
+    if (codec != AUDIO_CODEC_PCM16) {
+        decoder = audio_decoder_create(codec, controller->input_rate);
+        if (!decoder) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+
+    // 旧格式的帧不能用新解码器解码
+    xSemaphoreTake(controller->write_mutex, portMAX_DELAY);
+    if (controller->encoded_rb) {
+        playback_drain_encoded(controller);
+    }
+    audio_decoder_destroy(controller->decoder);
+    controller->decoder = decoder;
+    controller->codec = codec;
+    controller->decode_errors = 0;
+    xSemaphoreGive(controller->write_mutex);
 
-    // 将音频数据写入播放缓冲区
-    ring_buffer_write(controller->playback_rb, pcm_data, sample_count);
+    ESP_LOGI(TAG, "播放格式: %s%s", audio_codec_name(codec), decoder ? "（压缩帧）" : "（直接写入 PCM）");
     return ESP_OK;
 }
 
 /**
- * @brief 清空播放缓冲区
+ * @brief 设置写入数据的采样率
+ * 
+ * 与播放采样率不同时创建重采样器（创建时计算滤波器组），相同时直接写入。
+ * Opus 解码器按输入采样率输出，已设置 Opus 格式时一并重建。
+ * 新对象在锁外创建，替换时持有 write_mutex，不会与预填充的 playback_controller_write 交错
+ * 
+ * @param controller 播放控制器句柄
+ * @param sample_rate 输入采样率（0 表示与播放采样率相同）
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 正在播放（含停止超时未确认），ESP_ERR_NOT_SUPPORTED 采样率比例无法支持
+ */
+esp_err_t playback_controller_set_input_rate(playback_controller_handle_t controller, uint32_t sample_rate)
+{
+    if (!controller) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (playback_controller_is_running(controller)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (sample_rate == 0) {
+        sample_rate = controller->sample_rate;
+    }
+
+    resampler_handle_t resampler = NULL;
+    int16_t *resample_buf = NULL;
+    audio_decoder_handle_t decoder = NULL;
+    if (sample_rate != controller->sample_rate) {
+        resampler = resampler_create(sample_rate, controller->sample_rate);
+        if (!resampler) {
+            ESP_LOGE(TAG, "不支持的重采样: %u -> %u Hz", (unsigned)sample_rate, (unsigned)controller->sample_rate);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        resample_buf = (int16_t *)malloc(resampler_max_output(resampler, PLAYBACK_RESAMPLE_CHUNK) * sizeof(int16_t));
+        if (!resample_buf) {
+            resampler_destroy(resampler);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    xSemaphoreTake(controller->write_mutex, portMAX_DELAY);
+    if (controller->decoder && controller->codec == AUDIO_CODEC_OPUS) {
+        decoder = audio_decoder_create(AUDIO_CODEC_OPUS, sample_rate);
+        if (!decoder) {
+            xSemaphoreGive(controller->write_mutex);
+            resampler_destroy(resampler);
+            free(resample_buf);
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        playback_drain_encoded(controller);
+        audio_decoder_destroy(controller->decoder);
+        controller->decoder = decoder;
+    }
+
+    resampler_handle_t old_resampler = controller->resampler;
+    int16_t *old_resample_buf = controller->resample_buf;
+    controller->resampler = resampler;
+    controller->resample_buf = resample_buf;
+    controller->input_rate = sample_rate;
+    xSemaphoreGive(controller->write_mutex);
+
+    resampler_destroy(old_resampler);
+    free(old_resample_buf);
+
+    ESP_LOGI(TAG, "播放输入采样率: %u Hz%s", (unsigned)sample_rate, resampler ? "（重采样）" : "");
+    return ESP_OK;
+}
+
+/**
+ * @brief 写入一个压缩帧
+ * 
+ * 整帧存入 NOSPLIT 缓冲区后打断播放任务在播放缓冲区上的等待，
+ * 播放任务随即解码，不必等满 200ms 的攒帧超时
+ * 
+ * @param controller 播放控制器句柄
+ * @param frame 压缩帧
+ * @param len 字节数
+ * @param timeout_ms 缓冲区满时最长等待时间（毫秒）
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 缓冲区满，ESP_ERR_INVALID_STATE 未设置压缩格式，ESP_ERR_INVALID_SIZE 帧过大
+ */
+esp_err_t playback_controller_write_encoded(playback_controller_handle_t controller,
+                                            const uint8_t *frame, size_t len, uint32_t timeout_ms)
+{
+    if (!controller || !frame || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 持锁检查格式并写入，set_codec 清掉旧格式的帧后不会再混入
+    xSemaphoreTake(controller->write_mutex, portMAX_DELAY);
+    esp_err_t ret = ESP_OK;
+    if (!controller->decoder) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else if (len > xRingbufferGetMaxItemSize(controller->encoded_rb)) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else if (xRingbufferSend(controller->encoded_rb, frame, len, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        ret = ESP_ERR_TIMEOUT;
+    } else {
+        ring_buffer_abort_wait(controller->playback_rb);
+    }
+    xSemaphoreGive(controller->write_mutex);
+    return ret;
+}
+
+/**
+ * @brief 设置播放缓冲区满时的写入策略
+ * 
+ * @param controller 播放控制器句柄
+ * @param policy 溢出策略（覆盖旧数据 / 丢弃新数据 / 阻塞等待）
+ * @param block_timeout_ms BLOCK 策略下单次写入最长等待时间（毫秒）
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t playback_controller_set_overflow_policy(playback_controller_handle_t controller,
+                                                  ring_buffer_overflow_policy_t policy,
+                                                  uint32_t block_timeout_ms)
+{
+    if (!controller) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ring_buffer_set_overflow_policy(controller->playback_rb, policy, block_timeout_ms);
+    if (ret == ESP_OK) {
+        controller->overflow_policy = policy;
+        controller->block_timeout_ms = block_timeout_ms;
+    }
+    return ret;
+}
+
+/**
+ * @brief 设置播放缓冲区高/低水位回调
  * 
- * 清空播放缓冲区和回采缓冲区中的所有数据
+ * LOW 在播放任务消费数据时触发，可用于唤醒流式生产者继续填充；
+ * HIGH 在生产者写入时触发。
  * 
  * @param controller 播放控制器句柄
+ * @param low 低水位（采样点数）
+ * @param high 高水位（采样点数）
+ * @param callback 水位回调，NULL 表示关闭
+ * @param user_ctx 回调上下文
  * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
  */
+esp_err_t playback_controller_set_watermarks(playback_controller_handle_t controller,
+                                             size_t low, size_t high,
+                                             ring_buffer_watermark_cb_t callback, void *user_ctx)
+{
+    if (!controller) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ring_buffer_set_watermarks(controller->playback_rb, low, high, callback, user_ctx);
+}
+
+/**
+ * @brief 等待播放缓冲区剩余空间达到 min_free
+ * 
+ * @param controller 播放控制器句柄
+ * @param min_free 等待的最低剩余空间（采样点数）
+ * @param timeout_ms 最长等待时间（毫秒）
+ * @return 返回时的剩余空间，参数无效时返回 0
+ */
+size_t playback_controller_wait_free_space(playback_controller_handle_t controller,
+                                           size_t min_free, uint32_t timeout_ms)
+{
+    if (!controller) {
+        return 0;
+    }
+    return ring_buffer_wait_free(controller->playback_rb, min_free, timeout_ms);
+}
+
+/**
+ * @brief 清空播放缓冲区
+ * 
+ * 清空播放缓冲区、回采缓冲区和压缩帧缓冲区中的所有数据，并丢弃 BSP TX 队列中尚未送入 DMA 的数据。
+ * 缓冲区由播放任务在自己的读写路径上清空（见 playback_handle_flush）：这里只投递清空请求、
+ * 打断播放任务的等待并唤醒空闲的播放任务，再等待其确认，返回后写入的数据不会被清掉
+ * 
+ * @param controller 播放控制器句柄
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效，ESP_ERR_TIMEOUT 播放任务未及时确认（请求保留，稍后执行）
+ */
 esp_err_t playback_controller_clear(playback_controller_handle_t controller)
 {
     if (!controller) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 清空播放缓冲区
-    esp_err_t ret = ring_buffer_clear(controller->playback_rb);
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "🗑️ 已清空播放缓冲区");
+    // 丢弃上次超时后迟到的确认，再投递请求并唤醒播放任务
+    xSemaphoreTake(controller->flush_sem, 0);
+    atomic_store(&controller->flush_requested, true);
+    ring_buffer_abort_wait(controller->playback_rb);
+    audio_bsp_flush_speaker(controller->bsp_handle);
+    xTaskNotifyGive(controller->playback_task);
+
+    if (xSemaphoreTake(controller->flush_sem, pdMS_TO_TICKS(PLAYBACK_STOP_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "播放任务未在 %d ms 内清空缓冲区", PLAYBACK_STOP_TIMEOUT_MS);
+        return ESP_ERR_TIMEOUT;
     }
 
-    // 清空回采缓冲区
-    ring_buffer_clear(controller->reference_rb);
-    return ret;
+    ESP_LOGI(TAG, "🗑️ 已清空播放缓冲区");
+    return ESP_OK;
 }
 
 /**
  * @brief 检查播放控制器是否正在运行
  * 
+ * 停止超时后播放任务确认空闲之前仍返回 true
+ * 
  * @param controller 播放控制器句柄
  * @return true 正在运行，false 未运行或参数无效
  */
 bool playback_controller_is_running(playback_controller_handle_t controller)
 {
-    return controller ? controller->running : false;
+    return controller ? (atomic_load(&controller->running) || atomic_load(&controller->active)) : false;
 }
 
 /**
@@ -313,3 +867,31 @@ ring_buffer_handle_t playback_controller_get_reference_buffer(playback_controlle
     return controller ? controller->reference_rb : NULL;
 }
 
+
+
+/**
+ * @brief 获取播放/回采缓冲区统计信息
+ * 
+ * 用于根据实际运行数据评估缓冲区大小（溢出、欠载、最高水位等）
+ * 
+ * @param controller 播放控制器句柄
+ * @param playback_stats 输出播放缓冲区统计，NULL 表示不需要
+ * @param reference_stats 输出回采缓冲区统计，NULL 表示不需要
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数无效
+ */
+esp_err_t playback_controller_get_stats(playback_controller_handle_t controller,
+                                        ring_buffer_stats_t *playback_stats,
+                                        ring_buffer_stats_t *reference_stats)
+{
+    if (!controller) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (playback_stats) {
+        ring_buffer_get_stats(controller->playback_rb, playback_stats);
+    }
+    if (reference_stats) {
+        ring_buffer_get_stats(controller->reference_rb, reference_stats);
+    }
+    return ESP_OK;
+}
\ No newline at end of file
@@ -0,0 +1,259 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\record_sub.c
+ * @Description: 录音订阅者实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "record_sub.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "RECORD_SUB";
+
+#define RECORD_SUB_DEFAULT_FRAMES   16
+#define RECORD_SUB_DEFAULT_SAMPLES  512
+#define RECORD_SUB_DEFAULT_STACK    4096
+#define RECORD_SUB_DEFAULT_PRIO     5
+#define RECORD_SUB_MAX_FRAMES       1024
+#define RECORD_SUB_STOP             0xFFFF  ///< 投递任务退出标记（放在就绪队列队首）
+
+/** 一帧录音数据 */
+typedef struct {
+    int16_t *data;                  ///< 数据（指向帧池）
+    size_t samples;                 ///< 采样点数
+    audio_frame_info_t info;        ///< 首个采样点的序号和采集时间
+} record_sub_frame_t;
+
+/**
+ * @brief 录音订阅者结构体
+ *
+ * 帧的编号在空闲队列和就绪队列之间流转：生产者从空闲队列取帧、填数据后放入就绪队列，
+ * 投递任务从就绪队列取帧、回调后还回空闲队列。丢弃最旧帧时生产者直接从就绪队列队首取回。
+ */
+struct record_sub_s {
+    record_sub_callback_t callback; ///< 数据回调
+    void *user_ctx;                 ///< 回调上下文
+    record_sub_drop_policy_t drop_policy;  ///< 丢帧策略
+    uint32_t sample_rate;           ///< 采样率
+    size_t frame_samples;           ///< 每帧最大采样点数
+    size_t frame_count;             ///< 帧数
+    int16_t *pool;                  ///< 帧数据池
+    record_sub_frame_t *frames;     ///< 帧描述
+    QueueHandle_t free_q;           ///< 空闲帧编号
+    QueueHandle_t ready_q;          ///< 待投递帧编号（多一个位置放退出标记）
+    TaskHandle_t task;              ///< 投递任务
+    SemaphoreHandle_t done;         ///< 投递任务退出信号
+    portMUX_TYPE lock;              ///< 保护统计和退出状态
+    bool exited;                    ///< 投递任务已退出循环
+    bool detached;                  ///< 销毁超时，投递任务退出时自行释放
+    record_sub_stats_t stats;       ///< 统计
+};
+
+/**
+ * @brief 释放订阅者的全部资源
+ */
+static void record_sub_free(record_sub_handle_t sub)
+{
+    if (sub->free_q) vQueueDelete(sub->free_q);
+    if (sub->ready_q) vQueueDelete(sub->ready_q);
+    if (sub->done) vSemaphoreDelete(sub->done);
+    free(sub->frames);
+    free(sub->pool);
+    free(sub);
+}
+
+/**
+ * @brief 投递任务：取出就绪帧并调用回调
+ *
+ * @param arg 订阅者
+ */
+static void record_sub_task(void *arg)
+{
+    record_sub_handle_t sub = (record_sub_handle_t)arg;
+    uint16_t idx;
+
+    while (xQueueReceive(sub->ready_q, &idx, portMAX_DELAY) == pdTRUE) {
+        if (idx == RECORD_SUB_STOP) {
+            break;
+        }
+
+        record_sub_frame_t *frame = &sub->frames[idx];
+        int64_t start = esp_timer_get_time();
+        sub->callback(frame->data, frame->samples, &frame->info, sub->user_ctx);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+
+        portENTER_CRITICAL(&sub->lock);
+        sub->stats.delivered_frames++;
+        if (us > sub->stats.max_callback_us) sub->stats.max_callback_us = us;
+        portEXIT_CRITICAL(&sub->lock);
+
+        xQueueSend(sub->free_q, &idx, 0);
+    }
+
+    portENTER_CRITICAL(&sub->lock);
+    sub->exited = true;
+    bool detached = sub->detached;
+    portEXIT_CRITICAL(&sub->lock);
+
+    if (detached) {
+        record_sub_free(sub);
+    } else {
+        xSemaphoreGive(sub->done);
+    }
+    vTaskDelete(NULL);
+}
+
+record_sub_handle_t record_sub_create(const record_sub_config_t *config, uint32_t sample_rate)
+{
+    if (!config || !config->callback) {
+        ESP_LOGE(TAG, "无效的配置参数");
+        return NULL;
+    }
+
+    record_sub_handle_t sub = (record_sub_handle_t)calloc(1, sizeof(struct record_sub_s));
+    if (!sub) {
+        ESP_LOGE(TAG, "订阅者分配失败");
+        return NULL;
+    }
+
+    sub->callback = config->callback;
+    sub->user_ctx = config->user_ctx;
+    sub->drop_policy = config->drop_policy;
+    sub->sample_rate = sample_rate ? sample_rate : 16000;
+    sub->frame_samples = config->frame_samples ? config->frame_samples : RECORD_SUB_DEFAULT_SAMPLES;
+    sub->frame_count = config->queue_frames ? config->queue_frames : RECORD_SUB_DEFAULT_FRAMES;
+    if (sub->frame_count > RECORD_SUB_MAX_FRAMES) {
+        sub->frame_count = RECORD_SUB_MAX_FRAMES;
+    }
+    portMUX_INITIALIZE(&sub->lock);
+
+    sub->pool = (int16_t *)malloc(sub->frame_count * sub->frame_samples * sizeof(int16_t));
+    sub->frames = (record_sub_frame_t *)calloc(sub->frame_count, sizeof(record_sub_frame_t));
+    sub->free_q = xQueueCreate(sub->frame_count, sizeof(uint16_t));
+    sub->ready_q = xQueueCreate(sub->frame_count + 1, sizeof(uint16_t));
+    sub->done = xSemaphoreCreateBinary();
+    if (!sub->pool || !sub->frames || !sub->free_q || !sub->ready_q || !sub->done) {
+        ESP_LOGE(TAG, "订阅者资源分配失败（%d 帧 x %d 采样点）",
+                 (int)sub->frame_count, (int)sub->frame_samples);
+        record_sub_free(sub);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < sub->frame_count; i++) {
+        uint16_t idx = (uint16_t)i;
+        sub->frames[i].data = sub->pool + i * sub->frame_samples;
+        xQueueSend(sub->free_q, &idx, 0);
+    }
+
+    const char *name = config->task_name ? config->task_name : "rec_sub";
+    uint32_t stack = config->task_stack ? config->task_stack : RECORD_SUB_DEFAULT_STACK;
+    int prio = config->task_priority > 0 ? config->task_priority : RECORD_SUB_DEFAULT_PRIO;
+    BaseType_t core = config->task_core < 0 ? tskNO_AFFINITY : config->task_core;
+    if (xTaskCreatePinnedToCore(record_sub_task, name, stack, sub, prio, &sub->task, core) != pdPASS) {
+        ESP_LOGE(TAG, "投递任务创建失败: %s", name);
+        record_sub_free(sub);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "录音订阅者 %s: %d 帧 x %d 采样点, 队列满时%s", name,
+             (int)sub->frame_count, (int)sub->frame_samples,
+             sub->drop_policy == RECORD_SUB_DROP_NEWEST ? "丢弃新帧" : "丢弃最旧帧");
+    return sub;
+}
+
+esp_err_t record_sub_destroy(record_sub_handle_t sub, uint32_t timeout_ms)
+{
+    if (!sub) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 退出标记放在队首，排队的帧不再投递
+    uint16_t stop = RECORD_SUB_STOP;
+    xQueueSendToFront(sub->ready_q, &stop, 0);
+
+    if (xSemaphoreTake(sub->done, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        portENTER_CRITICAL(&sub->lock);
+        bool exited = sub->exited;
+        if (!exited) {
+            sub->detached = true;
+        }
+        portEXIT_CRITICAL(&sub->lock);
+
+        if (!exited) {
+            ESP_LOGW(TAG, "录音回调未在 %u ms 内返回，投递任务退出时自行释放", (unsigned)timeout_ms);
+            return ESP_ERR_TIMEOUT;
+        }
+        // 任务刚好退出，等它发出信号后再释放
+        xSemaphoreTake(sub->done, portMAX_DELAY);
+    }
+
+    record_sub_free(sub);
+    return ESP_OK;
+}
+
+size_t record_sub_push(record_sub_handle_t sub, const int16_t *pcm_data, size_t samples,
+                       const audio_frame_info_t *info)
+{
+    if (!sub || !pcm_data || !info) {
+        return 0;
+    }
+
+    size_t pushed = 0;
+    uint32_t dropped = 0;
+    for (size_t offset = 0; offset < samples; offset += sub->frame_samples) {
+        size_t n = samples - offset < sub->frame_samples ? samples - offset : sub->frame_samples;
+
+        uint16_t idx;
+        if (xQueueReceive(sub->free_q, &idx, 0) != pdTRUE) {
+            // 队列已满：丢弃最旧的帧腾出位置，或丢弃本帧
+            dropped++;
+            if (sub->drop_policy != RECORD_SUB_DROP_OLDEST ||
+                xQueueReceive(sub->ready_q, &idx, 0) != pdTRUE) {
+                continue;
+            }
+            if (idx == RECORD_SUB_STOP) {
+                xQueueSendToFront(sub->ready_q, &idx, 0);  // 正在销毁，不再入队
+                break;
+            }
+        }
+
+        record_sub_frame_t *frame = &sub->frames[idx];
+        memcpy(frame->data, pcm_data + offset, n * sizeof(int16_t));
+        frame->samples = n;
+        frame->info.sample_index = info->sample_index + offset;
+        frame->info.timestamp_us = info->timestamp_us + (int64_t)offset * 1000000 / sub->sample_rate;
+        xQueueSend(sub->ready_q, &idx, 0);
+        pushed++;
+    }
+
+    uint32_t queued = (uint32_t)uxQueueMessagesWaiting(sub->ready_q);
+    portENTER_CRITICAL(&sub->lock);
+    sub->stats.dropped_frames += dropped;
+    if (queued > sub->stats.max_queued_frames) sub->stats.max_queued_frames = queued;
+    portEXIT_CRITICAL(&sub->lock);
+    return pushed;
+}
+
+esp_err_t record_sub_get_stats(record_sub_handle_t sub, record_sub_stats_t *stats)
+{
+    if (!sub || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t queued = (uint32_t)uxQueueMessagesWaiting(sub->ready_q);
+    portENTER_CRITICAL(&sub->lock);
+    *stats = sub->stats;
+    portEXIT_CRITICAL(&sub->lock);
+    stats->queued_frames = queued;
+    return ESP_OK;
+}
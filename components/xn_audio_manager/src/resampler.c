@@ -0,0 +1,226 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\resampler.c
+ * @Description: 定点多相重采样器实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "resampler.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESAMPLER_CHUNK         256     ///< 每次拷入工作缓冲区的输入采样点数
+#define RESAMPLER_CUTOFF        0.85    ///< 截止频率（相对较低采样率的奈奎斯特频率）
+#define RESAMPLER_KAISER_BETA   6.0     ///< Kaiser 窗参数（阻带约 -60dB）
+
+/** 重采样器结构体 */
+struct resampler_s {
+    uint32_t up;            ///< L：插值倍数（相数）
+    uint32_t down;          ///< M：抽取倍数
+    int taps;               ///< 每相抽头数（4 的倍数，内层循环按 4 展开）
+    int shift;              ///< 系数的 Q 格式（15，系数绝对值和接近 2 时为 14）
+    int16_t *bank;          ///< 滤波器组，up 组 x taps，每组按输入时间正序存放
+    int16_t *buf;           ///< 工作缓冲区：taps - 1 个历史采样点 + RESAMPLER_CHUNK 个新采样点
+    size_t next;            ///< 下一个输出对应的最新输入采样点在 buf 中的位置
+    uint32_t phase;         ///< 下一个输出的相位 [0, up)
+};
+
+static uint32_t rs_gcd(uint32_t a, uint32_t b)
+{
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+ * @brief 第一类零阶修正贝塞尔函数（Kaiser 窗）
+ */
+static double rs_bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+/**
+ * @brief 计算多相滤波器组
+ *
+ * 原型滤波器长度 N = up * taps，工作在 up 倍输入采样率上；
+ * 第 p 组取 h[p + k * up]，归一化后倒序存放，处理时与输入正序做点积
+ */
+static bool rs_build_bank(resampler_handle_t rs, uint32_t in_rate, uint32_t out_rate)
+{
+    const int taps = rs->taps;
+    uint32_t n = rs->up * taps;
+    double center = (n - 1) / 2.0;
+    double fc = RESAMPLER_CUTOFF * 0.5 * (in_rate < out_rate ? in_rate : out_rate) /
+                ((double)rs->up * in_rate);
+    double i0_beta = rs_bessel_i0(RESAMPLER_KAISER_BETA);
+
+    double *tmp = (double *)malloc((size_t)rs->up * taps * sizeof(double));
+    if (!tmp) {
+        return false;
+    }
+
+    // 计算每组系数并归一化为单位直流增益，同时统计系数绝对值和
+    double max_abs_sum = 0.0;
+    for (uint32_t p = 0; p < rs->up; p++) {
+        double *h = tmp + (size_t)p * taps;
+        double sum = 0.0;
+        for (int k = 0; k < taps; k++) {
+            double m = p + (double)k * rs->up;
+            double x = m - center;
+            double sinc = fabs(x) < 1e-9 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+            double r = 2.0 * m / (n - 1) - 1.0;
+            double w = rs_bessel_i0(RESAMPLER_KAISER_BETA * sqrt(fmax(0.0, 1.0 - r * r))) / i0_beta;
+            h[k] = sinc * w;
+            sum += h[k];
+        }
+        double abs_sum = 0.0;
+        for (int k = 0; k < taps; k++) {
+            h[k] /= sum;
+            abs_sum += fabs(h[k]);
+        }
+        if (abs_sum > max_abs_sum) max_abs_sum = abs_sum;
+    }
+
+    // 32 位累加不溢出要求系数绝对值和 * 32768 < 2^31 / 2^shift
+    rs->shift = max_abs_sum < 1.99 ? 15 : 14;
+    double scale = (double)(1 << rs->shift);
+    for (uint32_t p = 0; p < rs->up; p++) {
+        for (int k = 0; k < taps; k++) {
+            long v = lround(tmp[(size_t)p * taps + k] * scale);
+            if (v > INT16_MAX) v = INT16_MAX;
+            if (v < INT16_MIN) v = INT16_MIN;
+            rs->bank[(size_t)p * taps + (taps - 1 - k)] = (int16_t)v;
+        }
+    }
+
+    free(tmp);
+    return true;
+}
+
+resampler_handle_t resampler_create(uint32_t in_rate, uint32_t out_rate)
+{
+    if (in_rate == 0 || out_rate == 0) {
+        return NULL;
+    }
+
+    uint32_t g = rs_gcd(in_rate, out_rate);
+    if (out_rate / g > RESAMPLER_MAX_PHASES) {
+        return NULL;
+    }
+
+    resampler_handle_t rs = (resampler_handle_t)calloc(1, sizeof(struct resampler_s));
+    if (!rs) {
+        return NULL;
+    }
+    rs->up = out_rate / g;
+    rs->down = in_rate / g;
+
+    // 降采样时截止频率随输出采样率降低，抽头数按比例增加（取 4 的倍数）
+    rs->taps = RESAMPLER_TAPS;
+    if (in_rate > out_rate) {
+        rs->taps = (int)(((uint64_t)RESAMPLER_TAPS * in_rate + out_rate - 1) / out_rate);
+        rs->taps = (rs->taps + 3) & ~3;
+    }
+
+    rs->bank = (int16_t *)malloc((size_t)rs->up * rs->taps * sizeof(int16_t));
+    rs->buf = (int16_t *)malloc((rs->taps - 1 + RESAMPLER_CHUNK) * sizeof(int16_t));
+    if (!rs->bank || !rs->buf || !rs_build_bank(rs, in_rate, out_rate)) {
+        resampler_destroy(rs);
+        return NULL;
+    }
+
+    resampler_reset(rs);
+    return rs;
+}
+
+void resampler_destroy(resampler_handle_t rs)
+{
+    if (!rs) {
+        return;
+    }
+    free(rs->bank);
+    free(rs->buf);
+    free(rs);
+}
+
+void resampler_reset(resampler_handle_t rs)
+{
+    if (!rs) {
+        return;
+    }
+    memset(rs->buf, 0, (rs->taps - 1) * sizeof(int16_t));
+    rs->next = rs->taps - 1;
+    rs->phase = 0;
+}
+
+size_t resampler_max_output(resampler_handle_t rs, size_t in_samples)
+{
+    if (!rs) {
+        return 0;
+    }
+    return (in_samples * rs->up + rs->down - 1) / rs->down + 1;
+}
+
+size_t resampler_process(resampler_handle_t rs, const int16_t *in, size_t in_samples, int16_t *out)
+{
+    if (!rs || !in || !out) {
+        return 0;
+    }
+
+    const int taps = rs->taps;
+    const size_t hist = taps - 1;
+    const int32_t round = 1 << (rs->shift - 1);
+    size_t produced = 0;
+
+    while (in_samples > 0) {
+        size_t count = in_samples < RESAMPLER_CHUNK ? in_samples : RESAMPLER_CHUNK;
+        memcpy(rs->buf + hist, in, count * sizeof(int16_t));
+        size_t valid = hist + count;
+
+        // 每个输出采样点：选相位对应的一组系数，与最近 taps 个输入做点积
+        size_t next = rs->next;
+        uint32_t phase = rs->phase;
+        while (next < valid) {
+            const int16_t *x = rs->buf + next - hist;
+            const int16_t *c = rs->bank + (size_t)phase * taps;
+            int32_t acc = 0;
+            for (int k = 0; k < taps; k += 4) {
+                acc += (int32_t)c[k] * x[k] + (int32_t)c[k + 1] * x[k + 1] +
+                       (int32_t)c[k + 2] * x[k + 2] + (int32_t)c[k + 3] * x[k + 3];
+            }
+            acc = (acc + round) >> rs->shift;
+            if (acc > INT16_MAX) acc = INT16_MAX;
+            if (acc < INT16_MIN) acc = INT16_MIN;
+            out[produced++] = (int16_t)acc;
+
+            phase += rs->down;
+            next += phase / rs->up;
+            phase %= rs->up;
+        }
+
+        // 保留最后 taps - 1 个采样点作为下一块的历史
+        memmove(rs->buf, rs->buf + count, hist * sizeof(int16_t));
+        rs->next = next - count;
+        rs->phase = phase;
+        in += count;
+        in_samples -= count;
+    }
+
+    return produced;
+}
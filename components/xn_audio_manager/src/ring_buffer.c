@@ -11,6 +11,8 @@
 #include "ring_buffer.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
 #include <string.h>
 
 static const char *TAG = "RING_BUFFER";
@@ -18,22 +20,347 @@ static const char *TAG = "RING_BUFFER";
 /** 
  * @brief 环形缓冲区结构体
  * 
- * 线程安全的环形缓冲区实现，用于音频数据的临时存储。
+ * 单生产者/单消费者（SPSC）无锁环形缓冲区，用于音频数据的临时存储。
  * 特性：
  * - 使用 PSRAM 存储大容量音频数据
- * - 支持多线程并发访问（互斥锁保护）
- * - 可选的阻塞读取机制（信号量）
- * - 缓冲区满时自动覆盖旧数据
+ * - 读写位置为原子变量，写入路径无等待（wait-free），不再有互斥锁超时丢数据
+ * - 拷贝按环形回绕拆成至多两段 memcpy，不再逐样本取模
+ * - 可选的阻塞读取机制（信号量），消费者登记等待阈值，生产者只在
+ *   数据量达到阈值时唤醒，避免零碎唤醒；唤醒后总是重新检查条件，不会丢失唤醒
+ * - 缓冲区满时按溢出策略处理：覆盖旧数据（默认）、丢弃新数据或阻塞等待空间
+ * - 内置统计信息（溢出/欠载/水位/阻塞时间），热路径上不打印日志
+ * - 可选的高/低水位边沿回调，生产者可休眠等待空间而无需轮询
+ * - 可选的时间戳锚点，消费者可推算任意待读采样点的序号和时间
+ *
+ * 读写位置取值范围为 [0, 2 * size)，用于区分“满”和“空”两种状态，
+ * 因此整个容量 size 都可以存放数据。
+ * 覆盖旧数据时生产者通过 CAS 推进 read_pos；消费者在拷贝完成后同样通过 CAS
+ * 提交 read_pos，若期间被生产者覆盖（或被清空）则 CAS 失败并重新读取，
+ * 保证消费者不会返回被改写了一半的数据。
  */
 typedef struct ring_buffer_s {
     int16_t *buffer;              ///< 数据缓冲区（PSRAM），存储音频采样点
     size_t size;                  ///< 缓冲区大小（采样点数）
-    volatile size_t write_pos;    ///< 写位置索引（生产者）
-    volatile size_t read_pos;     ///< 读位置索引（消费者）
-    SemaphoreHandle_t mutex;      ///< 互斥锁，保护读写位置的原子性
+    atomic_size_t write_pos;      ///< 写位置（生产者独占推进），范围 [0, 2*size)
+    atomic_size_t read_pos;       ///< 读位置（消费者推进，覆盖时生产者也会推进），范围 [0, 2*size)
     SemaphoreHandle_t data_sem;   ///< 数据可用信号量（可选），用于阻塞读取
+    atomic_size_t data_threshold; ///< 消费者等待的最低数据量，0 表示没有等待者
+    atomic_bool wait_aborted;     ///< 消费者的等待被 ring_buffer_abort_wait 打断（一次性）
+    SemaphoreHandle_t space_sem;  ///< 空间可用信号量（启用信号量或 BLOCK 策略时创建），用于阻塞写入
+    atomic_size_t space_threshold;///< 生产者等待的最低剩余空间，0 表示没有等待者
+    ring_buffer_overflow_policy_t overflow_policy;  ///< 缓冲区满时的写入策略
+    uint32_t block_timeout_ms;    ///< BLOCK 策略的写入超时（毫秒）
+    size_t reserve_len;           ///< 当前预留的写入长度（生产者私有）
+    size_t peek_pos;              ///< 最近一次 peek 时的读位置（消费者私有）
+    size_t peek_len;              ///< 最近一次 peek 的长度（消费者私有）
+    ring_buffer_stats_t stats;    ///< 统计信息（写入侧字段由生产者更新，读取侧字段由消费者更新）
+    atomic_uint stats_wseq;       ///< 写入侧统计版本号（奇数表示生产者正在更新）
+    atomic_uint stats_rseq;       ///< 读取侧统计版本号（奇数表示消费者正在更新）
+    _Atomic(ring_buffer_watermark_cb_t) watermark_cb;  ///< 水位回调（原子发布，NULL 表示未启用）
+    atomic_uint watermark_seq;    ///< 水位参数版本号（奇数表示正在更新）
+    size_t low_watermark;         ///< 低水位（采样点数）
+    size_t high_watermark;        ///< 高水位（采样点数）
+    void *watermark_ctx;          ///< 水位回调上下文
+    atomic_bool low_armed;        ///< 数据量曾高于低水位，下降到低水位时触发
+    atomic_bool high_armed;       ///< 数据量曾低于高水位，上升到高水位时触发
+    uint64_t write_index;         ///< 已写入的采样点总数（生产者私有，不受统计清零影响）
+    atomic_uint stamp_seq;        ///< 时间戳锚点版本号（奇数表示生产者正在更新）
+    size_t stamp_pos;             ///< 锚点采样点的写位置
+    uint64_t stamp_index;         ///< 锚点采样点序号
+    int64_t stamp_us;             ///< 锚点时间戳（微秒）
+    uint32_t sample_rate;         ///< 采样率（0 表示尚未打时间戳）
 } ring_buffer_t;
 
+/**
+ * @brief 计算已占用的采样点数
+ */
+static inline size_t rb_used(const ring_buffer_t *rb, size_t write_pos, size_t read_pos)
+{
+    return (write_pos >= read_pos) ? (write_pos - read_pos)
+                                   : (write_pos + 2 * rb->size - read_pos);
+}
+
+/**
+ * @brief 将位置向前推进 n 个采样点（n <= size）
+ */
+static inline size_t rb_advance(const ring_buffer_t *rb, size_t pos, size_t n)
+{
+    pos += n;
+    if (pos >= 2 * rb->size) {
+        pos -= 2 * rb->size;
+    }
+    return pos;
+}
+
+/**
+ * @brief 将位置映射为缓冲区下标
+ */
+static inline size_t rb_index(const ring_buffer_t *rb, size_t pos)
+{
+    return (pos >= rb->size) ? (pos - rb->size) : pos;
+}
+
+/**
+ * @brief 从 pos 开始写入 n 个采样点（至多两段 memcpy）
+ */
+static void rb_copy_in(ring_buffer_t *rb, size_t pos, const int16_t *data, size_t n)
+{
+    size_t idx = rb_index(rb, pos);
+    size_t first = rb->size - idx;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(rb->buffer + idx, data, first * sizeof(int16_t));
+    if (n > first) {
+        memcpy(rb->buffer, data + first, (n - first) * sizeof(int16_t));
+    }
+}
+
+/**
+ * @brief 从 pos 开始读出 n 个采样点（至多两段 memcpy）
+ */
+static void rb_copy_out(const ring_buffer_t *rb, size_t pos, int16_t *out, size_t n)
+{
+    size_t idx = rb_index(rb, pos);
+    size_t first = rb->size - idx;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(out, rb->buffer + idx, first * sizeof(int16_t));
+    if (n > first) {
+        memcpy(out + first, rb->buffer, (n - first) * sizeof(int16_t));
+    }
+}
+
+/**
+ * @brief 开始更新 seqlock 保护的字段（版本号变为奇数），仅限该组字段唯一的写入者调用
+ */
+static inline void rb_seq_begin(atomic_uint *seq)
+{
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief 结束更新（版本号变回偶数），发布本次修改
+ */
+static inline void rb_seq_end(atomic_uint *seq)
+{
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+/**
+ * @brief 读取水位回调及其参数的一致快照
+ *
+ * 回调指针原子发布，参数由 watermark_seq 保护。读写路径不自旋等待：
+ * 快照期间 ring_buffer_set_watermarks 正在更新时本次跳过水位检查。
+ *
+ * @return 回调（未启用或正在更新时为 NULL）
+ */
+static inline ring_buffer_watermark_cb_t rb_watermark_snapshot(ring_buffer_t *rb, size_t *low,
+                                                                size_t *high, void **ctx)
+{
+    if (!atomic_load_explicit(&rb->watermark_cb, memory_order_relaxed)) {
+        return NULL;
+    }
+
+    unsigned seq = atomic_load_explicit(&rb->watermark_seq, memory_order_acquire);
+    ring_buffer_watermark_cb_t cb = atomic_load_explicit(&rb->watermark_cb, memory_order_relaxed);
+    *low = rb->low_watermark;
+    *high = rb->high_watermark;
+    *ctx = rb->watermark_ctx;
+    atomic_thread_fence(memory_order_acquire);
+    if ((seq & 1) || seq != atomic_load_explicit(&rb->watermark_seq, memory_order_relaxed)) {
+        return NULL;
+    }
+    return cb;
+}
+
+/**
+ * @brief 生产者发布数据后更新写入侧统计，唤醒达到阈值的等待者并检查高水位
+ */
+static inline void rb_on_write(ring_buffer_t *rb, size_t w, size_t n)
+{
+    rb->write_index += n;
+
+    // 与消费者登记阈值配对的全屏障，保证双方至少一方看到对方的更新
+    atomic_thread_fence(memory_order_seq_cst);
+    size_t r = atomic_load_explicit(&rb->read_pos, memory_order_relaxed);
+    size_t fill = rb_used(rb, w, r);
+
+    rb_seq_begin(&rb->stats_wseq);
+    rb->stats.total_written += n;
+    if (fill > rb->stats.max_fill) {
+        rb->stats.max_fill = fill;
+    }
+    rb_seq_end(&rb->stats_wseq);
+
+    // 只有数据量达到消费者等待的阈值时才唤醒
+    size_t threshold = atomic_load_explicit(&rb->data_threshold, memory_order_relaxed);
+    if (rb->data_sem && threshold > 0 && fill >= threshold) {
+        xSemaphoreGive(rb->data_sem);
+    }
+
+    // 水位边沿：上升到高水位时触发一次，高于低水位时重新装填低水位
+    size_t low, high;
+    void *ctx;
+    ring_buffer_watermark_cb_t cb = rb_watermark_snapshot(rb, &low, &high, &ctx);
+    if (cb) {
+        if (fill > low) {
+            atomic_store_explicit(&rb->low_armed, true, memory_order_relaxed);
+        }
+        if (fill >= high && atomic_exchange(&rb->high_armed, false)) {
+            cb(rb, RING_BUFFER_WATERMARK_HIGH, fill, ctx);
+        }
+    }
+}
+
+/**
+ * @brief 消费者读取后更新读取侧统计
+ */
+static inline void rb_stats_on_read(ring_buffer_t *rb, size_t requested, size_t got)
+{
+    rb_seq_begin(&rb->stats_rseq);
+    rb->stats.total_read += got;
+    if (got == 0) {
+        rb->stats.empty_reads++;
+    } else if (got < requested) {
+        rb->stats.underrun_events++;
+    }
+    rb_seq_end(&rb->stats_rseq);
+}
+
+/**
+ * @brief 生产者累计被丢弃的采样点数（旧数据或新数据）
+ */
+static inline void rb_stats_on_overrun(ring_buffer_t *rb, size_t dropped)
+{
+    rb_seq_begin(&rb->stats_wseq);
+    rb->stats.overrun_samples += dropped;
+    rb_seq_end(&rb->stats_wseq);
+}
+
+/**
+ * @brief 消费者腾出空间后唤醒等待空间的生产者并检查低水位
+ */
+static inline void rb_on_consume(ring_buffer_t *rb)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    size_t fill = ring_buffer_available(rb);
+
+    size_t threshold = atomic_load_explicit(&rb->space_threshold, memory_order_relaxed);
+    if (rb->space_sem && threshold > 0 && rb->size - fill >= threshold) {
+        xSemaphoreGive(rb->space_sem);
+    }
+
+    // 水位边沿：下降到低水位时触发一次，低于高水位时重新装填高水位
+    size_t low, high;
+    void *ctx;
+    ring_buffer_watermark_cb_t cb = rb_watermark_snapshot(rb, &low, &high, &ctx);
+    if (cb) {
+        if (fill < high) {
+            atomic_store_explicit(&rb->high_armed, true, memory_order_relaxed);
+        }
+        if (fill <= low && atomic_exchange(&rb->low_armed, false)) {
+            cb(rb, RING_BUFFER_WATERMARK_LOW, fill, ctx);
+        }
+    }
+}
+
+/**
+ * @brief 等待剩余空间达到 min_free 或到达截止时间，并累计阻塞时间
+ *
+ * @return 返回时的剩余空间
+ */
+static size_t rb_wait_space(ring_buffer_t *rb, size_t min_free, int64_t deadline)
+{
+    size_t free_space = rb->size - ring_buffer_available(rb);
+    if (!rb->space_sem || free_space >= min_free) {
+        return free_space;
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (;;) {
+        // 先登记阈值再检查空间，与消费者的通知配对
+        atomic_store_explicit(&rb->space_threshold, min_free, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        free_space = rb->size - ring_buffer_available(rb);
+        if (free_space >= min_free) {
+            break;
+        }
+
+        int64_t remain_us = deadline - esp_timer_get_time();
+        if (remain_us <= 0) {
+            break;
+        }
+        TickType_t ticks = pdMS_TO_TICKS((remain_us + 999) / 1000);
+        xSemaphoreTake(rb->space_sem, ticks > 0 ? ticks : 1);
+    }
+
+    atomic_store_explicit(&rb->space_threshold, 0, memory_order_relaxed);
+    rb_seq_begin(&rb->stats_wseq);
+    rb->stats.write_blocked_us += (uint64_t)(esp_timer_get_time() - start);
+    rb_seq_end(&rb->stats_wseq);
+    return free_space;
+}
+
+/**
+ * @brief 等待数据量达到 min_samples 或超时，并累计阻塞时间
+ * 
+ * @return 返回时的可读数据量
+ */
+static size_t rb_wait_data(ring_buffer_t *rb, size_t min_samples, uint32_t timeout_ms)
+{
+    size_t avail = ring_buffer_available(rb);
+    if (!rb->data_sem || timeout_ms == 0 || avail >= min_samples) {
+        return avail;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int64_t deadline = start + (int64_t)timeout_ms * 1000;
+
+    for (;;) {
+        // 先登记阈值再检查数据量，与生产者的通知配对
+        atomic_store_explicit(&rb->data_threshold, min_samples, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        avail = ring_buffer_available(rb);
+        if (avail >= min_samples || atomic_exchange(&rb->wait_aborted, false)) {
+            break;
+        }
+
+        int64_t remain_us = deadline - esp_timer_get_time();
+        if (remain_us <= 0) {
+            break;
+        }
+        TickType_t ticks = pdMS_TO_TICKS((remain_us + 999) / 1000);
+        xSemaphoreTake(rb->data_sem, ticks > 0 ? ticks : 1);
+    }
+
+    atomic_store_explicit(&rb->data_threshold, 0, memory_order_relaxed);
+    rb_seq_begin(&rb->stats_rseq);
+    rb->stats.blocked_us += (uint64_t)(esp_timer_get_time() - start);
+    rb_seq_end(&rb->stats_rseq);
+    return avail;
+}
+
+/**
+ * @brief 将 [pos, pos + n) 映射为至多两段连续内存
+ */
+static void rb_fill_span(const ring_buffer_t *rb, size_t pos, size_t n, ring_buffer_span_t *span)
+{
+    size_t idx = rb_index(rb, pos);
+    size_t first = rb->size - idx;
+    if (first > n) {
+        first = n;
+    }
+    span->data[0] = rb->buffer + idx;
+    span->len[0] = first;
+    span->data[1] = (n > first) ? rb->buffer : NULL;
+    span->len[1] = n - first;
+}
+
 /**
  * @brief 创建环形缓冲区
  * 
@@ -49,7 +376,7 @@ typedef struct ring_buffer_s {
  * @note 失败原因可能包括：
  *       - samples == 0（无效参数）
  *       - 内存不足（PSRAM 或 IRAM）
- *       - 互斥锁/信号量创建失败
+ *       - 信号量创建失败
  */
 ring_buffer_handle_t ring_buffer_create(size_t samples, bool with_sem)
 {
@@ -75,25 +402,43 @@ ring_buffer_handle_t ring_buffer_create(size_t samples, bool with_sem)
 
     // 初始化读写位置
     rb->size = samples;
-    rb->write_pos = 0;
-    rb->read_pos = 0;
-
-    // 创建互斥锁（保护并发访问）
-    rb->mutex = xSemaphoreCreateMutex();
-    if (!rb->mutex) {
-        ESP_LOGE(TAG, "互斥锁创建失败");
-        heap_caps_free(rb->buffer);
-        free(rb);
-        return NULL;
-    }
+    atomic_init(&rb->write_pos, 0);
+    atomic_init(&rb->read_pos, 0);
+    rb->reserve_len = 0;
+    rb->peek_pos = 0;
+    rb->peek_len = 0;
+    memset(&rb->stats, 0, sizeof(rb->stats));
+    rb->space_sem = NULL;
+    atomic_init(&rb->space_threshold, 0);
+    atomic_init(&rb->data_threshold, 0);
+    atomic_init(&rb->wait_aborted, false);
+    rb->overflow_policy = RING_BUFFER_OVERFLOW_DROP_OLDEST;
+    rb->block_timeout_ms = 0;
+    atomic_init(&rb->watermark_cb, NULL);
+    atomic_init(&rb->watermark_seq, 0);
+    rb->low_watermark = 0;
+    rb->high_watermark = samples;
+    rb->watermark_ctx = NULL;
+    atomic_init(&rb->low_armed, false);
+    atomic_init(&rb->high_armed, true);
+    rb->write_index = 0;
+    atomic_init(&rb->stamp_seq, 0);
+    atomic_init(&rb->stats_wseq, 0);
+    atomic_init(&rb->stats_rseq, 0);
+    rb->stamp_pos = 0;
+    rb->stamp_index = 0;
+    rb->stamp_us = 0;
+    rb->sample_rate = 0;
 
-    // 可选：创建数据可用信号量（用于阻塞读取）
+    // 可选：创建数据可用/空间可用信号量（用于阻塞读取和等待空间）
     rb->data_sem = NULL;
     if (with_sem) {
         rb->data_sem = xSemaphoreCreateBinary();
-        if (!rb->data_sem) {
+        rb->space_sem = xSemaphoreCreateBinary();
+        if (!rb->data_sem || !rb->space_sem) {
             ESP_LOGE(TAG, "信号量创建失败");
-            vSemaphoreDelete(rb->mutex);
+            if (rb->data_sem) vSemaphoreDelete(rb->data_sem);
+            if (rb->space_sem) vSemaphoreDelete(rb->space_sem);
             heap_caps_free(rb->buffer);
             free(rb);
             return NULL;
@@ -112,7 +457,7 @@ ring_buffer_handle_t ring_buffer_create(size_t samples, bool with_sem)
  * @brief 销毁环形缓冲区
  * 
  * 释放所有资源：
- * - 删除互斥锁和信号量
+ * - 删除信号量
  * - 释放缓冲区内存（PSRAM）
  * - 释放句柄结构体
  * 
@@ -125,12 +470,12 @@ void ring_buffer_destroy(ring_buffer_handle_t rb)
     if (!rb) return;
 
     // 删除同步对象
-    if (rb->mutex) {
-        vSemaphoreDelete(rb->mutex);
-    }
     if (rb->data_sem) {
         vSemaphoreDelete(rb->data_sem);
     }
+    if (rb->space_sem) {
+        vSemaphoreDelete(rb->space_sem);
+    }
     
     // 释放缓冲区内存
     if (rb->buffer) {
@@ -141,20 +486,69 @@ void ring_buffer_destroy(ring_buffer_handle_t rb)
     free(rb);
 }
 
+/**
+ * @brief 写入至多 n 个采样点（不阻塞）
+ * 
+ * @param overwrite true 空间不足时推进 read_pos 覆盖旧数据；false 只写入剩余空间
+ * @return 实际写入的采样点数
+ */
+static size_t rb_write_some(ring_buffer_t *rb, const int16_t *data, size_t n, bool overwrite)
+{
+    // write_pos 只有生产者修改，relaxed 读取即可
+    size_t w = atomic_load_explicit(&rb->write_pos, memory_order_relaxed);
+    size_t r = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+
+    if (!overwrite) {
+        size_t free_space = rb->size - rb_used(rb, w, r);
+        if (n > free_space) {
+            n = free_space;
+        }
+    } else {
+        // 空间不足：推进 read_pos 丢弃最旧数据（与消费者的提交竞争，CAS 失败则重算）
+        for (;;) {
+            size_t used = rb_used(rb, w, r);
+            if (used + n <= rb->size) {
+                break;
+            }
+            size_t drop = used + n - rb->size;
+            if (atomic_compare_exchange_weak_explicit(&rb->read_pos, &r, rb_advance(rb, r, drop),
+                                                      memory_order_acq_rel, memory_order_acquire)) {
+                rb_stats_on_overrun(rb, drop);
+                break;
+            }
+        }
+    }
+
+    if (n == 0) {
+        return 0;
+    }
+
+    // 拷贝数据后再发布 write_pos，保证消费者看到完整数据
+    rb_copy_in(rb, w, data, n);
+    w = rb_advance(rb, w, n);
+    atomic_store_explicit(&rb->write_pos, w, memory_order_release);
+    // 更新统计，数据量达到等待阈值时唤醒消费者
+    rb_on_write(rb, w, n);
+    return n;
+}
+
 /**
  * @brief 写入数据到环形缓冲区
  * 
- * 将音频采样数据写入缓冲区。如果缓冲区满，会覆盖最旧的数据。
+ * 将音频采样数据写入缓冲区。缓冲区满时按溢出策略处理：
+ * - DROP_OLDEST: 覆盖最旧的数据，总是接受全部数据
+ * - DROP_NEWEST: 只写入剩余空间，丢弃写不下的部分
+ * - BLOCK: 等待消费者腾出空间，超时后丢弃剩余部分（对生产者形成反压）
  * 
  * @param rb 环形缓冲区句柄
  * @param data 待写入的数据指针（int16_t 数组）
  * @param samples 采样点数
  * 
- * @return 实际写入的采样点数（通常等于 samples）
+ * @return 实际接受的采样点数，生产者可据此控制发送节奏
  * 
- * @note 线程安全：内部使用互斥锁保护
- * @note 缓冲区溢出时会打印警告日志
- * @note 写入后会触发 data_sem 信号量（如果存在）
+ * @note 仅允许单个生产者调用；无锁，非 BLOCK 策略下无等待
+ * @note 溢出不打印日志，丢弃的样本数计入 overrun_samples 统计
+ * @note 数据量达到消费者等待的阈值时触发 data_sem 信号量（如果存在）
  */
 size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t samples)
 {
@@ -162,40 +556,42 @@ size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t sa
         return 0;
     }
 
-    // 获取互斥锁（超时 10ms）
-    if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
-        return 0;
+    if (rb->overflow_policy == RING_BUFFER_OVERFLOW_DROP_OLDEST) {
+        size_t n = samples;
+        // 单次写入超过容量时只保留最新的 size 个采样点
+        if (n > rb->size) {
+            rb_stats_on_overrun(rb, n - rb->size);
+            data += n - rb->size;
+            n = rb->size;
+        }
+        rb_write_some(rb, data, n, true);
+        return samples;
     }
 
-    size_t overrun_count = 0;  // 记录被覆盖的样本数
+    size_t written = rb_write_some(rb, data, samples, false);
 
-    // 逐个写入采样点
-    for (size_t i = 0; i < samples; i++) {
-        rb->buffer[rb->write_pos] = data[i];
-        rb->write_pos = (rb->write_pos + 1) % rb->size;
+    if (rb->overflow_policy == RING_BUFFER_OVERFLOW_BLOCK && written < samples && rb->space_sem) {
+        int64_t deadline = esp_timer_get_time() + (int64_t)rb->block_timeout_ms * 1000;
 
-        // 检测缓冲区满：写指针追上读指针
-        if (rb->write_pos == rb->read_pos) {
-            rb->read_pos = (rb->read_pos + 1) % rb->size;  // 丢弃最旧数据
-            overrun_count++;
+        while (written < samples) {
+            // 等待足够放下剩余数据的空间（超过容量时等待整个缓冲区空出）
+            size_t want = samples - written;
+            if (want > rb->size) {
+                want = rb->size;
+            }
+            size_t free_space = rb_wait_space(rb, want, deadline);
+            written += rb_write_some(rb, data + written, samples - written, false);
+            if (free_space < want) {
+                break;  // 超时
+            }
         }
     }
 
-    xSemaphoreGive(rb->mutex);
-
-    // 缓冲区溢出警告（假设 16kHz 采样率）
-    if (overrun_count > 0) {
-        ESP_LOGW(TAG, "⚠️ 缓冲区溢出！丢弃 %u 样本 (%.1f ms)", 
-                 (unsigned)overrun_count, 
-                 (float)overrun_count / 16.0f);
-    }
-
-    // 通知有数据可读（触发阻塞读取）
-    if (rb->data_sem) {
-        xSemaphoreGive(rb->data_sem);
+    // 丢弃写不下的新数据
+    if (written < samples) {
+        rb_stats_on_overrun(rb, samples - written);
     }
-
-    return samples;
+    return written;
 }
 
 /**
@@ -212,7 +608,7 @@ size_t ring_buffer_write(ring_buffer_handle_t rb, const int16_t *data, size_t sa
  * 
  * @return 实际读取的采样点数（可能小于 samples）
  * 
- * @note 线程安全：内部使用互斥锁保护
+ * @note 仅允许单个消费者调用；无锁
  * @note 如果缓冲区为空且 timeout_ms > 0，会阻塞等待新数据
  */
 size_t ring_buffer_read(ring_buffer_handle_t rb, int16_t *out, size_t samples, uint32_t timeout_ms)
@@ -222,81 +618,471 @@ size_t ring_buffer_read(ring_buffer_handle_t rb, int16_t *out, size_t samples, u
     }
 
     // 如果缓冲区为空且有信号量，等待数据
-    if (rb->read_pos == rb->write_pos && rb->data_sem && timeout_ms > 0) {
-        xSemaphoreTake(rb->data_sem, pdMS_TO_TICKS(timeout_ms));
+    rb_wait_data(rb, 1, timeout_ms);
+
+    for (;;) {
+        size_t r = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+        size_t w = atomic_load_explicit(&rb->write_pos, memory_order_acquire);
+
+        // 限制读取量为可用数据量
+        size_t count = rb_used(rb, w, r);
+        if (count > samples) {
+            count = samples;
+        }
+        if (count == 0) {
+            rb_stats_on_read(rb, samples, 0);
+            return 0;
+        }
+
+        rb_copy_out(rb, r, out, count);
+
+        // 提交读位置；失败说明期间被生产者覆盖或被清空，重新读取
+        if (atomic_compare_exchange_strong_explicit(&rb->read_pos, &r, rb_advance(rb, r, count),
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            rb_stats_on_read(rb, samples, count);
+            rb_on_consume(rb);
+            return count;
+        }
     }
+}
 
-    // 获取互斥锁（超时 10ms）
-    if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
-        return 0;
+/**
+ * @brief 设置缓冲区满时的写入策略
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param policy 溢出策略
+ * @param block_timeout_ms BLOCK 策略下单次 ring_buffer_write() 最长等待时间（毫秒）
+ * 
+ * @return 
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数无效
+ *   - ESP_ERR_NO_MEM: 空间信号量创建失败
+ * 
+ * @note 应在生产者开始写入前设置，BLOCK 策略首次设置时创建空间信号量
+ */
+esp_err_t ring_buffer_set_overflow_policy(ring_buffer_handle_t rb,
+                                          ring_buffer_overflow_policy_t policy,
+                                          uint32_t block_timeout_ms)
+{
+    if (!rb || policy > RING_BUFFER_OVERFLOW_BLOCK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (policy == RING_BUFFER_OVERFLOW_BLOCK && !rb->space_sem) {
+        rb->space_sem = xSemaphoreCreateBinary();
+        if (!rb->space_sem) {
+            ESP_LOGE(TAG, "空间信号量创建失败");
+            return ESP_ERR_NO_MEM;
+        }
     }
 
-    // 计算可用数据量
-    size_t avail = (rb->write_pos >= rb->read_pos)
-                   ? (rb->write_pos - rb->read_pos)
-                   : (rb->size - rb->read_pos + rb->write_pos);
+    rb->block_timeout_ms = block_timeout_ms;
+    rb->overflow_policy = policy;
+    return ESP_OK;
+}
 
-    // 限制读取量为可用数据量
-    if (samples > avail) {
-        samples = avail;
+/**
+ * @brief 预留写入区间
+ * 
+ * 返回缓冲区内部可直接写入的内存区间，调用者写完后调用
+ * ring_buffer_commit_write() 发布，省去一次中间缓冲区拷贝。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param samples 期望写入的采样点数
+ * @param span 输出区间（回绕时为两段）
+ * 
+ * @return 实际预留的采样点数，受剩余空间限制
+ * 
+ * @note 与 ring_buffer_write() 不同，预留不会覆盖未读数据
+ * @note 仅允许单个生产者调用
+ */
+size_t ring_buffer_reserve_write(ring_buffer_handle_t rb, size_t samples, ring_buffer_span_t *span)
+{
+    if (!rb || !span) {
+        return 0;
     }
 
-    // 读取数据
-    for (size_t i = 0; i < samples; i++) {
-        out[i] = rb->buffer[rb->read_pos];
-        rb->read_pos = (rb->read_pos + 1) % rb->size;
+    size_t w = atomic_load_explicit(&rb->write_pos, memory_order_relaxed);
+    size_t r = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+    size_t free_space = rb->size - rb_used(rb, w, r);
+    if (samples > free_space) {
+        samples = free_space;
     }
 
-    xSemaphoreGive(rb->mutex);
+    rb_fill_span(rb, w, samples, span);
+    rb->reserve_len = samples;
+    return samples;
+}
 
+/**
+ * @brief 提交预留区间中已写入的数据
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param samples 提交的采样点数，超过预留量时截断
+ * 
+ * @return 实际提交的采样点数
+ * 
+ * @note 数据量达到消费者等待的阈值时触发 data_sem 信号量（如果存在）
+ */
+size_t ring_buffer_commit_write(ring_buffer_handle_t rb, size_t samples)
+{
+    if (!rb) {
+        return 0;
+    }
+
+    if (samples > rb->reserve_len) {
+        samples = rb->reserve_len;
+    }
+    rb->reserve_len = 0;
+    if (samples == 0) {
+        return 0;
+    }
+
+    size_t w = atomic_load_explicit(&rb->write_pos, memory_order_relaxed);
+    w = rb_advance(rb, w, samples);
+    atomic_store_explicit(&rb->write_pos, w, memory_order_release);
+    rb_on_write(rb, w, samples);
     return samples;
 }
 
 /**
- * @brief 获取环形缓冲区中可用的数据量
+ * @brief 查看可读区间
  * 
- * 查询当前缓冲区中未读取的采样点数量。
+ * 返回缓冲区内部可直接读取的内存区间，调用者处理完后调用
+ * ring_buffer_release_read() 释放，省去拷贝到临时缓冲区的开销。
  * 
  * @param rb 环形缓冲区句柄
- * @return 可用的采样点数
+ * @param samples 期望读取的采样点数
+ * @param span 输出区间（回绕时为两段）
+ * @param timeout_ms 超时时间（毫秒），语义同 ring_buffer_read()
  * 
- * @note 线程安全：内部使用互斥锁保护
- * @note 返回值为瞬时快照，可能在返回后立即改变
+ * @return 区间内的采样点数（可能小于 samples）
+ * 
+ * @note 仅允许单个消费者调用
+ * @note 生产者使用 ring_buffer_write() 覆盖旧数据时可能改写该区间，
+ *       此时 ring_buffer_release_read() 返回 false
  */
-size_t ring_buffer_available(ring_buffer_handle_t rb)
+size_t ring_buffer_peek_read(ring_buffer_handle_t rb, size_t samples,
+                             ring_buffer_span_t *span, uint32_t timeout_ms)
+{
+    if (!rb || !span) {
+        return 0;
+    }
+
+    rb_wait_data(rb, 1, timeout_ms);
+
+    size_t r = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+    size_t w = atomic_load_explicit(&rb->write_pos, memory_order_acquire);
+    size_t count = rb_used(rb, w, r);
+    if (count > samples) {
+        count = samples;
+    }
+    rb_stats_on_read(rb, samples, count);
+
+    rb_fill_span(rb, r, count, span);
+    rb->peek_pos = r;
+    rb->peek_len = count;
+    return count;
+}
+
+/**
+ * @brief 释放已处理的可读区间
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param samples 释放的采样点数，超过查看量时截断
+ * 
+ * @return 
+ *   - true: 释放成功
+ *   - false: 查看期间读位置被生产者（覆盖）或 ring_buffer_clear() 改变，
+ *            区间数据可能已失效，读位置保持为新的值
+ */
+bool ring_buffer_release_read(ring_buffer_handle_t rb, size_t samples)
 {
     if (!rb) {
+        return false;
+    }
+
+    if (samples > rb->peek_len) {
+        samples = rb->peek_len;
+    }
+    rb->peek_len = 0;
+
+    size_t r = rb->peek_pos;
+    bool ok = atomic_compare_exchange_strong_explicit(&rb->read_pos, &r, rb_advance(rb, r, samples),
+                                                      memory_order_acq_rel, memory_order_acquire);
+    if (!ok) {
+        rb_seq_begin(&rb->stats_rseq);
+        rb->stats.peek_overruns++;
+        rb_seq_end(&rb->stats_rseq);
+    }
+    rb_on_consume(rb);
+    return ok;
+}
+
+/**
+ * @brief 阻塞读取至少 min_samples 个采样点
+ * 
+ * 等待数据量达到 min_samples（或超时）后一次性读取，调用者每次醒来都能
+ * 拿到完整的帧，而不是零碎的片段。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param out 输出缓冲区
+ * @param samples 最多读取的采样点数
+ * @param min_samples 至少等待的采样点数（超过 samples 或容量时截断）
+ * @param timeout_ms 最长等待时间（毫秒），超时后返回已有的数据
+ * 
+ * @return 实际读取的采样点数
+ * 
+ * @note 仅允许单个消费者调用
+ */
+size_t ring_buffer_read_min(ring_buffer_handle_t rb, int16_t *out, size_t samples,
+                            size_t min_samples, uint32_t timeout_ms)
+{
+    if (!rb || !out || samples == 0) {
         return 0;
     }
 
-    // 获取互斥锁（超时 10ms）
-    if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+    ring_buffer_wait_available(rb, min_samples < samples ? min_samples : samples, timeout_ms);
+    return ring_buffer_read(rb, out, samples, 0);
+}
+
+/**
+ * @brief 等待可读数据量达到 min_samples
+ * 
+ * 消费者登记等待阈值后休眠，生产者只在数据量达到阈值时唤醒，
+ * 可与 ring_buffer_peek_read() 配合实现按整帧零拷贝读取。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param min_samples 等待的最低数据量（超过容量时截断为容量）
+ * @param timeout_ms 最长等待时间（毫秒），0 表示不阻塞
+ * 
+ * @return 返回时的可读数据量（超时时可能小于 min_samples）
+ * 
+ * @note 需要创建时启用信号量；仅允许单个消费者调用
+ */
+size_t ring_buffer_wait_available(ring_buffer_handle_t rb, size_t min_samples, uint32_t timeout_ms)
+{
+    if (!rb) {
         return 0;
     }
 
-    // 计算可用数据量（处理环形回绕）
-    size_t avail = (rb->write_pos >= rb->read_pos)
-                   ? (rb->write_pos - rb->read_pos)
-                   : (rb->size - rb->read_pos + rb->write_pos);
+    if (min_samples == 0) {
+        min_samples = 1;
+    }
+    if (min_samples > rb->size) {
+        min_samples = rb->size;
+    }
+    return rb_wait_data(rb, min_samples, timeout_ms);
+}
+
+/**
+ * @brief 打断消费者的阻塞等待
+ *
+ * 置位一次性标志后释放数据信号量，等待循环检查到标志后立即返回，
+ * 用于停止播放时唤醒阻塞在播放缓冲区上的播放任务。
+ *
+ * @param rb 环形缓冲区句柄
+ */
+void ring_buffer_abort_wait(ring_buffer_handle_t rb)
+{
+    if (!rb || !rb->data_sem) {
+        return;
+    }
 
-    xSemaphoreGive(rb->mutex);
+    atomic_store(&rb->wait_aborted, true);
+    xSemaphoreGive(rb->data_sem);
+}
 
-    return avail;
+/**
+ * @brief 等待剩余空间达到 min_free
+ *
+ * 生产者登记等待的空间后休眠，消费者腾出足够空间时唤醒，替代轮询剩余空间。
+ *
+ * @param rb 环形缓冲区句柄
+ * @param min_free 等待的最低剩余空间（超过容量时截断为容量）
+ * @param timeout_ms 最长等待时间（毫秒），0 表示不阻塞
+ *
+ * @return 返回时的剩余空间（超时时可能小于 min_free）
+ *
+ * @note 需要创建时启用信号量或设置了 BLOCK 策略；仅允许单个生产者调用
+ */
+size_t ring_buffer_wait_free(ring_buffer_handle_t rb, size_t min_free, uint32_t timeout_ms)
+{
+    if (!rb) {
+        return 0;
+    }
+
+    if (min_free == 0) {
+        min_free = 1;
+    }
+    if (min_free > rb->size) {
+        min_free = rb->size;
+    }
+    return rb_wait_space(rb, min_free, esp_timer_get_time() + (int64_t)timeout_ms * 1000);
+}
+
+/**
+ * @brief 设置高/低水位回调
+ *
+ * 边沿触发：数据量从高于 low 下降到不高于 low 时触发一次 LOW（消费者上下文），
+ * 从低于 high 上升到不低于 high 时触发一次 HIGH（生产者上下文）。
+ * 生产者可在 LOW 回调中唤醒自己继续填充，消费者可在 HIGH 回调中被唤醒处理数据。
+ *
+ * @param rb 环形缓冲区句柄
+ * @param low 低水位（采样点数）
+ * @param high 高水位（采样点数），需大于 low 且不超过容量
+ * @param callback 水位回调，NULL 表示关闭
+ * @param user_ctx 回调上下文
+ *
+ * @return
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数无效
+ *
+ * @note 回调在读写路径中直接调用，必须简短且不能阻塞（例如 xTaskNotifyGive）
+ * @note 可以在读写期间从其他任务调用（同一时刻只允许一个任务设置）：回调指针原子发布，
+ *       参数按版本号更新，读写路径只会看到完整的旧设置或新设置（更新期间跳过水位检查）
+ */
+esp_err_t ring_buffer_set_watermarks(ring_buffer_handle_t rb, size_t low, size_t high,
+                                     ring_buffer_watermark_cb_t callback, void *user_ctx)
+{
+    if (!rb || (callback && (low >= high || high > rb->size))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    unsigned seq = atomic_load_explicit(&rb->watermark_seq, memory_order_relaxed);
+    atomic_store_explicit(&rb->watermark_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    rb->low_watermark = low;
+    rb->high_watermark = high;
+    rb->watermark_ctx = user_ctx;
+    size_t fill = ring_buffer_available(rb);
+    atomic_store(&rb->low_armed, fill > low);
+    atomic_store(&rb->high_armed, fill < high);
+    atomic_store_explicit(&rb->watermark_cb, callback, memory_order_relaxed);
+
+    atomic_store_explicit(&rb->watermark_seq, seq + 2, memory_order_release);
+    return ESP_OK;
+}
+
+/**
+ * @brief 为下一个写入的采样点打时间戳
+ * 
+ * 记录一个锚点（写位置、采样点序号、时间戳），消费者据此按采样率推算
+ * 待读采样点的时间。通常每写入一块数据前调用一次，锚点总是靠近写入端，
+ * 与读位置的距离不超过容量，因此可以用环形位置直接换算。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param timestamp_us 下一个写入采样点的时间戳（微秒）
+ * @param sample_rate 采样率（Hz）
+ * 
+ * @note 仅允许生产者调用；锚点用版本号保护（seqlock），消费者不会读到半更新的值
+ */
+void ring_buffer_stamp(ring_buffer_handle_t rb, int64_t timestamp_us, uint32_t sample_rate)
+{
+    if (!rb || sample_rate == 0) {
+        return;
+    }
+
+    unsigned seq = atomic_load_explicit(&rb->stamp_seq, memory_order_relaxed);
+    atomic_store_explicit(&rb->stamp_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    rb->stamp_pos = atomic_load_explicit(&rb->write_pos, memory_order_relaxed);
+    rb->stamp_index = rb->write_index;
+    rb->stamp_us = timestamp_us;
+    rb->sample_rate = sample_rate;
+
+    atomic_store_explicit(&rb->stamp_seq, seq + 2, memory_order_release);
+}
+
+/**
+ * @brief 获取下一个待读采样点的序号和时间戳
+ * 
+ * 由最近的锚点按读位置与锚点的距离推算：读位置可能在锚点之前（锚点所在块尚未读到），
+ * 也可能在锚点之后（已读了锚点所在块的一部分）。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param info 输出帧时间信息
+ * 
+ * @return 
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数无效
+ *   - ESP_ERR_INVALID_STATE: 生产者尚未打过时间戳
+ */
+esp_err_t ring_buffer_get_read_info(ring_buffer_handle_t rb, audio_frame_info_t *info)
+{
+    if (!rb || !info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t pos;
+    uint64_t index;
+    int64_t ts;
+    uint32_t rate;
+    unsigned seq;
+    do {
+        seq = atomic_load_explicit(&rb->stamp_seq, memory_order_acquire);
+        pos = rb->stamp_pos;
+        index = rb->stamp_index;
+        ts = rb->stamp_us;
+        rate = rb->sample_rate;
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != atomic_load_explicit(&rb->stamp_seq, memory_order_relaxed));
+
+    if (rate == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t r = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+    size_t ahead = rb_used(rb, r, pos);   // 读位置领先锚点的距离（环形）
+    if (ahead <= rb->size) {
+        info->sample_index = index + ahead;
+        info->timestamp_us = ts + (int64_t)ahead * 1000000 / rate;
+    } else {
+        size_t behind = 2 * rb->size - ahead;
+        info->sample_index = index - behind;
+        info->timestamp_us = ts - (int64_t)behind * 1000000 / rate;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取环形缓冲区中可用的数据量
+ * 
+ * 查询当前缓冲区中未读取的采样点数量。
+ * 
+ * @param rb 环形缓冲区句柄
+ * @return 可用的采样点数
+ * 
+ * @note 无锁：只读取两个原子位置，可在任意任务中调用
+ * @note 返回值为瞬时快照，可能在返回后立即改变
+ */
+size_t ring_buffer_available(ring_buffer_handle_t rb)
+{
+    if (!rb) {
+        return 0;
+    }
+
+    size_t r = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+    size_t w = atomic_load_explicit(&rb->write_pos, memory_order_acquire);
+    return rb_used(rb, w, r);
 }
 
 /**
  * @brief 清空环形缓冲区
  * 
- * 重置读写位置，丢弃所有未读数据。
+ * 将读位置推进到写位置，丢弃所有未读数据。
  * 
  * @param rb 环形缓冲区句柄
  * @return 
  *   - ESP_OK: 成功
  *   - ESP_ERR_INVALID_ARG: rb 为 NULL
- *   - ESP_ERR_TIMEOUT: 获取互斥锁超时
  * 
- * @note 线程安全：内部使用互斥锁保护
- * @note 不会清零缓冲区内存，只重置指针
+ * @note 只能由消费者（或生产者，与覆盖写入相同）调用：通过 CAS 推进读位置，
+ *       并在调用者上下文中唤醒等待空间的生产者、触发低水位回调；
+ *       其他任务需要清空时应请求消费者执行（见 playback_controller_clear）
+ * @note 不会清零缓冲区内存，只移动读位置
  */
 esp_err_t ring_buffer_clear(ring_buffer_handle_t rb)
 {
@@ -304,20 +1090,77 @@ esp_err_t ring_buffer_clear(ring_buffer_handle_t rb)
         return ESP_ERR_INVALID_ARG;
     }
 
-    // 获取互斥锁（超时 100ms）
-    if (xSemaphoreTake(rb->mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return ESP_ERR_TIMEOUT;
+    size_t r = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+    size_t w;
+    do {
+        w = atomic_load_explicit(&rb->write_pos, memory_order_acquire);
+    } while (!atomic_compare_exchange_weak_explicit(&rb->read_pos, &r, w,
+                                                    memory_order_acq_rel, memory_order_acquire));
+
+    rb_on_consume(rb);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取环形缓冲区统计信息
+ * 
+ * @param rb 环形缓冲区句柄
+ * @param stats 输出统计信息
+ * @return 
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数无效
+ * 
+ * @note 无锁：写入侧和读取侧字段各有一个写入者，分别用版本号（seqlock）取一致快照，
+ *       64 位计数在 32 位 CPU 上也不会读到半更新的值。先取读取侧再取写入侧，
+ *       快照中 total_read 不会超过 total_written；适合周期性轮询
+ */
+esp_err_t ring_buffer_get_stats(ring_buffer_handle_t rb, ring_buffer_stats_t *stats)
+{
+    if (!rb || !stats) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // 重置读写位置
-    rb->read_pos = 0;
-    rb->write_pos = 0;
+    ring_buffer_stats_t snap;
+    unsigned seq;
+    do {
+        seq = atomic_load_explicit(&rb->stats_rseq, memory_order_acquire);
+        snap.total_read = rb->stats.total_read;
+        snap.underrun_events = rb->stats.underrun_events;
+        snap.empty_reads = rb->stats.empty_reads;
+        snap.peek_overruns = rb->stats.peek_overruns;
+        snap.blocked_us = rb->stats.blocked_us;
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != atomic_load_explicit(&rb->stats_rseq, memory_order_relaxed));
 
-    xSemaphoreGive(rb->mutex);
+    do {
+        seq = atomic_load_explicit(&rb->stats_wseq, memory_order_acquire);
+        snap.total_written = rb->stats.total_written;
+        snap.overrun_samples = rb->stats.overrun_samples;
+        snap.max_fill = rb->stats.max_fill;
+        snap.write_blocked_us = rb->stats.write_blocked_us;
+        atomic_thread_fence(memory_order_acquire);
+    } while ((seq & 1) || seq != atomic_load_explicit(&rb->stats_wseq, memory_order_relaxed));
 
+    *stats = snap;
     return ESP_OK;
 }
 
+/**
+ * @brief 清零环形缓冲区统计信息
+ * 
+ * @param rb 环形缓冲区句柄
+ * 
+ * @note 不经过版本号（调用者不是统计字段的写入者）：与读写并发调用时，
+ *       个别计数可能丢失一次更新，并发的 ring_buffer_get_stats 可能混入清零前的值
+ */
+void ring_buffer_reset_stats(ring_buffer_handle_t rb)
+{
+    if (!rb) {
+        return;
+    }
+    memset(&rb->stats, 0, sizeof(ring_buffer_stats_t));
+}
+
 /**
  * @brief 获取环形缓冲区的容量
  * 
@@ -0,0 +1,184 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\src\soft_vad.c
+ * @Description: 轻量软件 VAD 实现
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "soft_vad.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define SOFT_VAD_FRAME_MS           20
+#define SOFT_VAD_DEFAULT_START_MS   200
+#define SOFT_VAD_DEFAULT_HANGOVER   400
+#define SOFT_VAD_DEFAULT_THRESH_DB  12.0f
+#define SOFT_VAD_FLOOR_MIN_DB       20.0f   ///< 噪声基底下限（约 10 LSB RMS，避免数字静音时误触发）
+#define SOFT_VAD_FLOOR_SUB_FRAMES   25      ///< 最小值统计的子窗口（25 帧 = 0.5 秒）
+#define SOFT_VAD_FLOOR_SUBWINDOWS   8       ///< 子窗口个数（噪声基底取最近 4 秒的最小帧能量）
+#define SOFT_VAD_MIN_ZCR            0.01f   ///< 低于此过零率视为低频嗡声/直流（语音基频至少约 80Hz）
+#define SOFT_VAD_FRICATIVE_ZCR      0.25f   ///< 高于此过零率按清辅音放宽阈值
+
+/**
+ * @brief 软件 VAD 结构体
+ */
+struct soft_vad_s {
+    uint32_t frame_len;         ///< 帧长（采样点数）
+    uint32_t start_frames;      ///< 判定开始所需语音帧数
+    uint32_t hangover_frames;   ///< 判定结束所需静音帧数
+    float threshold_db;         ///< 语音帧阈值
+
+    uint64_t energy;            ///< 当前帧平方和
+    uint32_t crossings;         ///< 当前帧过零次数
+    uint32_t filled;            ///< 当前帧已累加点数
+    bool prev_negative;         ///< 上一个采样点是否为负
+
+    bool floor_valid;           ///< 噪声基底是否已初始化
+    float floor_db;             ///< 噪声基底
+    float sub_min[SOFT_VAD_FLOOR_SUBWINDOWS];  ///< 各子窗口的最小帧能量（环形）
+    float cur_min;              ///< 当前子窗口的最小帧能量
+    uint32_t sub_frames;        ///< 当前子窗口已处理帧数
+    uint32_t sub_pos;           ///< 下一个写入的子窗口
+    bool speech;                ///< 当前状态
+    uint32_t run;               ///< 静音状态下的语音帧计数（非语音帧递减）
+    uint32_t quiet;             ///< 人声状态下连续非语音帧数
+};
+
+soft_vad_handle_t soft_vad_create(const soft_vad_config_t *config)
+{
+    soft_vad_handle_t vad = (soft_vad_handle_t)calloc(1, sizeof(struct soft_vad_s));
+    if (!vad) {
+        return NULL;
+    }
+
+    soft_vad_config_t cfg = config ? *config : (soft_vad_config_t){0};
+    uint32_t rate = cfg.sample_rate ? cfg.sample_rate : 16000;
+    uint32_t start_ms = cfg.start_ms ? cfg.start_ms : SOFT_VAD_DEFAULT_START_MS;
+    uint32_t hangover_ms = cfg.hangover_ms ? cfg.hangover_ms : SOFT_VAD_DEFAULT_HANGOVER;
+
+    vad->frame_len = rate * SOFT_VAD_FRAME_MS / 1000;
+    vad->start_frames = (start_ms + SOFT_VAD_FRAME_MS - 1) / SOFT_VAD_FRAME_MS;
+    vad->hangover_frames = (hangover_ms + SOFT_VAD_FRAME_MS - 1) / SOFT_VAD_FRAME_MS;
+    vad->threshold_db = cfg.threshold_db > 0 ? cfg.threshold_db : SOFT_VAD_DEFAULT_THRESH_DB;
+    return vad;
+}
+
+void soft_vad_destroy(soft_vad_handle_t vad)
+{
+    free(vad);
+}
+
+void soft_vad_reset(soft_vad_handle_t vad)
+{
+    if (!vad) {
+        return;
+    }
+
+    vad->energy = 0;
+    vad->crossings = 0;
+    vad->filled = 0;
+    vad->floor_valid = false;
+    vad->speech = false;
+    vad->run = 0;
+    vad->quiet = 0;
+}
+
+/**
+ * @brief 处理一个完整帧：更新噪声基底和状态
+ */
+static void soft_vad_frame(soft_vad_handle_t vad)
+{
+    float level_db = 10.0f * log10f((float)vad->energy / vad->frame_len + 1.0f);
+    float zcr = (float)vad->crossings / vad->frame_len;
+
+    if (!vad->floor_valid) {
+        for (int i = 0; i < SOFT_VAD_FLOOR_SUBWINDOWS; i++) {
+            vad->sub_min[i] = level_db;
+        }
+        vad->cur_min = level_db;
+        vad->sub_frames = 0;
+        vad->floor_valid = true;
+    }
+
+    // 最小值统计：基底取最近几秒帧能量的最小值，能量下降时立即跟随，
+    // 环境噪声变大时一个窗口后跟上；语音中总有音节间或换气的停顿，不会把基底抬到语音电平
+    if (level_db < vad->cur_min) {
+        vad->cur_min = level_db;
+    }
+    if (++vad->sub_frames == SOFT_VAD_FLOOR_SUB_FRAMES) {
+        vad->sub_min[vad->sub_pos] = vad->cur_min;
+        vad->sub_pos = (vad->sub_pos + 1) % SOFT_VAD_FLOOR_SUBWINDOWS;
+        vad->cur_min = level_db;
+        vad->sub_frames = 0;
+    }
+    float floor_db = vad->cur_min;
+    for (int i = 0; i < SOFT_VAD_FLOOR_SUBWINDOWS; i++) {
+        floor_db = fminf(floor_db, vad->sub_min[i]);
+    }
+    vad->floor_db = fmaxf(floor_db, SOFT_VAD_FLOOR_MIN_DB);
+
+    float snr = level_db - vad->floor_db;
+    bool frame_speech = zcr >= SOFT_VAD_MIN_ZCR &&
+                        (snr >= vad->threshold_db ||
+                         (zcr >= SOFT_VAD_FRICATIVE_ZCR && snr >= 0.5f * vad->threshold_db));
+
+    if (!vad->speech) {
+        // 语音帧累加、非语音帧递减，容忍音节间的短暂停顿
+        if (frame_speech) {
+            vad->run++;
+        } else if (vad->run > 0) {
+            vad->run--;
+        }
+        if (vad->run >= vad->start_frames) {
+            vad->speech = true;
+            vad->quiet = 0;
+        }
+    } else {
+        vad->quiet = frame_speech ? 0 : vad->quiet + 1;
+        if (vad->quiet >= vad->hangover_frames) {
+            vad->speech = false;
+            vad->run = 0;
+        }
+    }
+}
+
+soft_vad_event_t soft_vad_process(soft_vad_handle_t vad, const int16_t *samples, size_t n)
+{
+    if (!vad || !samples) {
+        return SOFT_VAD_EVENT_NONE;
+    }
+
+    bool was_speech = vad->speech;
+    for (size_t i = 0; i < n; i++) {
+        int32_t s = samples[i];
+        bool negative = s < 0;
+        vad->energy += (uint64_t)(s * s);
+        vad->crossings += negative != vad->prev_negative;
+        vad->prev_negative = negative;
+
+        if (++vad->filled == vad->frame_len) {
+            soft_vad_frame(vad);
+            vad->energy = 0;
+            vad->crossings = 0;
+            vad->filled = 0;
+        }
+    }
+
+    if (vad->speech == was_speech) {
+        return SOFT_VAD_EVENT_NONE;
+    }
+    return vad->speech ? SOFT_VAD_EVENT_START : SOFT_VAD_EVENT_END;
+}
+
+bool soft_vad_is_speech(soft_vad_handle_t vad)
+{
+    return vad ? vad->speech : false;
+}
+
+float soft_vad_get_noise_floor_db(soft_vad_handle_t vad)
+{
+    return vad ? vad->floor_db : 0.0f;
+}
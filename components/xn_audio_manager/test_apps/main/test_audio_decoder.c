@@ -0,0 +1,114 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_audio_decoder.c
+ * @Description: 播放解码器测试 - G.711 / IMA-ADPCM 参考向量与错误输入
+ *
+ * 参考向量由 Python audioop（ulaw2lin / alaw2lin / adpcm2lin）生成，
+ * ADPCM 的 audioop 输入为高 4 位在前，生成时已按 WAV 块格式交换半字节。
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "audio_decoder.h"
+
+static const uint8_t s_g711_codes[] = {
+    0x00, 0x0F, 0x10, 0x3C, 0x55, 0x7E, 0x7F, 0x80, 0x8F, 0xAA, 0xD5, 0xFE, 0xFF,
+};
+
+static const int16_t s_ulaw_expected[] = {
+    -32124, -16764, -15996, -2364, -716, -8, 0, 32124, 16764, 5372, 716, 8, 0,
+};
+
+static const int16_t s_alaw_expected[] = {
+    -5504, -6784, -2752, -13056, -8, -880, -848, 5504, 6784, 32256, 8, 880, 848,
+};
+
+/** 块头：预测值 1000（小端）、步长索引 20、保留字节 */
+static const uint8_t s_adpcm_block[] = {
+    0xE8, 0x03, 20, 0x00,
+    0x07, 0x70, 0x3B, 0xF9, 0x88, 0x12, 0x4C, 0xA5,
+};
+
+static const int16_t s_adpcm_expected[] = {
+    1000, 1093, 1106, 1118, 1283, 1118, 1268, 1210, 944,
+    906, 872, 1029, 1114, 879, 1163, 1584, 1304,
+};
+
+#define ARRAY_LEN(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * @brief 解码一帧并与期望输出逐点比较
+ */
+static void check_vector(audio_codec_t codec, const uint8_t *data, size_t len,
+                         const int16_t *expected, size_t expected_len)
+{
+    audio_decoder_handle_t dec = audio_decoder_create(codec, 16000);
+    TEST_ASSERT_NOT_NULL(dec);
+
+    int16_t out[64];
+    size_t samples = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_decoder_decode(dec, data, len, out, ARRAY_LEN(out), &samples));
+    TEST_ASSERT_EQUAL(expected_len, samples);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, out, expected_len);
+
+    audio_decoder_destroy(dec);
+}
+
+TEST_CASE("G.711 u-law 参考向量", "[audio_decoder]")
+{
+    check_vector(AUDIO_CODEC_G711_ULAW, s_g711_codes, sizeof(s_g711_codes),
+                 s_ulaw_expected, ARRAY_LEN(s_ulaw_expected));
+}
+
+TEST_CASE("G.711 A-law 参考向量", "[audio_decoder]")
+{
+    check_vector(AUDIO_CODEC_G711_ALAW, s_g711_codes, sizeof(s_g711_codes),
+                 s_alaw_expected, ARRAY_LEN(s_alaw_expected));
+}
+
+TEST_CASE("IMA-ADPCM 参考向量", "[audio_decoder]")
+{
+    check_vector(AUDIO_CODEC_IMA_ADPCM, s_adpcm_block, sizeof(s_adpcm_block),
+                 s_adpcm_expected, ARRAY_LEN(s_adpcm_expected));
+}
+
+TEST_CASE("PCM16 原样输出", "[audio_decoder]")
+{
+    static const int16_t pcm[] = {0, 1, -1, INT16_MAX, INT16_MIN, 1234};
+    check_vector(AUDIO_CODEC_PCM16, (const uint8_t *)pcm, sizeof(pcm), pcm, ARRAY_LEN(pcm));
+}
+
+TEST_CASE("解码器拒绝非法输入", "[audio_decoder]")
+{
+    int16_t out[64];
+    size_t samples = 1;
+
+    audio_decoder_handle_t dec = audio_decoder_create(AUDIO_CODEC_IMA_ADPCM, 16000);
+    TEST_ASSERT_NOT_NULL(dec);
+    // 不足块头长度
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, audio_decoder_decode(dec, s_adpcm_block, 3, out, 64, &samples));
+    TEST_ASSERT_EQUAL(0, samples);
+    // 输出缓冲区不足
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE,
+                      audio_decoder_decode(dec, s_adpcm_block, sizeof(s_adpcm_block), out, 16, &samples));
+    // 步长索引越界
+    uint8_t bad[sizeof(s_adpcm_block)];
+    for (size_t i = 0; i < sizeof(bad); i++) bad[i] = s_adpcm_block[i];
+    bad[2] = 89;
+    TEST_ASSERT_EQUAL(ESP_FAIL, audio_decoder_decode(dec, bad, sizeof(bad), out, 64, &samples));
+    audio_decoder_destroy(dec);
+
+    dec = audio_decoder_create(AUDIO_CODEC_PCM16, 16000);
+    TEST_ASSERT_NOT_NULL(dec);
+    // 奇数字节
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, audio_decoder_decode(dec, s_g711_codes, 3, out, 64, &samples));
+    audio_decoder_destroy(dec);
+
+#if !AUDIO_DECODER_HAS_OPUS
+    // Linux 主机构建不支持 Opus
+    TEST_ASSERT_NULL(audio_decoder_create(AUDIO_CODEC_OPUS, 16000));
+#endif
+}
@@ -0,0 +1,251 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27
+ * @FilePath: \xn_esp32_audio\components\xn_audio_manager\test_apps\main\test_broadcast_ring.c
+ * @Description: 广播环形缓冲区测试 - 多读者独立消费、读者落后时的跳过统计、访问期间被覆盖的检测
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "broadcast_ring.h"
+#include "test_util.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdio.h>
+
+#define BR_TEST_SIZE        256                 ///< 容量（2 的幂）
+#define BR_TEST_CHUNK       64
+#define BR_TEST_SAMPLES     (16000 * 20)        ///< 并发用例写入 20 秒音频
+
+/**
+ * @brief 写入以 first 开头的 n 个连续序号
+ */
+static void br_write_seq(broadcast_ring_handle_t br, uint16_t first, size_t n)
+{
+    int16_t buf[BR_TEST_SIZE * 4];
+    TEST_ASSERT_TRUE(n <= sizeof(buf) / sizeof(buf[0]));
+    for (size_t i = 0; i < n; i++) {
+        buf[i] = (int16_t)(first + i);
+    }
+    TEST_ASSERT_EQUAL(n, broadcast_ring_write(br, buf, n));
+}
+
+TEST_CASE("broadcast_ring 多个读者各自读到完整数据", "[broadcast_ring]")
+{
+    broadcast_ring_handle_t br = broadcast_ring_create(200);
+    TEST_ASSERT_NOT_NULL(br);
+    TEST_ASSERT_EQUAL(BR_TEST_SIZE, broadcast_ring_get_size(br));
+
+    broadcast_reader_handle_t a = broadcast_ring_open_reader(br);
+    TEST_ASSERT_NOT_NULL(a);
+    br_write_seq(br, 0, 100);
+
+    // 后打开的读者只能看到打开之后写入的数据
+    broadcast_reader_handle_t b = broadcast_ring_open_reader(br);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL(0, broadcast_ring_reader_available(b));
+    br_write_seq(br, 100, 100);
+
+    int16_t out[BR_TEST_SIZE];
+    TEST_ASSERT_EQUAL(200, broadcast_ring_read(a, out, BR_TEST_SIZE, 0));
+    for (int i = 0; i < 200; i++) {
+        TEST_ASSERT_EQUAL_INT16(i, out[i]);
+    }
+    TEST_ASSERT_EQUAL(100, broadcast_ring_read(b, out, BR_TEST_SIZE, 0));
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL_INT16(100 + i, out[i]);
+    }
+
+    // 读者槽位用完后打开失败，关闭后可以复用
+    broadcast_reader_handle_t extra[BROADCAST_RING_MAX_READERS];
+    int opened = 0;
+    while (opened < BROADCAST_RING_MAX_READERS && (extra[opened] = broadcast_ring_open_reader(br)) != NULL) {
+        opened++;
+    }
+    TEST_ASSERT_EQUAL(BROADCAST_RING_MAX_READERS - 2, opened);
+    broadcast_ring_close_reader(b);
+    b = broadcast_ring_open_reader(br);
+    TEST_ASSERT_NOT_NULL(b);
+
+    broadcast_ring_destroy(br);
+}
+
+TEST_CASE("broadcast_ring 读者落后超过容量时跳到最旧数据并计数", "[broadcast_ring]")
+{
+    broadcast_ring_handle_t br = broadcast_ring_create(BR_TEST_SIZE);
+    TEST_ASSERT_NOT_NULL(br);
+    broadcast_reader_handle_t slow = broadcast_ring_open_reader(br);
+    broadcast_reader_handle_t fast = broadcast_ring_open_reader(br);
+    TEST_ASSERT_NOT_NULL(slow);
+    TEST_ASSERT_NOT_NULL(fast);
+
+    // fast 每块都读走，slow 一直不读；写入端从不等待读者
+    int16_t out[BR_TEST_SIZE];
+    for (int b = 0; b < 10; b++) {
+        br_write_seq(br, (uint16_t)(b * 100), 100);
+        TEST_ASSERT_EQUAL(100, broadcast_ring_read(fast, out, BR_TEST_SIZE, 0));
+        TEST_ASSERT_EQUAL_INT16(b * 100, out[0]);
+    }
+    TEST_ASSERT_EQUAL(BR_TEST_SIZE, broadcast_ring_reader_available(slow));
+
+    // slow 跳过被覆盖的 1000 - 256 个采样点，从最旧的有效数据开始
+    TEST_ASSERT_EQUAL(BR_TEST_SIZE, broadcast_ring_read(slow, out, BR_TEST_SIZE, 0));
+    for (int i = 0; i < BR_TEST_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT16(1000 - BR_TEST_SIZE + i, out[i]);
+    }
+
+    broadcast_reader_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, broadcast_ring_get_reader_stats(slow, &stats));
+    TEST_ASSERT_EQUAL_UINT64(BR_TEST_SIZE, stats.total_read);
+    TEST_ASSERT_EQUAL_UINT64(1000 - BR_TEST_SIZE, stats.overrun_samples);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overrun_events);
+    TEST_ASSERT_EQUAL(BR_TEST_SIZE, stats.max_lag);
+    TEST_ASSERT_EQUAL(0, stats.lag);
+
+    TEST_ASSERT_EQUAL(ESP_OK, broadcast_ring_get_reader_stats(fast, &stats));
+    TEST_ASSERT_EQUAL_UINT64(1000, stats.total_read);
+    TEST_ASSERT_EQUAL_UINT64(0, stats.overrun_samples);
+    TEST_ASSERT_EQUAL(100, stats.max_lag);
+
+    broadcast_ring_destroy(br);
+}
+
+TEST_CASE("broadcast_ring 访问期间被覆盖的区间在 release 时报告", "[broadcast_ring]")
+{
+    broadcast_ring_handle_t br = broadcast_ring_create(BR_TEST_SIZE);
+    TEST_ASSERT_NOT_NULL(br);
+    broadcast_reader_handle_t rd = broadcast_ring_open_reader(br);
+    TEST_ASSERT_NOT_NULL(rd);
+    broadcast_reader_stats_t stats;
+
+    // 访问期间只写入剩余空间：数据完整
+    br_write_seq(br, 0, 100);
+    ring_buffer_span_t span;
+    TEST_ASSERT_EQUAL(100, broadcast_ring_peek(rd, 100, &span, 0));
+    TEST_ASSERT_EQUAL(100, span.len[0] + span.len[1]);
+    br_write_seq(br, 100, BR_TEST_SIZE - 100);
+    TEST_ASSERT_TRUE(broadcast_ring_release(rd, 100));
+
+    // 读位置在 100，已写到 256；访问 [100, 200) 期间再写 200 个，写入端到达 456，
+    // 已改写到 456 - 256 = 200 之前，区间内 100 个全部失效
+    TEST_ASSERT_EQUAL(100, broadcast_ring_peek(rd, 100, &span, 0));
+    br_write_seq(br, BR_TEST_SIZE, 200);
+    TEST_ASSERT_FALSE(broadcast_ring_release(rd, 100));
+    TEST_ASSERT_EQUAL(ESP_OK, broadcast_ring_get_reader_stats(rd, &stats));
+    TEST_ASSERT_EQUAL_UINT64(100, stats.total_read);
+    TEST_ASSERT_EQUAL_UINT64(100, stats.overrun_samples);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overrun_events);
+
+    // 读位置在 200，已写到 456（正好满）；访问 [200, 300) 期间写 40 个，前 40 个失效
+    TEST_ASSERT_EQUAL(BR_TEST_SIZE, broadcast_ring_reader_available(rd));
+    TEST_ASSERT_EQUAL(100, broadcast_ring_peek(rd, 100, &span, 0));
+    br_write_seq(br, BR_TEST_SIZE + 200, 40);
+    TEST_ASSERT_FALSE(broadcast_ring_release(rd, 100));
+    TEST_ASSERT_EQUAL(ESP_OK, broadcast_ring_get_reader_stats(rd, &stats));
+    TEST_ASSERT_EQUAL_UINT64(160, stats.total_read);
+    TEST_ASSERT_EQUAL_UINT64(140, stats.overrun_samples);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.overrun_events);
+
+    // 之后的数据完整：从 300 开始
+    int16_t out[BR_TEST_SIZE];
+    TEST_ASSERT_EQUAL(196, broadcast_ring_read(rd, out, BR_TEST_SIZE, 0));
+    TEST_ASSERT_EQUAL_INT16(300, out[0]);
+    TEST_ASSERT_EQUAL_INT16(495, out[195]);
+
+    broadcast_ring_destroy(br);
+}
+
+/** 写入任务参数 */
+typedef struct {
+    broadcast_ring_handle_t br;
+    uint32_t seed;
+    SemaphoreHandle_t done;
+} br_writer_t;
+
+/**
+ * @brief 按序号写入 BR_TEST_SAMPLES 个采样点，块长随机，每块后让出 CPU
+ */
+static void br_writer_task(void *arg)
+{
+    br_writer_t *w = (br_writer_t *)arg;
+    int16_t chunk[2 * BR_TEST_CHUNK];
+    uint32_t seq = 0;
+
+    while (seq < BR_TEST_SAMPLES) {
+        size_t n = 1 + test_rand(&w->seed) % (2 * BR_TEST_CHUNK);
+        if (n > BR_TEST_SAMPLES - seq) n = BR_TEST_SAMPLES - seq;
+        for (size_t i = 0; i < n; i++) {
+            chunk[i] = (int16_t)(seq + i);
+        }
+        broadcast_ring_write(w->br, chunk, n);
+        seq += n;
+        taskYIELD();
+    }
+    xSemaphoreGive(w->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("broadcast_ring 并发覆盖时读出的数据连续且序号单调", "[broadcast_ring]")
+{
+    broadcast_ring_handle_t br = broadcast_ring_create(BR_TEST_SIZE);
+    TEST_ASSERT_NOT_NULL(br);
+    broadcast_reader_handle_t rd = broadcast_ring_open_reader(br);
+    TEST_ASSERT_NOT_NULL(rd);
+
+    br_writer_t w = {
+        .br = br,
+        .seed = 2468,
+        .done = xSemaphoreCreateBinary(),
+    };
+    TEST_ASSERT_NOT_NULL(w.done);
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(br_writer_task, "br_writer", 4096, &w, 5, NULL));
+
+    // 读者每次读得少，写入端持续覆盖读者正在拷贝的区间（br_clobbered 丢弃被改写的开头）
+    int16_t out[BR_TEST_CHUNK];
+    uint32_t seed = 1357;
+    uint32_t errors = 0;
+    uint64_t received = 0;
+    bool have_prev = false;
+    bool writer_done = false;
+    uint16_t prev = 0;
+    for (;;) {
+        size_t got = broadcast_ring_read(rd, out, 1 + test_rand(&seed) % (BR_TEST_CHUNK / 4), 0);
+        if (got == 0) {
+            if (writer_done && broadcast_ring_reader_available(rd) == 0) {
+                break;
+            }
+            writer_done = writer_done || xSemaphoreTake(w.done, 0) == pdTRUE;
+            taskYIELD();
+            continue;
+        }
+        for (size_t i = 0; i < got; i++) {
+            uint16_t cur = (uint16_t)out[i];
+            uint16_t step = (uint16_t)(cur - prev);
+            if (have_prev && (i > 0 ? step != 1 : (step == 0 || step > 0x7FFF))) {
+                errors++;
+            }
+            prev = cur;
+            have_prev = true;
+        }
+        received += got;
+        taskYIELD();
+    }
+    vSemaphoreDelete(w.done);
+
+    // 每个采样点要么被读出，要么计入溢出
+    broadcast_reader_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, broadcast_ring_get_reader_stats(rd, &stats));
+    printf("broadcast_ring 并发覆盖: 读出 %llu 点，跳过 %llu 点（%u 次）\n",
+           (unsigned long long)received, (unsigned long long)stats.overrun_samples,
+           (unsigned)stats.overrun_events);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(BR_TEST_SAMPLES - 1), prev);
+    TEST_ASSERT_EQUAL_UINT64(received, stats.total_read);
+    TEST_ASSERT_EQUAL_UINT64(BR_TEST_SAMPLES, received + stats.overrun_samples);
+    TEST_ASSERT_TRUE(stats.overrun_events > 0);
+
+    broadcast_ring_destroy(br);
+}
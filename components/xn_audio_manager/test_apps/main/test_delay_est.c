@@ -0,0 +1,115 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_delay_est.c
+ * @Description: 延迟估计测试 - 合成回声的延迟精度、无相关输入的置信度与耗时
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "delay_est.h"
+#include "test_util.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DE_TEST_SAMPLES     (16000 * 3)
+#define DE_TEST_BLOCK       512
+#define DE_TEST_MAX_ERROR   4           ///< 允许误差（采样点数，AEC 滤波器长度远大于此）
+
+static int16_t s_ref[DE_TEST_SAMPLES];
+static int16_t s_mic[DE_TEST_SAMPLES];
+
+/**
+ * @brief 生成回采和含回声的麦克风信号
+ *
+ * 回声为两条路径（主路径 0.3 倍 + 7 点后 0.1 倍），叠加白噪声
+ *
+ * @param delay 主路径延迟（采样点数）
+ * @param noise 噪声幅度
+ */
+static void de_gen(int delay, double noise)
+{
+    uint32_t seed = 1000 + delay;
+    test_gen_colored_noise(s_ref, DE_TEST_SAMPLES, 1500, seed);
+    for (int i = 0; i < DE_TEST_SAMPLES; i++) {
+        double echo = 0;
+        if (i >= delay) echo += 0.3 * s_ref[i - delay];
+        if (i >= delay + 7) echo += 0.1 * s_ref[i - delay - 7];
+        s_mic[i] = (int16_t)(echo + noise * test_rand_unit(&seed));
+    }
+}
+
+/**
+ * @brief 按块送入直到窗口累计满
+ */
+static bool de_feed_all(delay_est_handle_t de)
+{
+    for (int i = 0; i + DE_TEST_BLOCK <= DE_TEST_SAMPLES; i += DE_TEST_BLOCK) {
+        if (delay_est_feed(de, s_mic + i, s_ref + i, DE_TEST_BLOCK)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("delay_est 合成回声延迟", "[delay_est]")
+{
+    static const int delays[] = {0, 3, 37, 160, 481, 1000, 1533, 2000};
+    delay_est_handle_t de = delay_est_create(NULL);
+    TEST_ASSERT_NOT_NULL(de);
+
+    for (size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        de_gen(delays[i], 1000);
+        delay_est_reset(de);
+        TEST_ASSERT_TRUE(de_feed_all(de));
+
+        delay_est_result_t result;
+        bool ok = delay_est_get_result(de, &result);
+        printf("delay_est 延迟 %d: 估计 %d，置信度 %.1f\n", delays[i], (int)result.lag, result.confidence);
+        TEST_ASSERT_TRUE(ok);
+        TEST_ASSERT_INT_WITHIN(DE_TEST_MAX_ERROR, delays[i], result.lag);
+    }
+
+    delay_est_destroy(de);
+}
+
+TEST_CASE("delay_est 无相关输入置信度不足", "[delay_est]")
+{
+    delay_est_handle_t de = delay_est_create(NULL);
+    TEST_ASSERT_NOT_NULL(de);
+
+    uint32_t seed = 5;
+    test_gen_colored_noise(s_ref, DE_TEST_SAMPLES, 1500, 11);
+    for (int i = 0; i < DE_TEST_SAMPLES; i++) {
+        s_mic[i] = (int16_t)(1000 * test_rand_unit(&seed));
+    }
+    TEST_ASSERT_TRUE(de_feed_all(de));
+
+    delay_est_result_t result;
+    TEST_ASSERT_FALSE(delay_est_get_result(de, &result));
+    printf("delay_est 无相关: 置信度 %.1f\n", result.confidence);
+
+    delay_est_destroy(de);
+}
+
+TEST_CASE("delay_est 一个估计窗口的耗时", "[delay_est][bench]")
+{
+    delay_est_handle_t de = delay_est_create(NULL);
+    TEST_ASSERT_NOT_NULL(de);
+    de_gen(500, 1000);
+
+    int64_t best = INT64_MAX;
+    for (int rep = 0; rep < 5; rep++) {
+        delay_est_reset(de);
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_TRUE(de_feed_all(de));
+        int64_t elapsed = esp_timer_get_time() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    printf("delay_est: 默认 2 秒窗口、±2048 点搜索耗时 %.2f ms\n", best / 1000.0);
+
+    delay_est_destroy(de);
+}
@@ -0,0 +1,106 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_drift_comp.c
+ * @Description: 漂移补偿测试 - 合成 ppm 时钟偏差下的收敛与水位锁定
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "drift_comp.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DC_TEST_RATE        16000
+#define DC_TEST_BLOCK       512         ///< 麦克风侧每次取出的采样点数（32ms）
+#define DC_TEST_WRITE       1024        ///< 扬声器侧每次写入的采样点数（整块写入，水位呈锯齿）
+#define DC_TEST_PREFILL     1500
+#define DC_TEST_SECONDS     200
+#define DC_TEST_FIFO        (1 << 16)
+
+/** 单次仿真结果 */
+typedef struct {
+    double ppm;             ///< 最后 20 秒的平均补偿量
+    double fill_drift;      ///< 最后 20 秒平均等效水位相对锁定水位的偏移
+    bool underrun;          ///< 是否出现取不够数据
+} dc_sim_result_t;
+
+/**
+ * @brief 仿真扬声器时钟比麦克风快 drift_ppm 时的回采链路
+ *
+ * 扬声器侧按 (1 + ppm) 的速率整块写入 FIFO，麦克风侧每块用补偿器从 FIFO 取出
+ * 正好 DC_TEST_BLOCK 个输出。整块写入的 FIFO 水位只在写入时跳变，这里与 afe_wrapper
+ * 一样用时间戳换算的等效水位（扬声器时钟已走过的采样点数 - 已取出的采样点数）更新偏差估计。
+ */
+static dc_sim_result_t dc_simulate(double drift_ppm)
+{
+    static int16_t fifo[DC_TEST_FIFO];
+    size_t rd = 0, wr = 0;
+    uint64_t spk_idx = 0;
+    double spk_acc = 0;
+    double lock_fill = -1;
+    int16_t out[DC_TEST_BLOCK];
+    int16_t tmp[DC_TEST_BLOCK + 64];
+    dc_sim_result_t res = {0};
+
+    drift_comp_handle_t dc = drift_comp_create(NULL);
+    TEST_ASSERT_NOT_NULL(dc);
+
+    for (int i = 0; i < DC_TEST_PREFILL; i++) {
+        fifo[wr++ % DC_TEST_FIFO] = (int16_t)(8000 * sin(spk_idx++ * 0.05));
+    }
+
+    const int blocks = DC_TEST_SECONDS * DC_TEST_RATE / DC_TEST_BLOCK;
+    const int tail = 20 * DC_TEST_RATE / DC_TEST_BLOCK;
+    for (int blk = 0; blk < blocks; blk++) {
+        spk_acc += DC_TEST_BLOCK * (1 + drift_ppm * 1e-6);
+        while (spk_acc >= DC_TEST_WRITE) {
+            for (int i = 0; i < DC_TEST_WRITE; i++) {
+                fifo[wr++ % DC_TEST_FIFO] = (int16_t)(8000 * sin(spk_idx++ * 0.05));
+            }
+            spk_acc -= DC_TEST_WRITE;
+        }
+        TEST_ASSERT_TRUE(wr - rd < DC_TEST_FIFO);
+
+        double fill = (double)(wr - rd) + spk_acc;
+        if (lock_fill < 0) lock_fill = fill;
+        drift_comp_update(dc, (float)fill, DC_TEST_BLOCK);
+        size_t avail = wr - rd;
+        if (avail > sizeof(tmp) / sizeof(tmp[0])) avail = sizeof(tmp) / sizeof(tmp[0]);
+        for (size_t i = 0; i < avail; i++) {
+            tmp[i] = fifo[(rd + i) % DC_TEST_FIFO];
+        }
+        size_t produced = 0;
+        rd += drift_comp_process(dc, tmp, avail, out, DC_TEST_BLOCK, &produced);
+        if (produced < DC_TEST_BLOCK) {
+            res.underrun = true;
+        }
+
+        if (blk >= blocks - tail) {
+            res.ppm += drift_comp_get_ppm(dc);
+            res.fill_drift += fill - lock_fill;
+        }
+    }
+
+    res.ppm /= tail;
+    res.fill_drift /= tail;
+    drift_comp_destroy(dc);
+    return res;
+}
+
+TEST_CASE("drift_comp 合成时钟偏差收敛", "[drift_comp]")
+{
+    static const double drifts[] = {0, 100, -100, 300, -500};
+    for (size_t i = 0; i < sizeof(drifts) / sizeof(drifts[0]); i++) {
+        dc_sim_result_t res = dc_simulate(drifts[i]);
+        printf("drift_comp %+.0f ppm: 估计 %+.1f ppm，水位偏移 %+.0f\n", drifts[i], res.ppm, res.fill_drift);
+        TEST_ASSERT_FALSE(res.underrun);
+        // 估计误差不超过 1% + 1 ppm，等效水位回到锁定水位附近
+        TEST_ASSERT_TRUE(fabs(res.ppm - drifts[i]) <= 0.01 * fabs(drifts[i]) + 1.0);
+        TEST_ASSERT_TRUE(fabs(res.fill_drift) < 16.0);
+    }
+}
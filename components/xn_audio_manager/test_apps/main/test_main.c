@@ -0,0 +1,26 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_main.c
+ * @Description: 测试入口 - 依次运行全部用例（含 [bench] 基准，只打印耗时不做断言）
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "sdkconfig.h"
+#include <stdlib.h>
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    int failures = UNITY_END();
+#if CONFIG_IDF_TARGET_LINUX
+    // 主机上以失败数作为退出码，便于脚本判断
+    exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+#else
+    (void)failures;
+#endif
+}
@@ -0,0 +1,149 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_pcm_kernels.c
+ * @Description: PCM 内核测试 - 专用实现与逐样本参考实现逐位一致
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "pcm_kernels.h"
+#include "test_util.h"
+#include <stdio.h>
+
+#define PCM_TEST_MAX_N      512
+#define PCM_TEST_ROUNDS     2000
+
+static int32_t s_src32[PCM_TEST_MAX_N];
+static int16_t s_src16[PCM_TEST_MAX_N];
+static int16_t s_out[2 * PCM_TEST_MAX_N];
+static int16_t s_ref[2 * PCM_TEST_MAX_N];
+
+TEST_CASE("pcm_s32_to_s16_sat 与参考实现逐位一致", "[pcm_kernels]")
+{
+    uint32_t seed = 1;
+    for (int round = 0; round < PCM_TEST_ROUNDS; round++) {
+        for (int i = 0; i < PCM_TEST_MAX_N; i++) {
+            s_src32[i] = (int32_t)test_rand(&seed);
+        }
+        // 0-31 全部移位，覆盖常量移位专用实现和通用实现
+        for (unsigned shift = 0; shift < 32; shift++) {
+            size_t n = test_rand(&seed) % (PCM_TEST_MAX_N + 1);
+            size_t sat = pcm_s32_to_s16_sat(s_out, s_src32, n, shift);
+            size_t sat_ref = pcm_s32_to_s16_sat_ref(s_ref, s_src32, n, shift);
+            TEST_ASSERT_EQUAL(sat_ref, sat);
+            if (n) {
+                TEST_ASSERT_EQUAL_INT16_ARRAY(s_ref, s_out, n);
+            }
+        }
+    }
+}
+
+TEST_CASE("pcm_mono_to_stereo_gain_q15 与参考实现逐位一致", "[pcm_kernels]")
+{
+    static const int32_t edges[] = {0, 1, 16384, PCM_GAIN_Q15_UNITY - 1, PCM_GAIN_Q15_UNITY};
+    const size_t num_edges = sizeof(edges) / sizeof(edges[0]);
+    uint32_t seed = 2;
+
+    for (int round = 0; round < PCM_TEST_ROUNDS; round++) {
+        for (int i = 0; i < PCM_TEST_MAX_N; i++) {
+            s_src16[i] = (int16_t)test_rand(&seed);
+        }
+        s_src16[0] = INT16_MIN;
+        s_src16[1] = INT16_MAX;
+
+        // 边界增益两两组合（含恒定增益与直通路径），其余随机
+        int32_t g0, g1;
+        if (round < (int)(num_edges * num_edges)) {
+            g0 = edges[round / num_edges];
+            g1 = edges[round % num_edges];
+        } else {
+            g0 = (int32_t)(test_rand(&seed) % (PCM_GAIN_Q15_UNITY + 1));
+            g1 = round % 4 == 0 ? g0 : (int32_t)(test_rand(&seed) % (PCM_GAIN_Q15_UNITY + 1));
+        }
+        size_t n = test_rand(&seed) % (PCM_TEST_MAX_N + 1);
+
+        pcm_mono_to_stereo_gain_q15(s_out, s_src16, n, g0, g1);
+        pcm_mono_to_stereo_gain_q15_ref(s_ref, s_src16, n, g0, g1);
+        if (n) {
+            TEST_ASSERT_EQUAL_INT16_ARRAY(s_ref, s_out, 2 * n);
+        }
+    }
+}
+
+TEST_CASE("pcm_s16_level 峰值与能量", "[pcm_kernels]")
+{
+    uint32_t seed = 3;
+    for (int round = 0; round < 100; round++) {
+        size_t n = test_rand(&seed) % (PCM_TEST_MAX_N + 1);
+        int32_t peak_ref = 0;
+        uint64_t energy_ref = 0;
+        for (size_t i = 0; i < n; i++) {
+            s_src16[i] = (int16_t)test_rand(&seed);
+            int32_t a = s_src16[i] < 0 ? -(int32_t)s_src16[i] : s_src16[i];
+            if (a > peak_ref) peak_ref = a;
+            energy_ref += (uint64_t)((int32_t)s_src16[i] * s_src16[i]);
+        }
+
+        int32_t peak = -1;
+        uint64_t energy = 1;
+        pcm_s16_level(s_src16, n, &peak, &energy);
+        TEST_ASSERT_EQUAL_INT32(peak_ref, peak);
+        TEST_ASSERT_EQUAL_UINT64(energy_ref, energy);
+    }
+}
+
+/**
+ * @brief 改动前 i2s_hal_read_mic 的转换循环：直接截断，超出范围时回绕
+ */
+static void pcm_truncate_baseline(int16_t *out, const int32_t *src, size_t n, int shift)
+{
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (int16_t)(src[i] >> shift);
+    }
+}
+
+TEST_CASE("pcm 内核与改动前实现的每点周期数对比", "[pcm_kernels][bench]")
+{
+    uint32_t seed = 4;
+    for (int i = 0; i < PCM_TEST_MAX_N; i++) {
+        s_src32[i] = (int32_t)test_rand(&seed) >> 4;
+        s_src16[i] = (int16_t)test_rand(&seed);
+    }
+
+    // 移位数和 i2s_hal 一样在运行时给出，避免编译器把基线循环按常量移位优化
+    volatile int shift_cfg = 14;
+    const int shift = shift_cfg;
+    const int iters = 20000;
+    volatile size_t sink = 0;
+    uint64_t sat_cycles = 0, trunc_cycles = 0, gain_cycles = 0, gain_ref_cycles = 0;
+
+    for (int k = 0; k < iters; k++) {
+        uint32_t t0 = test_cycles();
+        sink += pcm_s32_to_s16_sat(s_out, s_src32, PCM_TEST_MAX_N, shift);
+        uint32_t t1 = test_cycles();
+        pcm_truncate_baseline(s_ref, s_src32, PCM_TEST_MAX_N, shift);
+        uint32_t t2 = test_cycles();
+        sat_cycles += t1 - t0;
+        trunc_cycles += t2 - t1;
+    }
+    sink += (size_t)s_ref[PCM_TEST_MAX_N - 1];
+    for (int k = 0; k < iters; k++) {
+        uint32_t t0 = test_cycles();
+        pcm_mono_to_stereo_gain_q15(s_out, s_src16, PCM_TEST_MAX_N, 1000, 30000);
+        uint32_t t1 = test_cycles();
+        pcm_mono_to_stereo_gain_q15_ref(s_ref, s_src16, PCM_TEST_MAX_N, 1000, 30000);
+        uint32_t t2 = test_cycles();
+        gain_cycles += t1 - t0;
+        gain_ref_cycles += t2 - t1;
+    }
+    (void)sink;
+
+    double per = 1.0 / ((double)iters * PCM_TEST_MAX_N);
+    printf("pcm_s32_to_s16_sat: %.2f 周期/点（改动前截断循环 %.2f）\n",
+           sat_cycles * per, trunc_cycles * per);
+    printf("pcm_mono_to_stereo_gain_q15 渐变: %.2f 周期/点（参考 %.2f）\n",
+           gain_cycles * per, gain_ref_cycles * per);
+}
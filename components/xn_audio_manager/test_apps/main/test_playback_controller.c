@@ -0,0 +1,366 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_playback_controller.c
+ * @Description: 播放链路测试 - 播放控制器经文件 BSP 端到端输出（PCM、压缩帧、重采样、停止）
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "playback_controller.h"
+#include "audio_bsp.h"
+#include "audio_decoder.h"
+#include "resampler.h"
+#include "test_util.h"
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PB_TEST_RATE        16000
+#define PB_TEST_FRAME       512
+#define PB_TEST_BUFFER      (PB_TEST_RATE * 2)     ///< 播放缓冲区（2 秒，写入不会溢出）
+#define PB_TEST_SAMPLES     PB_TEST_RATE           ///< 每个用例播放 1 秒
+#define PB_TEST_SINK        (PB_TEST_SAMPLES * 3)  ///< 扬声器接收区（留出重采样的余量）
+#define PB_TEST_TIMEOUT_MS  5000
+
+/** 测试用播放链路：文件 BSP（扬声器输出到内存）+ 播放控制器 */
+typedef struct {
+    audio_bsp_handle_t bsp;
+    playback_controller_handle_t ctrl;
+    int16_t *sink;
+    uint8_t volume;
+    atomic_size_t played;       ///< 播放任务已送往扬声器的采样点数（回采回调中累加）
+} pb_chain_t;
+
+/**
+ * @brief 回采回调：每段在写入扬声器之前回调，用于等待播放进度（不与播放任务竞争接收区）
+ */
+static void pb_reference_cb(const int16_t *samples, size_t count, void *user_ctx)
+{
+    pb_chain_t *chain = (pb_chain_t *)user_ctx;
+    atomic_fetch_add(&chain->played, count);
+}
+
+static void pb_chain_create(pb_chain_t *chain, audio_bsp_file_pacing_t pacing, size_t encoded_bytes)
+{
+    memset(chain, 0, sizeof(*chain));
+    chain->sink = (int16_t *)calloc(PB_TEST_SINK, sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(chain->sink);
+
+    audio_bsp_file_config_t bsp_cfg = {
+        .speaker_sink = chain->sink,
+        .speaker_sink_samples = PB_TEST_SINK,
+        .sample_rate = PB_TEST_RATE,
+        .pacing = pacing,
+    };
+    chain->bsp = audio_bsp_create_file(&bsp_cfg);
+    TEST_ASSERT_NOT_NULL(chain->bsp);
+
+    chain->volume = 100;
+    playback_controller_config_t cfg = {
+        .bsp_handle = chain->bsp,
+        .playback_buffer_samples = PB_TEST_BUFFER,
+        .reference_buffer_samples = PB_TEST_FRAME * 4,
+        .frame_samples = PB_TEST_FRAME,
+        .reference_callback = pb_reference_cb,
+        .reference_ctx = chain,
+        .volume_ptr = &chain->volume,
+        .overflow_policy = RING_BUFFER_OVERFLOW_DROP_NEWEST,
+        .sample_rate = PB_TEST_RATE,
+        .encoded_buffer_bytes = encoded_bytes,
+    };
+    chain->ctrl = playback_controller_create(&cfg);
+    TEST_ASSERT_NOT_NULL(chain->ctrl);
+}
+
+static void pb_chain_destroy(pb_chain_t *chain)
+{
+    playback_controller_destroy(chain->ctrl);
+    audio_bsp_destroy(chain->bsp);
+    free(chain->sink);
+}
+
+/**
+ * @brief 等待播放任务送出 expected 个采样点后停止播放
+ *
+ * stop 返回 ESP_OK 时播放任务已回到空闲，之后读取接收区不会与其竞争
+ */
+static void pb_wait_played_and_stop(pb_chain_t *chain, size_t expected)
+{
+    int64_t deadline = esp_timer_get_time() + PB_TEST_TIMEOUT_MS * 1000LL;
+    while (atomic_load(&chain->played) < expected && esp_timer_get_time() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_stop(chain->ctrl));
+    TEST_ASSERT_EQUAL(expected, atomic_load(&chain->played));
+    TEST_ASSERT_EQUAL(expected, audio_bsp_file_get_speaker_samples(chain->bsp));
+}
+
+TEST_CASE("playback PCM 经文件 BSP 原样输出", "[playback]")
+{
+    pb_chain_t chain;
+    pb_chain_create(&chain, AUDIO_BSP_FILE_PACING_FAST, 0);
+
+    int16_t *pcm = (int16_t *)malloc(PB_TEST_SAMPLES * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(pcm);
+    test_gen_colored_noise(pcm, PB_TEST_SAMPLES, 3000, 21);
+
+    // 启动前预填一半，启动后按 20ms 分块写入其余部分
+    size_t half = PB_TEST_SAMPLES / 2;
+    TEST_ASSERT_EQUAL(half, playback_controller_write(chain.ctrl, pcm, half));
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_start(chain.ctrl));
+    for (size_t off = half; off < PB_TEST_SAMPLES; off += 320) {
+        size_t n = PB_TEST_SAMPLES - off < 320 ? PB_TEST_SAMPLES - off : 320;
+        TEST_ASSERT_EQUAL(n, playback_controller_write(chain.ctrl, pcm + off, n));
+    }
+
+    pb_wait_played_and_stop(&chain, PB_TEST_SAMPLES);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(pcm, chain.sink, PB_TEST_SAMPLES);
+
+    free(pcm);
+    pb_chain_destroy(&chain);
+}
+
+TEST_CASE("playback G.711 压缩帧即时解码输出", "[playback]")
+{
+    pb_chain_t chain;
+    pb_chain_create(&chain, AUDIO_BSP_FILE_PACING_FAST, 16 * 1024);
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_set_codec(chain.ctrl, AUDIO_CODEC_G711_ULAW));
+
+    // 20ms 一帧的随机码字，期望输出由独立的解码器给出
+    const size_t frame_bytes = 320;
+    uint8_t *codes = (uint8_t *)malloc(PB_TEST_SAMPLES);
+    int16_t *expected = (int16_t *)malloc(PB_TEST_SAMPLES * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(codes);
+    TEST_ASSERT_NOT_NULL(expected);
+    uint32_t seed = 22;
+    for (size_t i = 0; i < PB_TEST_SAMPLES; i++) {
+        codes[i] = (uint8_t)test_rand(&seed);
+    }
+    audio_decoder_handle_t dec = audio_decoder_create(AUDIO_CODEC_G711_ULAW, PB_TEST_RATE);
+    TEST_ASSERT_NOT_NULL(dec);
+    size_t decoded = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, audio_decoder_decode(dec, codes, PB_TEST_SAMPLES, expected, PB_TEST_SAMPLES, &decoded));
+    TEST_ASSERT_EQUAL(PB_TEST_SAMPLES, decoded);
+    audio_decoder_destroy(dec);
+
+    // 压缩格式下播放任务是播放缓冲区唯一的生产者
+    TEST_ASSERT_EQUAL(0, playback_controller_write(chain.ctrl, expected, 16));
+
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_start(chain.ctrl));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, playback_controller_set_codec(chain.ctrl, AUDIO_CODEC_PCM16));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, playback_controller_set_input_rate(chain.ctrl, 8000));
+    for (size_t off = 0; off < PB_TEST_SAMPLES; off += frame_bytes) {
+        TEST_ASSERT_EQUAL(ESP_OK, playback_controller_write_encoded(chain.ctrl, codes + off, frame_bytes, 1000));
+    }
+
+    pb_wait_played_and_stop(&chain, PB_TEST_SAMPLES);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, chain.sink, PB_TEST_SAMPLES);
+
+    free(expected);
+    free(codes);
+    pb_chain_destroy(&chain);
+}
+
+TEST_CASE("playback 8kHz 输入重采样后输出", "[playback]")
+{
+    const uint32_t in_rate = 8000;
+    const size_t in_samples = in_rate;
+
+    pb_chain_t chain;
+    pb_chain_create(&chain, AUDIO_BSP_FILE_PACING_FAST, 0);
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_set_input_rate(chain.ctrl, in_rate));
+
+    int16_t *pcm = (int16_t *)malloc(in_samples * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(pcm);
+    test_gen_colored_noise(pcm, in_samples, 3000, 23);
+
+    // 重采样器与分块无关：期望输出由独立的重采样器整块处理给出
+    resampler_handle_t rs = resampler_create(in_rate, PB_TEST_RATE);
+    TEST_ASSERT_NOT_NULL(rs);
+    size_t cap = resampler_max_output(rs, in_samples);
+    TEST_ASSERT_TRUE(cap <= PB_TEST_SINK);
+    int16_t *expected = (int16_t *)malloc(cap * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(expected);
+    size_t expected_len = resampler_process(rs, pcm, in_samples, expected);
+    resampler_destroy(rs);
+
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_start(chain.ctrl));
+    for (size_t off = 0; off < in_samples; off += 160) {
+        size_t n = in_samples - off < 160 ? in_samples - off : 160;
+        TEST_ASSERT_EQUAL(n, playback_controller_write(chain.ctrl, pcm + off, n));
+    }
+
+    pb_wait_played_and_stop(&chain, expected_len);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, chain.sink, expected_len);
+
+    // 停止后可以换回原采样率
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_set_input_rate(chain.ctrl, 0));
+
+    free(expected);
+    free(pcm);
+    pb_chain_destroy(&chain);
+}
+
+TEST_CASE("playback 实时节奏下停止在毫秒级完成", "[playback]")
+{
+    pb_chain_t chain;
+    pb_chain_create(&chain, AUDIO_BSP_FILE_PACING_REALTIME, 0);
+
+    int16_t *pcm = (int16_t *)malloc(PB_TEST_SAMPLES * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(pcm);
+    test_gen_colored_noise(pcm, PB_TEST_SAMPLES, 3000, 24);
+    TEST_ASSERT_EQUAL(PB_TEST_SAMPLES, playback_controller_write(chain.ctrl, pcm, PB_TEST_SAMPLES));
+
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_start(chain.ctrl));
+    vTaskDelay(pdMS_TO_TICKS(200));
+    TEST_ASSERT_TRUE(playback_controller_is_running(chain.ctrl));
+
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_stop(chain.ctrl));
+    int64_t stop_us = esp_timer_get_time() - start;
+    printf("playback 停止耗时 %d us\n", (int)stop_us);
+    TEST_ASSERT_FALSE(playback_controller_is_running(chain.ctrl));
+
+    // 停止后不再输出，未播放的数据留在播放缓冲区
+    size_t played = audio_bsp_file_get_speaker_samples(chain.bsp);
+    TEST_ASSERT_TRUE(played > 0 && played < PB_TEST_SAMPLES);
+    TEST_ASSERT_EQUAL(PB_TEST_SAMPLES - played, PB_TEST_BUFFER - playback_controller_get_free_space(chain.ctrl));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(pcm, chain.sink, played);
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_EQUAL(played, audio_bsp_file_get_speaker_samples(chain.bsp));
+
+    // 确认空闲后才能替换重采样器
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_set_input_rate(chain.ctrl, 24000));
+
+    free(pcm);
+    pb_chain_destroy(&chain);
+}
+
+/** 预填充任务参数 */
+typedef struct {
+    playback_controller_handle_t ctrl;
+    atomic_bool stop;
+    size_t short_writes;        ///< 未被完整接受的写入次数（覆盖策略下应为 0）
+    SemaphoreHandle_t done;
+} pb_prefill_t;
+
+/**
+ * @brief 停止状态下持续预填充，与测试任务中的 set_input_rate 并发
+ */
+static void pb_prefill_task(void *arg)
+{
+    pb_prefill_t *p = (pb_prefill_t *)arg;
+    int16_t chunk[160];
+    test_gen_colored_noise(chunk, 160, 3000, 26);
+
+    while (!atomic_load(&p->stop)) {
+        if (playback_controller_write(p->ctrl, chunk, 160) != 160) {
+            p->short_writes++;
+        }
+        taskYIELD();
+    }
+    xSemaphoreGive(p->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("playback 预填充期间切换输入采样率不与写入交错", "[playback]")
+{
+    pb_chain_t chain;
+    pb_chain_create(&chain, AUDIO_BSP_FILE_PACING_FAST, 0);
+    // 覆盖旧数据：缓冲区满后每次写入仍经过重采样器
+    TEST_ASSERT_EQUAL(ESP_OK, playback_controller_set_overflow_policy(chain.ctrl, RING_BUFFER_OVERFLOW_DROP_OLDEST, 0));
+
+    pb_prefill_t p = {
+        .ctrl = chain.ctrl,
+        .done = xSemaphoreCreateBinary(),
+    };
+    atomic_init(&p.stop, false);
+    TEST_ASSERT_NOT_NULL(p.done);
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(pb_prefill_task, "pb_prefill", 4096, &p, 5, NULL));
+
+    // 重采样器和输出缓冲区在写入任务使用期间反复替换
+    static const uint32_t rates[] = { 8000, 24000, 0, 22050, 48000 };
+    for (int i = 0; i < 200; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, playback_controller_set_input_rate(chain.ctrl, rates[i % 5]));
+        taskYIELD();
+    }
+
+    atomic_store(&p.stop, true);
+    TEST_ASSERT_TRUE(xSemaphoreTake(p.done, pdMS_TO_TICKS(PB_TEST_TIMEOUT_MS)));
+    vSemaphoreDelete(p.done);
+    TEST_ASSERT_EQUAL(0, p.short_writes);
+    TEST_ASSERT_FALSE(playback_controller_is_running(chain.ctrl));
+
+    pb_chain_destroy(&chain);
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+/**
+ * @brief 写一个 16bit 双声道 WAV：左声道为序号，右声道为其相反数（设备上没有可写的文件系统）
+ */
+static void pb_write_stereo_wav(const char *path, size_t frames)
+{
+    FILE *f = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    uint32_t data_bytes = (uint32_t)(frames * 4);
+    uint8_t hdr[44] = {
+        'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0,
+        0x80, 0x3E, 0, 0, 0x00, 0xFA, 0, 0, 4, 0, 16, 0,
+        'd', 'a', 't', 'a', 0, 0, 0, 0,
+    };
+    uint32_t riff = data_bytes + 36;
+    memcpy(hdr + 4, &riff, 4);
+    memcpy(hdr + 40, &data_bytes, 4);
+    fwrite(hdr, 1, sizeof(hdr), f);
+    for (size_t i = 0; i < frames; i++) {
+        int16_t lr[2] = {(int16_t)i, (int16_t)-(int16_t)i};
+        fwrite(lr, sizeof(int16_t), 2, f);
+    }
+    fclose(f);
+}
+
+TEST_CASE("audio_bsp 文件后端读 WAV 首声道，结束后静音或循环", "[playback]")
+{
+    const char *path = "/tmp/xn_audio_test_mic.wav";
+    const size_t frames = 1000;
+    pb_write_stereo_wav(path, frames);
+
+    int16_t out[1200];
+    size_t got = 0;
+    for (int loop = 0; loop < 2; loop++) {
+        audio_bsp_file_config_t cfg = {
+            .mic_path = path,
+            .mic_loop = loop,
+            .pacing = AUDIO_BSP_FILE_PACING_FAST,
+        };
+        audio_bsp_handle_t bsp = audio_bsp_create_file(&cfg);
+        TEST_ASSERT_NOT_NULL(bsp);
+
+        // 分两次读过文件末尾：总能读满，之后静音（或从头循环）
+        TEST_ASSERT_EQUAL(ESP_OK, audio_bsp_read_mic(bsp, out, 600, &got));
+        TEST_ASSERT_EQUAL(600, got);
+        TEST_ASSERT_EQUAL(ESP_OK, audio_bsp_read_mic(bsp, out + 600, 600, &got));
+        TEST_ASSERT_EQUAL(600, got);
+        for (size_t i = 0; i < 1200; i++) {
+            int16_t expected = i < frames ? (int16_t)i : loop ? (int16_t)(i - frames) : 0;
+            TEST_ASSERT_EQUAL_INT16(expected, out[i]);
+        }
+        audio_bsp_destroy(bsp);
+    }
+
+    // 不存在的文件创建失败
+    audio_bsp_file_config_t bad = {.mic_path = "/tmp/xn_audio_test_missing.wav"};
+    TEST_ASSERT_NULL(audio_bsp_create_file(&bad));
+    remove(path);
+}
+#endif
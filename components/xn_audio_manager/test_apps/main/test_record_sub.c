@@ -0,0 +1,232 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27
+ * @FilePath: \xn_esp32_audio\components\xn_audio_manager\test_apps\main\test_record_sub.c
+ * @Description: 录音订阅者测试 - 拆帧与按序投递、队列满时的丢帧策略、回调阻塞时的销毁超时
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "record_sub.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#define RS_TEST_RATE        16000
+#define RS_TEST_FRAME       160
+#define RS_TEST_MAX_FRAMES  64
+#define RS_TEST_TIMEOUT_MS  2000
+
+/** 回调记录 */
+typedef struct {
+    int16_t first[RS_TEST_MAX_FRAMES];      ///< 每帧首个采样点
+    size_t samples[RS_TEST_MAX_FRAMES];     ///< 每帧采样点数
+    audio_frame_info_t info[RS_TEST_MAX_FRAMES];
+    uint32_t errors;                        ///< 帧内数据不连续的次数
+    atomic_uint count;                      ///< 已回调的帧数
+    SemaphoreHandle_t entered;              ///< 每次进入回调时释放（非 NULL 时）
+    SemaphoreHandle_t gate;                 ///< 非 NULL 时回调阻塞到拿到它为止
+} rs_record_t;
+
+/**
+ * @brief 记录每帧的数据和时间信息；帧内数据应为连续序号
+ */
+static void rs_record_cb(const int16_t *pcm, size_t samples, const audio_frame_info_t *info, void *user_ctx)
+{
+    rs_record_t *rec = (rs_record_t *)user_ctx;
+    if (rec->entered) {
+        xSemaphoreGive(rec->entered);
+    }
+    if (rec->gate) {
+        xSemaphoreTake(rec->gate, portMAX_DELAY);
+    }
+
+    unsigned n = atomic_load(&rec->count);
+    if (n < RS_TEST_MAX_FRAMES) {
+        rec->first[n] = pcm[0];
+        rec->samples[n] = samples;
+        rec->info[n] = *info;
+    }
+    for (size_t i = 1; i < samples; i++) {
+        if (pcm[i] != (int16_t)(pcm[0] + i)) {
+            rec->errors++;
+        }
+    }
+    atomic_store(&rec->count, n + 1);
+}
+
+static void rs_record_init(rs_record_t *rec, bool blocking)
+{
+    memset(rec, 0, sizeof(*rec));
+    atomic_init(&rec->count, 0);
+    if (blocking) {
+        rec->entered = xSemaphoreCreateCounting(RS_TEST_MAX_FRAMES, 0);
+        rec->gate = xSemaphoreCreateCounting(RS_TEST_MAX_FRAMES, 0);
+        TEST_ASSERT_NOT_NULL(rec->entered);
+        TEST_ASSERT_NOT_NULL(rec->gate);
+    }
+}
+
+static void rs_record_deinit(rs_record_t *rec)
+{
+    if (rec->entered) vSemaphoreDelete(rec->entered);
+    if (rec->gate) vSemaphoreDelete(rec->gate);
+}
+
+static void rs_wait_count(rs_record_t *rec, unsigned expected)
+{
+    int64_t deadline = esp_timer_get_time() + RS_TEST_TIMEOUT_MS * 1000LL;
+    while (atomic_load(&rec->count) < expected && esp_timer_get_time() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    TEST_ASSERT_EQUAL(expected, atomic_load(&rec->count));
+}
+
+/**
+ * @brief 入队一块以 first 开头的连续序号数据
+ */
+static size_t rs_push_seq(record_sub_handle_t sub, int16_t first, size_t samples, uint64_t index)
+{
+    int16_t pcm[3 * RS_TEST_FRAME];
+    for (size_t i = 0; i < samples; i++) {
+        pcm[i] = (int16_t)(first + i);
+    }
+    audio_frame_info_t info = {
+        .sample_index = index,
+        .timestamp_us = 1000000 + (int64_t)index * 1000000 / RS_TEST_RATE,
+    };
+    return record_sub_push(sub, pcm, samples, &info);
+}
+
+TEST_CASE("record_sub 大块拆成多帧按序投递", "[record_sub]")
+{
+    rs_record_t rec;
+    rs_record_init(&rec, false);
+    record_sub_config_t cfg = {
+        .callback = rs_record_cb,
+        .user_ctx = &rec,
+        .queue_frames = 16,
+        .frame_samples = RS_TEST_FRAME,
+        .task_core = -1,
+    };
+    record_sub_handle_t sub = record_sub_create(&cfg, RS_TEST_RATE);
+    TEST_ASSERT_NOT_NULL(sub);
+
+    // 每块 400 点拆成 160 + 160 + 80，四块共 12 帧，不超过队列容量
+    const size_t block = 400;
+    for (int b = 0; b < 4; b++) {
+        TEST_ASSERT_EQUAL(3, rs_push_seq(sub, (int16_t)(b * block), block, b * block));
+    }
+    rs_wait_count(&rec, 12);
+    TEST_ASSERT_EQUAL_UINT32(0, rec.errors);
+
+    uint64_t index = 0;
+    for (int f = 0; f < 12; f++) {
+        size_t expected = f % 3 == 2 ? block - 2 * RS_TEST_FRAME : RS_TEST_FRAME;
+        TEST_ASSERT_EQUAL(expected, rec.samples[f]);
+        TEST_ASSERT_EQUAL_INT16((int16_t)index, rec.first[f]);
+        TEST_ASSERT_EQUAL_UINT64(index, rec.info[f].sample_index);
+        TEST_ASSERT_EQUAL_INT64(1000000 + (int64_t)index * 1000000 / RS_TEST_RATE, rec.info[f].timestamp_us);
+        index += expected;
+    }
+
+    record_sub_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, record_sub_get_stats(sub, &stats));
+    TEST_ASSERT_EQUAL_UINT32(12, stats.delivered_frames);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped_frames);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.queued_frames);
+
+    TEST_ASSERT_EQUAL(ESP_OK, record_sub_destroy(sub, 100));
+    rs_record_deinit(&rec);
+}
+
+TEST_CASE("record_sub 队列满时按策略丢弃最旧帧或新帧", "[record_sub]")
+{
+    const size_t queue_frames = 4;
+    const int pushes = 10;
+
+    for (int policy = RECORD_SUB_DROP_OLDEST; policy <= RECORD_SUB_DROP_NEWEST; policy++) {
+        rs_record_t rec;
+        rs_record_init(&rec, true);
+        record_sub_config_t cfg = {
+            .callback = rs_record_cb,
+            .user_ctx = &rec,
+            .queue_frames = queue_frames,
+            .frame_samples = RS_TEST_FRAME,
+            .drop_policy = (record_sub_drop_policy_t)policy,
+            .task_core = -1,
+        };
+        record_sub_handle_t sub = record_sub_create(&cfg, RS_TEST_RATE);
+        TEST_ASSERT_NOT_NULL(sub);
+
+        // 第 0 帧进入回调后阻塞，队列只剩 queue_frames - 1 个空闲帧
+        TEST_ASSERT_EQUAL(1, rs_push_seq(sub, 0, RS_TEST_FRAME, 0));
+        TEST_ASSERT_TRUE(xSemaphoreTake(rec.entered, pdMS_TO_TICKS(RS_TEST_TIMEOUT_MS)));
+        for (int i = 1; i <= pushes; i++) {
+            rs_push_seq(sub, (int16_t)(i * 1000), RS_TEST_FRAME, (uint64_t)i * RS_TEST_FRAME);
+        }
+
+        const size_t kept = queue_frames - 1;
+        record_sub_stats_t stats;
+        TEST_ASSERT_EQUAL(ESP_OK, record_sub_get_stats(sub, &stats));
+        TEST_ASSERT_EQUAL_UINT32(pushes - kept, stats.dropped_frames);
+        TEST_ASSERT_EQUAL_UINT32(kept, stats.queued_frames);
+
+        // 放行回调：第 0 帧之后是保留下来的 kept 帧
+        for (size_t i = 0; i <= kept; i++) {
+            xSemaphoreGive(rec.gate);
+        }
+        rs_wait_count(&rec, 1 + kept);
+        TEST_ASSERT_EQUAL_INT16(0, rec.first[0]);
+        for (size_t k = 0; k < kept; k++) {
+            int frame = policy == RECORD_SUB_DROP_OLDEST ? (int)(pushes - kept + 1 + k) : (int)(1 + k);
+            TEST_ASSERT_EQUAL_INT16((int16_t)(frame * 1000), rec.first[1 + k]);
+            TEST_ASSERT_EQUAL_UINT64((uint64_t)frame * RS_TEST_FRAME, rec.info[1 + k].sample_index);
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, rec.errors);
+
+        TEST_ASSERT_EQUAL(ESP_OK, record_sub_destroy(sub, 100));
+        rs_record_deinit(&rec);
+    }
+}
+
+TEST_CASE("record_sub 回调阻塞时销毁超时，回调返回后自行释放", "[record_sub]")
+{
+    rs_record_t rec;
+    rs_record_init(&rec, true);
+    record_sub_config_t cfg = {
+        .callback = rs_record_cb,
+        .user_ctx = &rec,
+        .queue_frames = 4,
+        .frame_samples = RS_TEST_FRAME,
+        .task_core = -1,
+    };
+    record_sub_handle_t sub = record_sub_create(&cfg, RS_TEST_RATE);
+    TEST_ASSERT_NOT_NULL(sub);
+
+    // 第 0 帧阻塞在回调里，第 1 帧排队
+    TEST_ASSERT_EQUAL(1, rs_push_seq(sub, 0, RS_TEST_FRAME, 0));
+    TEST_ASSERT_TRUE(xSemaphoreTake(rec.entered, pdMS_TO_TICKS(RS_TEST_TIMEOUT_MS)));
+    TEST_ASSERT_EQUAL(1, rs_push_seq(sub, 1000, RS_TEST_FRAME, RS_TEST_FRAME));
+
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, record_sub_destroy(sub, 50));
+    int64_t waited_ms = (esp_timer_get_time() - start) / 1000;
+    TEST_ASSERT_TRUE(waited_ms >= 40 && waited_ms < 1000);
+
+    // 放行后只完成正在执行的回调，排队的帧不再投递；投递任务退出时释放订阅者
+    xSemaphoreGive(rec.gate);
+    xSemaphoreGive(rec.gate);
+    rs_wait_count(&rec, 1);
+    vTaskDelay(pdMS_TO_TICKS(50));
+    TEST_ASSERT_EQUAL(1, atomic_load(&rec.count));
+    TEST_ASSERT_EQUAL_INT16(0, rec.first[0]);
+
+    rs_record_deinit(&rec);
+}
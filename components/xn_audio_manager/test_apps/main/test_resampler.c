@@ -0,0 +1,137 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_resampler.c
+ * @Description: 重采样器测试 - 正弦信噪比、分块无关性与耗时
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "resampler.h"
+#include "test_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RS_TEST_SECONDS     2
+#define RS_TEST_TONE_HZ     1000.0
+#define RS_TEST_AMPLITUDE   10000.0
+#define RS_TEST_MIN_SNR_DB  55.0
+
+/** 常见的 TTS / 音乐采样率转到 16kHz 播放，以及 8kHz 电话音频升采样 */
+static const uint32_t s_rates[][2] = {
+    {24000, 16000},
+    {22050, 16000},
+    {44100, 16000},
+    {48000, 16000},
+    {8000, 16000},
+};
+
+/**
+ * @brief 生成正弦输入
+ */
+static int16_t *rs_gen_tone(uint32_t rate, size_t n)
+{
+    int16_t *in = (int16_t *)malloc(n * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(in);
+    for (size_t i = 0; i < n; i++) {
+        in[i] = (int16_t)lround(RS_TEST_AMPLITUDE * sin(2 * M_PI * RS_TEST_TONE_HZ * i / rate));
+    }
+    return in;
+}
+
+TEST_CASE("resampler 正弦信噪比", "[resampler]")
+{
+    for (size_t r = 0; r < sizeof(s_rates) / sizeof(s_rates[0]); r++) {
+        uint32_t in_rate = s_rates[r][0], out_rate = s_rates[r][1];
+        size_t n = in_rate * RS_TEST_SECONDS;
+        int16_t *in = rs_gen_tone(in_rate, n);
+
+        resampler_handle_t rs = resampler_create(in_rate, out_rate);
+        TEST_ASSERT_NOT_NULL(rs);
+        int16_t *out = (int16_t *)malloc(resampler_max_output(rs, n) * sizeof(int16_t));
+        TEST_ASSERT_NOT_NULL(out);
+        size_t produced = resampler_process(rs, in, n, out);
+
+        // 输出长度与比例一致（误差不超过 1 点），跳过滤波器起始暂态后计算信噪比
+        size_t expected = (size_t)((uint64_t)n * out_rate / in_rate);
+        TEST_ASSERT_INT_WITHIN(1, expected, produced);
+        size_t skip = out_rate / 10;
+        double snr = test_sine_snr_db(out + skip, produced - skip, RS_TEST_TONE_HZ, out_rate);
+        printf("resampler %u -> %u: SNR %.1f dB\n", (unsigned)in_rate, (unsigned)out_rate, snr);
+        TEST_ASSERT_TRUE(snr >= RS_TEST_MIN_SNR_DB);
+
+        free(out);
+        free(in);
+        resampler_destroy(rs);
+    }
+}
+
+TEST_CASE("resampler 任意分块输出与整块一致", "[resampler]")
+{
+    const uint32_t in_rate = 22050, out_rate = 16000;
+    const size_t n = in_rate;
+    int16_t *in = (int16_t *)malloc(n * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(in);
+    test_gen_colored_noise(in, n, 3000, 7);
+
+    resampler_handle_t rs = resampler_create(in_rate, out_rate);
+    TEST_ASSERT_NOT_NULL(rs);
+    size_t cap = resampler_max_output(rs, n);
+    int16_t *whole = (int16_t *)malloc(cap * sizeof(int16_t));
+    int16_t *split = (int16_t *)malloc(cap * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(whole);
+    TEST_ASSERT_NOT_NULL(split);
+
+    size_t whole_len = resampler_process(rs, in, n, whole);
+
+    resampler_reset(rs);
+    uint32_t seed = 99;
+    size_t split_len = 0;
+    for (size_t off = 0; off < n;) {
+        size_t count = 1 + test_rand(&seed) % 700;
+        if (count > n - off) count = n - off;
+        split_len += resampler_process(rs, in + off, count, split + split_len);
+        off += count;
+    }
+
+    TEST_ASSERT_EQUAL(whole_len, split_len);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(whole, split, whole_len);
+
+    free(split);
+    free(whole);
+    free(in);
+    resampler_destroy(rs);
+}
+
+TEST_CASE("resampler 每个输出采样点的周期数", "[resampler][bench]")
+{
+    for (size_t r = 0; r < sizeof(s_rates) / sizeof(s_rates[0]); r++) {
+        uint32_t in_rate = s_rates[r][0], out_rate = s_rates[r][1];
+        size_t n = in_rate;
+        int16_t *in = rs_gen_tone(in_rate, n);
+        resampler_handle_t rs = resampler_create(in_rate, out_rate);
+        TEST_ASSERT_NOT_NULL(rs);
+        int16_t *out = (int16_t *)malloc(resampler_max_output(rs, 512) * sizeof(int16_t));
+        TEST_ASSERT_NOT_NULL(out);
+
+        // 按播放任务的典型块长（512 点）处理 10 秒音频，逐块累加周期差（避免 32 位计数回绕）
+        uint64_t cycles = 0;
+        uint64_t produced = 0;
+        for (int rep = 0; rep < 10; rep++) {
+            for (size_t off = 0; off < n; off += 512) {
+                uint32_t t0 = test_cycles();
+                produced += resampler_process(rs, in + off, n - off < 512 ? n - off : 512, out);
+                cycles += (uint32_t)(test_cycles() - t0);
+            }
+        }
+        TEST_ASSERT_TRUE(produced > 0);
+        printf("resampler %u -> %u: %.1f 周期/输出点\n", (unsigned)in_rate, (unsigned)out_rate,
+               (double)cycles / produced);
+
+        free(out);
+        free(in);
+        resampler_destroy(rs);
+    }
+}
@@ -0,0 +1,535 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_ring_buffer.c
+ * @Description: 环形缓冲区测试 - SPSC 并发完整性、统计快照一致、覆盖写入下的序号单调、零拷贝覆盖检测、
+ *               与互斥锁实现的吞吐和延迟对比、回采路径逐跳拷贝量
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "ring_buffer.h"
+#include "test_util.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RB_TEST_CAPACITY    4096
+#define RB_TEST_CHUNK       160                 ///< 10ms @16kHz
+#define RB_TEST_SAMPLES     (16000 * 60)        ///< 60 秒音频
+
+/** 以互斥锁保护的对照实现（ring_buffer 改为 SPSC 之前的做法） */
+typedef struct {
+    SemaphoreHandle_t mutex;
+    int16_t *buf;
+    size_t size;
+    size_t head;
+    size_t tail;
+    size_t count;
+} mutex_ring_t;
+
+static size_t mutex_ring_write(mutex_ring_t *r, const int16_t *data, size_t n)
+{
+    xSemaphoreTake(r->mutex, portMAX_DELAY);
+    size_t space = r->size - r->count;
+    if (n > space) n = space;
+    for (size_t i = 0; i < n; i++) {
+        r->buf[r->head] = data[i];
+        r->head = (r->head + 1) % r->size;
+    }
+    r->count += n;
+    xSemaphoreGive(r->mutex);
+    return n;
+}
+
+static size_t mutex_ring_count(mutex_ring_t *r)
+{
+    xSemaphoreTake(r->mutex, portMAX_DELAY);
+    size_t n = r->count;
+    xSemaphoreGive(r->mutex);
+    return n;
+}
+
+static size_t mutex_ring_read(mutex_ring_t *r, int16_t *out, size_t n)
+{
+    xSemaphoreTake(r->mutex, portMAX_DELAY);
+    if (n > r->count) n = r->count;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = r->buf[r->tail];
+        r->tail = (r->tail + 1) % r->size;
+    }
+    r->count -= n;
+    xSemaphoreGive(r->mutex);
+    return n;
+}
+
+/** 交接延迟统计：生产者写入每块前记录时间，消费者读到块首时累计 */
+typedef struct {
+    int64_t *stamps;            ///< 每块（RB_TEST_CHUNK 点）的写入时间
+    int64_t sum_us;
+    int64_t max_us;
+    uint32_t count;
+} rb_latency_t;
+
+/** 生产者任务参数 */
+typedef struct {
+    ring_buffer_handle_t rb;    ///< SPSC 实现（非 NULL 时使用）
+    mutex_ring_t *mr;           ///< 互斥锁实现
+    uint32_t seed;              ///< 分块长度随机种子（0 表示固定 RB_TEST_CHUNK）
+    rb_latency_t *lat;          ///< 非 NULL 时测交接延迟：等缓冲区读空再写下一块（要求 seed 为 0）
+    bool yield_each;            ///< 每块写入后让出 CPU（覆盖写入时给消费者提交的机会）
+    SemaphoreHandle_t done;     ///< 写完后释放
+} rb_producer_t;
+
+/**
+ * @brief 生产者：按序号写入 RB_TEST_SAMPLES 个采样点，写不下时让出 CPU 重试
+ */
+static void rb_producer_task(void *arg)
+{
+    rb_producer_t *p = (rb_producer_t *)arg;
+    int16_t chunk[2 * RB_TEST_CHUNK];
+    uint32_t seq = 0;
+
+    while (seq < RB_TEST_SAMPLES) {
+        size_t n = p->seed ? 1 + test_rand(&p->seed) % (2 * RB_TEST_CHUNK) : RB_TEST_CHUNK;
+        if (n > RB_TEST_SAMPLES - seq) n = RB_TEST_SAMPLES - seq;
+        for (size_t i = 0; i < n; i++) {
+            chunk[i] = (int16_t)(seq + i);
+        }
+        if (p->lat) {
+            while (p->rb ? ring_buffer_available(p->rb) : mutex_ring_count(p->mr)) {
+                taskYIELD();
+            }
+            p->lat->stamps[seq / RB_TEST_CHUNK] = esp_timer_get_time();
+        }
+        size_t off = 0;
+        while (off < n) {
+            size_t w = p->rb ? ring_buffer_write(p->rb, chunk + off, n - off) :
+                               mutex_ring_write(p->mr, chunk + off, n - off);
+            off += w;
+            if (off < n || p->yield_each) {
+                taskYIELD();
+            }
+        }
+        seq += n;
+    }
+
+    xSemaphoreGive(p->done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief 消费者（在测试任务中运行）：读到 RB_TEST_SAMPLES 个采样点，返回序号错误数
+ */
+static uint32_t rb_consume(ring_buffer_handle_t rb, mutex_ring_t *mr, uint32_t seed, rb_latency_t *lat)
+{
+    int16_t chunk[2 * RB_TEST_CHUNK];
+    uint32_t seq = 0;
+    uint32_t errors = 0;
+
+    while (seq < RB_TEST_SAMPLES) {
+        size_t want = seed ? 1 + test_rand(&seed) % (2 * RB_TEST_CHUNK) : RB_TEST_CHUNK;
+        size_t got = rb ? ring_buffer_read(rb, chunk, want, 0) : mutex_ring_read(mr, chunk, want);
+        if (got == 0) {
+            taskYIELD();
+            continue;
+        }
+        if (lat && seq % RB_TEST_CHUNK == 0) {
+            int64_t d = esp_timer_get_time() - lat->stamps[seq / RB_TEST_CHUNK];
+            lat->sum_us += d;
+            lat->max_us = d > lat->max_us ? d : lat->max_us;
+            lat->count++;
+        }
+        for (size_t i = 0; i < got; i++) {
+            if (chunk[i] != (int16_t)(seq + i)) {
+                errors++;
+            }
+        }
+        seq += got;
+    }
+    return errors;
+}
+
+/**
+ * @brief 运行一次生产者/消费者，返回耗时（微秒）
+ */
+static int64_t rb_run(ring_buffer_handle_t rb, mutex_ring_t *mr, uint32_t seed,
+                      rb_latency_t *lat, uint32_t *errors)
+{
+    rb_producer_t p = {
+        .rb = rb,
+        .mr = mr,
+        .seed = seed,
+        .lat = lat,
+        .done = xSemaphoreCreateBinary(),
+    };
+    TEST_ASSERT_NOT_NULL(p.done);
+
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(rb_producer_task, "rb_prod", 4096, &p, 5, NULL));
+    *errors = rb_consume(rb, mr, seed ? seed * 7 : 0, lat);
+    TEST_ASSERT_TRUE(xSemaphoreTake(p.done, portMAX_DELAY));
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    vSemaphoreDelete(p.done);
+    return elapsed;
+}
+
+TEST_CASE("ring_buffer SPSC 并发读写不丢不乱", "[ring_buffer]")
+{
+    ring_buffer_handle_t rb = ring_buffer_create(RB_TEST_CAPACITY, true);
+    TEST_ASSERT_NOT_NULL(rb);
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_set_overflow_policy(rb, RING_BUFFER_OVERFLOW_DROP_NEWEST, 0));
+
+    uint32_t errors = 0;
+    rb_run(rb, NULL, 12345, NULL, &errors);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+
+    ring_buffer_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_get_stats(rb, &stats));
+    TEST_ASSERT_EQUAL_UINT64(RB_TEST_SAMPLES, stats.total_read);
+    TEST_ASSERT_EQUAL(0, ring_buffer_available(rb));
+    TEST_ASSERT_TRUE(stats.max_fill <= RB_TEST_CAPACITY);
+
+    ring_buffer_destroy(rb);
+}
+
+/** 统计轮询任务参数 */
+typedef struct {
+    ring_buffer_handle_t rb;
+    atomic_bool stop;
+    uint32_t snapshots;         ///< 取到的快照数
+    uint32_t errors;            ///< 不一致的快照数
+    SemaphoreHandle_t done;
+} rb_stats_poller_t;
+
+/**
+ * @brief 读写进行中反复取统计快照：计数只增不减，读出量不超过写入量
+ */
+static void rb_stats_poller_task(void *arg)
+{
+    rb_stats_poller_t *p = (rb_stats_poller_t *)arg;
+    ring_buffer_stats_t prev = { 0 };
+
+    while (!atomic_load(&p->stop)) {
+        ring_buffer_stats_t cur;
+        if (ring_buffer_get_stats(p->rb, &cur) != ESP_OK ||
+            cur.total_read > cur.total_written || cur.total_written > RB_TEST_SAMPLES ||
+            cur.total_written < prev.total_written || cur.total_read < prev.total_read ||
+            cur.empty_reads < prev.empty_reads || cur.max_fill < prev.max_fill) {
+            p->errors++;
+        }
+        prev = cur;
+        p->snapshots++;
+        taskYIELD();
+    }
+    xSemaphoreGive(p->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("ring_buffer 读写并发时统计快照一致", "[ring_buffer]")
+{
+    ring_buffer_handle_t rb = ring_buffer_create(RB_TEST_CAPACITY, true);
+    TEST_ASSERT_NOT_NULL(rb);
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_set_overflow_policy(rb, RING_BUFFER_OVERFLOW_DROP_NEWEST, 0));
+
+    rb_stats_poller_t poller = {
+        .rb = rb,
+        .done = xSemaphoreCreateBinary(),
+    };
+    atomic_init(&poller.stop, false);
+    TEST_ASSERT_NOT_NULL(poller.done);
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(rb_stats_poller_task, "rb_stats", 4096, &poller, 5, NULL));
+
+    uint32_t errors = 0;
+    rb_run(rb, NULL, 4242, NULL, &errors);
+    atomic_store(&poller.stop, true);
+    TEST_ASSERT_TRUE(xSemaphoreTake(poller.done, portMAX_DELAY));
+    vSemaphoreDelete(poller.done);
+
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_TRUE(poller.snapshots > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, poller.errors);
+
+    ring_buffer_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_get_stats(rb, &stats));
+    TEST_ASSERT_EQUAL_UINT64(RB_TEST_SAMPLES, stats.total_written);
+    TEST_ASSERT_EQUAL_UINT64(RB_TEST_SAMPLES, stats.total_read);
+
+    ring_buffer_destroy(rb);
+}
+
+TEST_CASE("ring_buffer DROP_OLDEST 覆盖与读取并发时序号单调", "[ring_buffer]")
+{
+    // 容量小于一次写入的上限，生产者频繁推进 read_pos，与消费者的 CAS 提交竞争
+    ring_buffer_handle_t rb = ring_buffer_create(RB_TEST_CHUNK * 2, false);
+    TEST_ASSERT_NOT_NULL(rb);
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_set_overflow_policy(rb, RING_BUFFER_OVERFLOW_DROP_OLDEST, 0));
+
+    rb_producer_t p = {
+        .rb = rb,
+        .seed = 54321,
+        .yield_each = true,
+        .done = xSemaphoreCreateBinary(),
+    };
+    TEST_ASSERT_NOT_NULL(p.done);
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(rb_producer_task, "rb_prod", 4096, &p, 5, NULL));
+
+    // 双方每块都让出 CPU，消费者每次读得少，生产者持续覆盖消费者正在复制的区间；
+    // 一次读出的数据必须连续，相邻两次之间可以有被覆盖的缺口，但序号只能前进
+    int16_t chunk[RB_TEST_CHUNK];
+    uint32_t seed = 777;
+    uint32_t errors = 0;
+    uint64_t received = 0;
+    bool have_prev = false;
+    bool producer_done = false;
+    uint16_t prev = 0;
+    for (;;) {
+        size_t got = ring_buffer_read(rb, chunk, 1 + test_rand(&seed) % (RB_TEST_CHUNK / 4), 0);
+        if (got == 0) {
+            if (producer_done) {
+                break;
+            }
+            producer_done = xSemaphoreTake(p.done, 0) == pdTRUE;
+            taskYIELD();
+            continue;
+        }
+        for (size_t i = 0; i < got; i++) {
+            uint16_t cur = (uint16_t)chunk[i];
+            uint16_t step = (uint16_t)(cur - prev);
+            if (have_prev && (i > 0 ? step != 1 : (step == 0 || step > 0x7FFF))) {
+                errors++;
+            }
+            prev = cur;
+            have_prev = true;
+        }
+        received += got;
+        taskYIELD();
+    }
+    vSemaphoreDelete(p.done);
+
+    // 最后一个采样点总会被读到，每个采样点要么被读出要么被计为覆盖
+    ring_buffer_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_get_stats(rb, &stats));
+    printf("ring_buffer DROP_OLDEST: 读出 %llu 点，覆盖 %llu 点\n",
+           (unsigned long long)received, (unsigned long long)stats.overrun_samples);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(RB_TEST_SAMPLES - 1), prev);
+    TEST_ASSERT_EQUAL_UINT64(received, stats.total_read);
+    TEST_ASSERT_EQUAL_UINT64(RB_TEST_SAMPLES, received + stats.overrun_samples);
+    TEST_ASSERT_TRUE(stats.overrun_samples > 0);
+
+    ring_buffer_destroy(rb);
+}
+
+TEST_CASE("ring_buffer 零拷贝区间被覆盖时 release 失败并计数", "[ring_buffer]")
+{
+    ring_buffer_handle_t rb = ring_buffer_create(256, false);
+    TEST_ASSERT_NOT_NULL(rb);
+
+    int16_t data[256];
+    for (int i = 0; i < 256; i++) {
+        data[i] = (int16_t)i;
+    }
+    TEST_ASSERT_EQUAL(100, ring_buffer_write(rb, data, 100));
+
+    // 正常的 peek/release
+    ring_buffer_span_t span;
+    TEST_ASSERT_EQUAL(50, ring_buffer_peek_read(rb, 50, &span, 0));
+    TEST_ASSERT_EQUAL(50, span.len[0] + span.len[1]);
+    TEST_ASSERT_EQUAL_INT16(0, span.data[0][0]);
+    TEST_ASSERT_TRUE(ring_buffer_release_read(rb, 50));
+    TEST_ASSERT_EQUAL(50, ring_buffer_available(rb));
+
+    // 处理期间生产者按 DROP_OLDEST 覆盖了区间
+    TEST_ASSERT_EQUAL(50, ring_buffer_peek_read(rb, 50, &span, 0));
+    TEST_ASSERT_EQUAL(256, ring_buffer_write(rb, data, 256));
+    TEST_ASSERT_FALSE(ring_buffer_release_read(rb, 50));
+
+    ring_buffer_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_get_stats(rb, &stats));
+    TEST_ASSERT_EQUAL_UINT32(1, stats.peek_overruns);
+    TEST_ASSERT_TRUE(stats.overrun_samples > 0);
+
+    // 覆盖后读到的是最新的完整数据
+    int16_t out[256];
+    TEST_ASSERT_EQUAL(256, ring_buffer_read(rb, out, 256, 0));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(data, out, 256);
+
+    ring_buffer_destroy(rb);
+}
+
+TEST_CASE("ring_buffer SPSC 与互斥锁实现吞吐和延迟对比", "[ring_buffer][bench]")
+{
+    ring_buffer_handle_t rb = ring_buffer_create(RB_TEST_CAPACITY, true);
+    TEST_ASSERT_NOT_NULL(rb);
+    TEST_ASSERT_EQUAL(ESP_OK, ring_buffer_set_overflow_policy(rb, RING_BUFFER_OVERFLOW_DROP_NEWEST, 0));
+
+    mutex_ring_t mr = {
+        .mutex = xSemaphoreCreateMutex(),
+        .buf = (int16_t *)malloc(RB_TEST_CAPACITY * sizeof(int16_t)),
+        .size = RB_TEST_CAPACITY,
+    };
+    TEST_ASSERT_NOT_NULL(mr.mutex);
+    TEST_ASSERT_NOT_NULL(mr.buf);
+
+    // 吞吐：生产者全速写入，缓冲区满时让出 CPU
+    uint32_t errors = 0;
+    int64_t spsc_us = rb_run(rb, NULL, 0, NULL, &errors);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    int64_t mutex_us = rb_run(NULL, &mr, 0, NULL, &errors);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+
+    // 延迟：缓冲区读空后才写下一块，测量写入到消费者读出的时间
+    rb_latency_t spsc_lat = { .stamps = (int64_t *)calloc(RB_TEST_SAMPLES / RB_TEST_CHUNK, sizeof(int64_t)) };
+    rb_latency_t mutex_lat = { .stamps = (int64_t *)calloc(RB_TEST_SAMPLES / RB_TEST_CHUNK, sizeof(int64_t)) };
+    TEST_ASSERT_NOT_NULL(spsc_lat.stamps);
+    TEST_ASSERT_NOT_NULL(mutex_lat.stamps);
+    rb_run(rb, NULL, 0, &spsc_lat, &errors);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    rb_run(NULL, &mr, 0, &mutex_lat, &errors);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_EQUAL_UINT32(RB_TEST_SAMPLES / RB_TEST_CHUNK, spsc_lat.count);
+    TEST_ASSERT_EQUAL_UINT32(RB_TEST_SAMPLES / RB_TEST_CHUNK, mutex_lat.count);
+
+    printf("ring_buffer 吞吐: %d 个采样点（%d 点一块）SPSC %.2f M点/秒，互斥锁 %.2f M点/秒\n",
+           RB_TEST_SAMPLES, RB_TEST_CHUNK,
+           (double)RB_TEST_SAMPLES / spsc_us, (double)RB_TEST_SAMPLES / mutex_us);
+    printf("ring_buffer 交接延迟: SPSC 平均 %.1f us / 最大 %d us，互斥锁 平均 %.1f us / 最大 %d us\n",
+           (double)spsc_lat.sum_us / spsc_lat.count, (int)spsc_lat.max_us,
+           (double)mutex_lat.sum_us / mutex_lat.count, (int)mutex_lat.max_us);
+
+    free(mutex_lat.stamps);
+    free(spsc_lat.stamps);
+    free(mr.buf);
+    vSemaphoreDelete(mr.mutex);
+    ring_buffer_destroy(rb);
+}
+
+#define RB_HOP_RATE     16000   ///< 回采路径基准：1 秒 16kHz 音频
+#define RB_HOP_FRAME    512     ///< 播放任务每帧采样点数
+#define RB_HOP_COUNT    4
+
+/** 回采路径的各跳：播放任务取帧、写回采缓冲区，AFE 读回采、交织成 AFE 输入 */
+static const char *const s_hop_names[RB_HOP_COUNT] = {
+    "读出播放帧", "写入回采缓冲区", "读出回采帧", "交织到 AFE 输入",
+};
+
+/**
+ * @brief 零拷贝之前的做法：每跳都经过一个临时帧
+ */
+static void rb_hop_copy(ring_buffer_handle_t play, ring_buffer_handle_t ref, int16_t *interleaved,
+                        size_t hops[RB_HOP_COUNT])
+{
+    int16_t frame[RB_HOP_FRAME];
+    int16_t ref_buf[RB_HOP_FRAME];
+
+    size_t got = ring_buffer_read(play, frame, RB_HOP_FRAME, 0);
+    hops[0] += got * sizeof(int16_t);
+    ring_buffer_write(ref, frame, got);
+    hops[1] += got * sizeof(int16_t);
+
+    size_t n = ring_buffer_read(ref, ref_buf, got, 0);
+    hops[2] += n * sizeof(int16_t);
+    for (size_t i = 0; i < n; i++) {
+        interleaved[2 * i + 1] = ref_buf[i];
+    }
+    hops[3] += n * sizeof(int16_t);
+}
+
+/**
+ * @brief 零拷贝：peek 出的区间直接写入回采缓冲区、直接交织
+ */
+static void rb_hop_zero_copy(ring_buffer_handle_t play, ring_buffer_handle_t ref, int16_t *interleaved,
+                             size_t hops[RB_HOP_COUNT])
+{
+    ring_buffer_span_t span;
+    size_t got = ring_buffer_peek_read(play, RB_HOP_FRAME, &span, 0);
+    for (int seg = 0; seg < 2; seg++) {
+        ring_buffer_write(ref, span.data[seg], span.len[seg]);
+        hops[1] += span.len[seg] * sizeof(int16_t);
+    }
+    ring_buffer_release_read(play, got);
+
+    size_t n = ring_buffer_peek_read(ref, got, &span, 0);
+    size_t i = 0;
+    for (int seg = 0; seg < 2; seg++) {
+        for (size_t k = 0; k < span.len[seg]; k++, i++) {
+            interleaved[2 * i + 1] = span.data[seg][k];
+        }
+        hops[3] += span.len[seg] * sizeof(int16_t);
+    }
+    ring_buffer_release_read(ref, n);
+}
+
+/**
+ * @brief 送 1 秒音频经过回采路径，统计各跳拷贝字节数，返回每个采样点的周期数
+ */
+static double rb_hop_run(bool zero_copy, const int16_t *pcm, size_t hops[RB_HOP_COUNT])
+{
+    // 容量不是帧长的整数倍，区间会在环尾折返成两段
+    ring_buffer_handle_t play = ring_buffer_create(RB_HOP_FRAME * 3 + 100, false);
+    ring_buffer_handle_t ref = ring_buffer_create(RB_HOP_FRAME * 3 + 100, false);
+    TEST_ASSERT_NOT_NULL(play);
+    TEST_ASSERT_NOT_NULL(ref);
+    int16_t interleaved[RB_HOP_FRAME * 2];
+
+    uint64_t cycles = 0;
+    for (size_t off = 0; off < RB_HOP_RATE; off += RB_HOP_FRAME) {
+        size_t n = RB_HOP_RATE - off < RB_HOP_FRAME ? RB_HOP_RATE - off : RB_HOP_FRAME;
+        TEST_ASSERT_EQUAL(n, ring_buffer_write(play, pcm + off, n));
+
+        uint32_t t0 = test_cycles();
+        if (zero_copy) {
+            rb_hop_zero_copy(play, ref, interleaved, hops);
+        } else {
+            rb_hop_copy(play, ref, interleaved, hops);
+        }
+        cycles += (uint32_t)(test_cycles() - t0);
+
+        for (size_t i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_INT16(pcm[off + i], interleaved[2 * i + 1]);
+        }
+    }
+
+    ring_buffer_destroy(ref);
+    ring_buffer_destroy(play);
+    return (double)cycles / RB_HOP_RATE;
+}
+
+TEST_CASE("ring_buffer 回采路径每跳拷贝量（零拷贝前后）", "[ring_buffer][bench]")
+{
+    int16_t *pcm = (int16_t *)malloc(RB_HOP_RATE * sizeof(int16_t));
+    TEST_ASSERT_NOT_NULL(pcm);
+    test_gen_colored_noise(pcm, RB_HOP_RATE, 3000, 31);
+
+    size_t copy_hops[RB_HOP_COUNT] = { 0 };
+    size_t zc_hops[RB_HOP_COUNT] = { 0 };
+    double copy_cycles = rb_hop_run(false, pcm, copy_hops);
+    double zc_cycles = rb_hop_run(true, pcm, zc_hops);
+
+    size_t copy_total = 0, zc_total = 0;
+    printf("ring_buffer 回采路径（每秒 %d Hz 音频）拷贝字节数：\n", RB_HOP_RATE);
+    for (int h = 0; h < RB_HOP_COUNT; h++) {
+        printf("  %s: 拷贝 %u B，零拷贝 %u B\n", s_hop_names[h], (unsigned)copy_hops[h], (unsigned)zc_hops[h]);
+        copy_total += copy_hops[h];
+        zc_total += zc_hops[h];
+    }
+    printf("  合计: 拷贝 %u B/秒（%.1f 周期/点），零拷贝 %u B/秒（%.1f 周期/点）\n",
+           (unsigned)copy_total, copy_cycles, (unsigned)zc_total, zc_cycles);
+
+    // 每跳搬运一遍 16bit 数据；零拷贝省掉进出临时帧的两跳
+    TEST_ASSERT_EQUAL(RB_HOP_COUNT * RB_HOP_RATE * sizeof(int16_t), copy_total);
+    TEST_ASSERT_EQUAL(0, zc_hops[0]);
+    TEST_ASSERT_EQUAL(0, zc_hops[2]);
+    TEST_ASSERT_EQUAL(copy_total / 2, zc_total);
+
+    free(pcm);
+}
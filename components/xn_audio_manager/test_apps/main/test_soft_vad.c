@@ -0,0 +1,109 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:21:54
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_soft_vad.c
+ * @Description: 软件 VAD 测试 - 噪声中的人声起止、低频嗡声不误触发
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#include "unity.h"
+#include "soft_vad.h"
+#include "test_util.h"
+#include <stdlib.h>
+
+#define VAD_TEST_RATE       16000
+#define VAD_TEST_CHUNK      256         ///< 不是帧长（320）的整数倍，覆盖跨块拼帧
+
+/** 一段测试信号 */
+typedef enum {
+    VAD_SEG_NOISE,      ///< 背景白噪声
+    VAD_SEG_SPEECH,     ///< 背景噪声 + 类语音信号（200Hz 基频谐波 + 低通噪声）
+    VAD_SEG_HUM,        ///< 背景噪声 + 20Hz 大幅度嗡声
+} vad_seg_t;
+
+/** 处理结果 */
+typedef struct {
+    int start_ms;       ///< 第一次 START 事件相对段起点的时间（-1 表示没有）
+    int end_ms;         ///< 第一次 END 事件相对段起点的时间（-1 表示没有）
+} vad_seg_result_t;
+
+/**
+ * @brief 生成一段信号并按块送入 VAD，记录事件时间
+ */
+static vad_seg_result_t vad_run(soft_vad_handle_t vad, vad_seg_t seg, int ms, uint32_t *seed)
+{
+    vad_seg_result_t res = {-1, -1};
+    int16_t chunk[VAD_TEST_CHUNK];
+    size_t total = (size_t)VAD_TEST_RATE * ms / 1000;
+    double lp = 0;
+
+    for (size_t pos = 0; pos < total; pos += VAD_TEST_CHUNK) {
+        size_t n = total - pos < VAD_TEST_CHUNK ? total - pos : VAD_TEST_CHUNK;
+        for (size_t i = 0; i < n; i++) {
+            double t = (double)(pos + i) / VAD_TEST_RATE;
+            double v = 30 * test_rand_unit(seed);
+            if (seg == VAD_SEG_SPEECH) {
+                lp = 0.8 * lp + 0.2 * test_rand_unit(seed);
+                v += 2000 * (sin(2 * M_PI * 200 * t) + 0.5 * sin(2 * M_PI * 400 * t) +
+                             0.3 * sin(2 * M_PI * 600 * t)) + 3000 * lp;
+            } else if (seg == VAD_SEG_HUM) {
+                v += 8000 * sin(2 * M_PI * 20 * t);
+            }
+            chunk[i] = (int16_t)v;
+        }
+
+        soft_vad_event_t ev = soft_vad_process(vad, chunk, n);
+        int at_ms = (int)((pos + n) * 1000 / VAD_TEST_RATE);
+        if (ev == SOFT_VAD_EVENT_START && res.start_ms < 0) res.start_ms = at_ms;
+        if (ev == SOFT_VAD_EVENT_END && res.end_ms < 0) res.end_ms = at_ms;
+    }
+    return res;
+}
+
+TEST_CASE("soft_vad 噪声中的人声起止", "[soft_vad]")
+{
+    soft_vad_handle_t vad = soft_vad_create(NULL);
+    TEST_ASSERT_NOT_NULL(vad);
+    uint32_t seed = 3;
+
+    // 只有背景噪声：学习噪声基底，不触发
+    vad_seg_result_t res = vad_run(vad, VAD_SEG_NOISE, 2000, &seed);
+    TEST_ASSERT_EQUAL(-1, res.start_ms);
+    TEST_ASSERT_FALSE(soft_vad_is_speech(vad));
+    float floor_db = soft_vad_get_noise_floor_db(vad);
+
+    // 人声：默认 200ms 后报告开始（允许一帧拼帧误差）
+    res = vad_run(vad, VAD_SEG_SPEECH, 1000, &seed);
+    TEST_ASSERT_INT_WITHIN(40, 210, res.start_ms);
+    TEST_ASSERT_EQUAL(-1, res.end_ms);
+    TEST_ASSERT_TRUE(soft_vad_is_speech(vad));
+    // 1 秒人声不会把噪声基底抬到语音电平
+    TEST_ASSERT_TRUE(soft_vad_get_noise_floor_db(vad) < floor_db + 6.0f);
+
+    // 回到噪声：默认 400ms 后报告结束
+    res = vad_run(vad, VAD_SEG_NOISE, 1000, &seed);
+    TEST_ASSERT_INT_WITHIN(40, 410, res.end_ms);
+    TEST_ASSERT_FALSE(soft_vad_is_speech(vad));
+
+    soft_vad_destroy(vad);
+}
+
+TEST_CASE("soft_vad 低频嗡声不触发", "[soft_vad]")
+{
+    soft_vad_handle_t vad = soft_vad_create(NULL);
+    TEST_ASSERT_NOT_NULL(vad);
+    uint32_t seed = 4;
+
+    vad_run(vad, VAD_SEG_NOISE, 1000, &seed);
+    vad_seg_result_t res = vad_run(vad, VAD_SEG_HUM, 2000, &seed);
+    TEST_ASSERT_EQUAL(-1, res.start_ms);
+    TEST_ASSERT_FALSE(soft_vad_is_speech(vad));
+
+    // reset 后回到静音状态
+    soft_vad_reset(vad);
+    TEST_ASSERT_FALSE(soft_vad_is_speech(vad));
+
+    soft_vad_destroy(vad);
+}
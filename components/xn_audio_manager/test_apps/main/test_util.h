@@ -0,0 +1,113 @@
+/*
+ * @Author: 星年 && jixingnian@gmail.com
+ * @Date: 2025-11-27 19:17:04
+ * @LastEditors: xingnian jixingnian@gmail.com
+ * @LastEditTime: 2025-11-27 19:20:05
+ * @FilePath: \xn_esp32_audio\components\audio_manager\test_apps\main\test_util.h
+ * @Description: 测试公用工具 - 可复现的伪随机数、测试信号、正弦拟合与周期计数
+ *
+ * Copyright (c) 2025 by ${git_name_email}, All Rights Reserved.
+ */
+#pragma once
+
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_LINUX
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+#else
+#include "esp_cpu.h"
+#endif
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief xorshift32 伪随机数（各平台结果一致，用例可复现）
+ */
+static inline uint32_t test_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/**
+ * @brief [-1, 1) 均匀分布
+ */
+static inline double test_rand_unit(uint32_t *state)
+{
+    return (double)test_rand(state) / 2147483648.0 - 1.0;
+}
+
+/**
+ * @brief 生成类语音的测试信号：二阶低通噪声乘慢变包络
+ * @param out 输出
+ * @param n 采样点数
+ * @param amplitude 幅度
+ * @param seed 随机种子
+ */
+static inline void test_gen_colored_noise(int16_t *out, size_t n, double amplitude, uint32_t seed)
+{
+    double lp = 0, lp2 = 0;
+    for (size_t i = 0; i < n; i++) {
+        lp = 0.9 * lp + test_rand_unit(&seed) * 0.5;
+        lp2 = 0.7 * lp2 + lp;
+        double env = 0.5 + 0.5 * sin(i * 0.002);
+        double v = lp2 * amplitude * env;
+        out[i] = (int16_t)(v > 32767 ? 32767 : v < -32768 ? -32768 : v);
+    }
+}
+
+/**
+ * @brief 最小二乘拟合已知频率的正弦，返回信号与残差的功率比（dB）
+ * @param x 信号
+ * @param n 采样点数
+ * @param freq 频率（Hz）
+ * @param rate 采样率（Hz）
+ */
+static inline double test_sine_snr_db(const int16_t *x, size_t n, double freq, double rate)
+{
+    double ss = 0, sc = 0, cc = 0, xs = 0, xc = 0;
+    for (size_t i = 0; i < n; i++) {
+        double s = sin(2 * M_PI * freq * i / rate);
+        double c = cos(2 * M_PI * freq * i / rate);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        xs += x[i] * s;
+        xc += x[i] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (xs * cc - xc * sc) / det;
+    double b = (xc * ss - xs * sc) / det;
+    double sig = 0, err = 0;
+    for (size_t i = 0; i < n; i++) {
+        double fit = a * sin(2 * M_PI * freq * i / rate) + b * cos(2 * M_PI * freq * i / rate);
+        sig += fit * fit;
+        err += (x[i] - fit) * (x[i] - fit);
+    }
+    return 10 * log10(sig / (err > 0 ? err : 1e-9));
+}
+
+/**
+ * @brief 读取 CPU 周期计数（32 位回绕，基准中只取相邻两次的差值累加）
+ *
+ * 设备上为 CPU 周期；主机上 x86 为 TSC 计数，其他架构退化为纳秒
+ */
+static inline uint32_t test_cycles(void)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    return (uint32_t)esp_cpu_get_cycle_count();
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#endif
+}
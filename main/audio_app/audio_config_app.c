@@ -68,12 +68,21 @@ void audio_config_app_build(audio_mgr_config_t *cfg,
     cfg->vad_config.vad_mode = 2;             // VAD 模式 2（中等灵敏度）
     cfg->vad_config.min_speech_ms = 200;      // 最小语音持续时间 200ms
     cfg->vad_config.min_silence_ms = 400;     // 最小静音持续时间 400ms
+    cfg->vad_config.preroll_ms = 400;         // 预录 400ms：覆盖 VAD 确认语音前的句首
+    cfg->vad_config.listen_only = false;      // 低功耗监听：空闲时只跑软件 VAD（需要省电时开启）
 
     // ========== AFE（音频前端处理）配置 ==========
     cfg->afe_config.aec_enabled = true;       // 启用回声消除（AEC）
     cfg->afe_config.ns_enabled = true;        // 启用降噪（NS）
     cfg->afe_config.agc_enabled = true;       // 启用自动增益控制（AGC）
+    cfg->afe_config.drift_comp_enabled = true; // 麦克风与扬声器分属两个 I2S 端口，启用时钟漂移补偿
+    cfg->afe_config.ref_delay_samples = -1;   // 回采延迟：首次播放时自动估计（可改为持久化的估计值）
     cfg->afe_config.afe_mode = 1;             // AFE 模式：高质量
+    cfg->afe_config.feed_task_priority = 8;   // AFE feed 任务：优先级 8，运行在 CPU1
+    cfg->afe_config.feed_task_core = 1;
+    cfg->afe_config.fetch_task_priority = 8;  // AFE fetch 任务：优先级 8，运行在 CPU0（与 feed 分核）
+    cfg->afe_config.fetch_task_core = 0;
+    cfg->afe_config.stats_log_interval_ms = 30000; // 每 30 秒打印一次 AFE 流水线延迟/负载统计（0 关闭）
 
     // ========== 回调配置 ==========
     cfg->event_callback = event_cb;           // 设置事件回调函数
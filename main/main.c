@@ -40,9 +40,10 @@ static void funasr_status_callback(bool connected, void *user_data)
 
 // ========== 音频录音回调 ==========
 
-static void audio_record_callback(const int16_t *pcm_data, size_t sample_count, void *user_ctx)
+static void audio_record_callback(const int16_t *pcm_data, size_t sample_count,
+                                  const audio_frame_info_t *info, void *user_ctx)
 {
-    // 始终消费数据,避免 AFE 缓冲区溢出
+    // 在订阅者任务中执行：网络发送阻塞只会让本订阅者的队列积压/丢帧，不影响 AFE
     // 只有在录音且连接时才发送到服务器
     if (s_recording && funasr_is_connected()) {
         size_t bytes = sample_count * sizeof(int16_t);
@@ -167,8 +168,21 @@ void app_main(void)
         return;
     }
     
-    // 注册录音数据回调
-    audio_manager_set_record_callback(audio_record_callback, NULL);
+    // 订阅录音数据：独立的发送任务和约 1 秒的帧队列，网络变慢时丢弃最旧的帧
+    record_sub_config_t sub_cfg = {
+        .callback = audio_record_callback,
+        .queue_frames = 32,
+        .frame_samples = 512,
+        .drop_policy = RECORD_SUB_DROP_OLDEST,
+        .task_name = "asr_send",
+        .task_stack = 4096,
+        .task_priority = 5,
+        .task_core = -1,
+    };
+    if (!audio_manager_subscribe_record(&sub_cfg)) {
+        ESP_LOGE(TAG, "录音订阅失败");
+        return;
+    }
     
     audio_manager_start();
 